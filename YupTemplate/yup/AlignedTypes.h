@@ -0,0 +1,309 @@
+// ========================================================================== //
+//
+//  AlignedTypes.h
+//  ---
+//  Aligned vector/matrix storage and a structure-of-arrays point container
+//  for bulk geometry code
+//
+//  Created: 2016-08-24
+//  Updated: 2016-08-24
+//
+//  (C) 2016 Yu-hsien Chang
+//
+// ========================================================================== //
+
+#pragma once
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <vector>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+#include "yup.h"
+#include "Vectors.h"
+#include "Matrices.h"
+#include "Transform.h"
+
+BEGIN_NAMESPACE_YUP
+
+// ========================================================================== //
+//  aligned heap allocation
+// ========================================================================== //
+inline void * AlignedMalloc(size_t size, size_t alignment)
+{
+#ifdef _WIN32
+    return _aligned_malloc(size, alignment);
+#else
+    void *p = nullptr;
+    if (posix_memalign(&p, alignment < sizeof(void *) ? sizeof(void *) : alignment, size) != 0)
+        return nullptr;
+    return p;
+#endif
+}
+
+inline void AlignedFree(void *p)
+{
+#ifdef _WIN32
+    _aligned_free(p);
+#else
+    free(p);
+#endif
+}
+
+// std::allocator replacement, since operator new ignores over-alignment before C++17
+template <typename T, size_t Alignment>
+struct AlignedAllocator
+{
+    typedef T value_type;
+
+    template <typename U> struct rebind { typedef AlignedAllocator<U, Alignment> other; };
+
+    AlignedAllocator() {}
+    template <typename U> AlignedAllocator(const AlignedAllocator<U, Alignment> &) {}
+
+    T * allocate(size_t n) {
+        void *p = AlignedMalloc(n * sizeof(T), Alignment);
+        if (!p)
+            throw std::bad_alloc();
+        return static_cast<T *>(p);
+    }
+
+    void deallocate(T *p, size_t) { AlignedFree(p); }
+
+    template <typename U> bool operator==(const AlignedAllocator<U, Alignment> &) const { return true; }
+    template <typename U> bool operator!=(const AlignedAllocator<U, Alignment> &) const { return false; }
+};
+
+
+
+// ========================================================================== //
+//  16-byte aligned variants, loadable with aligned SIMD loads
+// ========================================================================== //
+struct alignas(16) Vector3A : public Vector3
+{
+    float pad = 0;
+
+    Vector3A() {}
+    Vector3A(float x, float y, float z) : Vector3(x, y, z) {}
+    Vector3A(const Vector3 &v) : Vector3(v) {}
+};
+
+class alignas(16) Matrix4A : public Matrix4
+{
+public:
+    Matrix4A() {}
+    Matrix4A(const float src[16]) : Matrix4(src) {}
+    Matrix4A(const Matrix4 &mat) : Matrix4(mat) {}
+};
+
+static_assert(sizeof(Vector3A) == 16, "Vector3A must be 16 bytes");
+
+typedef std::vector<Vector3A, AlignedAllocator<Vector3A, 16> > Vector3AVector;
+typedef std::vector<Matrix4A, AlignedAllocator<Matrix4A, 16> > Matrix4AVector;
+
+
+
+// ========================================================================== //
+//  Structure-of-arrays point container
+//  x, y and z are kept in separate cache line aligned streams. Elements are
+//  accessed through a proxy that converts to and from Vector3.
+// ========================================================================== //
+class Vector3Array
+{
+public:
+    typedef std::vector<float, AlignedAllocator<float, 64> > Stream;
+
+    // proxy for a single element
+    struct Reference
+    {
+        float &x;
+        float &y;
+        float &z;
+
+        Reference(float &x, float &y, float &z) : x(x), y(y), z(z) {}
+
+        operator Vector3() const { return Vector3(x, y, z); }
+        Reference& operator=(const Vector3 &v) { x = v.x; y = v.y; z = v.z; return *this; }
+        Reference& operator=(const Reference &r) { x = r.x; y = r.y; z = r.z; return *this; }
+
+        // swaps the elements, not the proxies, for std::iter_swap and friends
+        friend void swap(Reference a, Reference b) {
+            std::swap(a.x, b.x);  std::swap(a.y, b.y);  std::swap(a.z, b.z);
+        }
+    };
+
+    // proxy iterator, random access but dereferences to a Reference/Vector3
+    // by value. Like std::vector<bool> the algorithms (std::sort, reverse ...)
+    // work with it, strict iterator concept checks do not accept the proxy.
+    // iterator converts to const_iterator.
+    template <typename ArrayT, typename RefT>
+    class Iterator
+    {
+    private:
+        template <typename, typename> friend class Iterator;
+
+        ArrayT *mArray;
+        size_t mIndex;
+
+    public:
+        // holds the proxy so that it->x works
+        struct Pointer
+        {
+            RefT ref;
+            RefT * operator->() { return &ref; }
+        };
+
+        typedef std::random_access_iterator_tag iterator_category;
+        typedef Vector3 value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef Pointer pointer;
+        typedef RefT reference;
+
+        Iterator() : mArray(nullptr), mIndex(0) {}
+        Iterator(ArrayT *array, size_t index) : mArray(array), mIndex(index) {}
+
+        template <typename OtherT, typename OtherRefT,
+            typename = typename std::enable_if<std::is_convertible<OtherT *, ArrayT *>::value>::type>
+        Iterator(const Iterator<OtherT, OtherRefT> &it) : mArray(it.mArray), mIndex(it.mIndex) {}
+
+        RefT operator*() const { return (*mArray)[mIndex]; }
+        Pointer operator->() const { return Pointer{ (*mArray)[mIndex] }; }
+        RefT operator[](difference_type n) const { return (*mArray)[mIndex + n]; }
+
+        Iterator& operator++() { ++mIndex; return *this; }
+        Iterator& operator--() { --mIndex; return *this; }
+        Iterator operator++(int) { Iterator it = *this; ++mIndex; return it; }
+        Iterator operator--(int) { Iterator it = *this; --mIndex; return it; }
+        Iterator& operator+=(difference_type n) { mIndex += n; return *this; }
+        Iterator& operator-=(difference_type n) { mIndex -= n; return *this; }
+        Iterator operator+(difference_type n) const { return Iterator(mArray, mIndex + n); }
+        Iterator operator-(difference_type n) const { return Iterator(mArray, mIndex - n); }
+        friend Iterator operator+(difference_type n, const Iterator &it) { return it + n; }
+
+        // friends, so that iterator and const_iterator mix through the conversion
+        friend difference_type operator-(const Iterator &a, const Iterator &b) { return (difference_type)a.mIndex - (difference_type)b.mIndex; }
+        friend bool operator==(const Iterator &a, const Iterator &b) { return a.mIndex == b.mIndex; }
+        friend bool operator!=(const Iterator &a, const Iterator &b) { return a.mIndex != b.mIndex; }
+        friend bool operator<(const Iterator &a, const Iterator &b) { return a.mIndex < b.mIndex; }
+        friend bool operator>(const Iterator &a, const Iterator &b) { return a.mIndex > b.mIndex; }
+        friend bool operator<=(const Iterator &a, const Iterator &b) { return a.mIndex <= b.mIndex; }
+        friend bool operator>=(const Iterator &a, const Iterator &b) { return a.mIndex >= b.mIndex; }
+    };
+
+    typedef Iterator<Vector3Array, Reference> iterator;
+    typedef Iterator<const Vector3Array, Vector3> const_iterator;
+
+private:
+    Stream mX;
+    Stream mY;
+    Stream mZ;
+
+public:
+    Vector3Array() {}
+    explicit Vector3Array(size_t n) : mX(n), mY(n), mZ(n) {}
+    Vector3Array(const Vector3 *points, size_t n) { assign(points, n); }
+
+    size_t size() const { return mX.size(); }
+    bool empty() const { return mX.empty(); }
+
+    void resize(size_t n) { mX.resize(n); mY.resize(n); mZ.resize(n); }
+    void reserve(size_t n) { mX.reserve(n); mY.reserve(n); mZ.reserve(n); }
+    void clear() { mX.clear(); mY.clear(); mZ.clear(); }
+
+    void push_back(const Vector3 &v) { mX.push_back(v.x); mY.push_back(v.y); mZ.push_back(v.z); }
+    void push_back(float x, float y, float z) { mX.push_back(x); mY.push_back(y); mZ.push_back(z); }
+
+    Reference operator[](size_t i) { return Reference(mX[i], mY[i], mZ[i]); }
+    Vector3 operator[](size_t i) const { return Vector3(mX[i], mY[i], mZ[i]); }
+
+    iterator begin() { return iterator(this, 0); }
+    iterator end() { return iterator(this, size()); }
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, size()); }
+
+    // raw streams, aligned to 64 bytes
+    float * x() { return mX.data(); }
+    float * y() { return mY.data(); }
+    float * z() { return mZ.data(); }
+    const float * x() const { return mX.data(); }
+    const float * y() const { return mY.data(); }
+    const float * z() const { return mZ.data(); }
+
+    // conversion from/to interleaved storage
+    void assign(const Vector3 *points, size_t n) {
+        resize(n);
+        for (size_t i = 0; i < n; ++i)
+        {
+            mX[i] = points[i].x;  mY[i] = points[i].y;  mZ[i] = points[i].z;
+        }
+    }
+
+    void assign(const float *xyz, size_t n) {
+        resize(n);
+        for (size_t i = 0; i < n; ++i)
+        {
+            mX[i] = xyz[i*3];  mY[i] = xyz[i*3 + 1];  mZ[i] = xyz[i*3 + 2];
+        }
+    }
+
+    void copyTo(Vector3 *points) const {
+        for (size_t i = 0; i < size(); ++i)
+            points[i].set(mX[i], mY[i], mZ[i]);
+    }
+
+    void copyTo(float *xyz) const {
+        for (size_t i = 0; i < size(); ++i)
+        {
+            xyz[i*3] = mX[i];  xyz[i*3 + 1] = mY[i];  xyz[i*3 + 2] = mZ[i];
+        }
+    }
+
+    // transform all points in place
+    void transform(const Matrix4 &m) { TransformPoints(m, x(), y(), z(), x(), y(), z(), size()); }
+    void transformProjective(const Matrix4 &m) { TransformPointsProjective(m, x(), y(), z(), x(), y(), z(), size()); }
+};
+
+
+
+// ========================================================================== //
+//  conversion helpers
+// ========================================================================== //
+inline void ToAligned(const Vector3 *src, Vector3A *dst, size_t n)
+{
+    for (size_t i = 0; i < n; ++i)
+        dst[i] = src[i];
+}
+
+inline void FromAligned(const Vector3A *src, Vector3 *dst, size_t n)
+{
+    for (size_t i = 0; i < n; ++i)
+        dst[i] = src[i];
+}
+
+inline Vector3AVector ToAligned(const std::vector<Vector3> &src)
+{
+    Vector3AVector dst(src.size());
+    ToAligned(src.data(), dst.data(), src.size());
+    return dst;
+}
+
+inline Vector3Array ToSoA(const std::vector<Vector3> &src)
+{
+    return Vector3Array(src.data(), src.size());
+}
+
+inline std::vector<Vector3> ToAoS(const Vector3Array &src)
+{
+    std::vector<Vector3> dst(src.size());
+    src.copyTo(dst.data());
+    return dst;
+}
+
+END_NAMESPACE_YUP
@@ -0,0 +1,199 @@
+// ========================================================================== //
+//
+//  BufferPool.cpp
+//  ---
+//  Created: 2016-08-24
+//  Updated: 2016-08-24
+//
+//  (C) 2016 Yu-hsien Chang
+//
+// ========================================================================== //
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+#include "BufferPool.h"
+#include "AlignedTypes.h"
+
+BEGIN_NAMESPACE_YUP
+
+// index of the highest set bit, v > 0
+static inline int HighBit(size_t v)
+{
+	int bit = 0;
+	while (v >>= 1)
+		bit++;
+	return bit;
+}
+
+
+
+size_t BufferPool::RoundUp(size_t size)
+{
+	if (size <= MinBlockSize)
+		return MinBlockSize;
+
+	// round up to a quarter of the power of two below size
+	size_t step = ((size_t)1 << HighBit(size)) / 4;
+	return (size + step - 1) / step * step;
+}
+
+
+
+// -1 for capacities beyond the largest class, which are not pooled
+int BufferPool::SizeClass(size_t capacity)
+{
+	int bit = HighBit(capacity);
+	int index = (bit - 12) * 4 + (int)(capacity >> (bit - 2)) - 4;
+	return index < ClassCount ? index : -1;
+}
+
+
+
+PoolBlock BufferPool::Allocate(size_t capacity, bool largePages)
+{
+	PoolBlock block;
+	block.capacity = capacity;
+
+	if (largePages && capacity >= LargePageSize)
+	{
+#ifdef _WIN32
+		size_t page = GetLargePageMinimum();
+		if (page > 0)
+		{
+			size_t size = (capacity + page - 1) / page * page;
+			block.data = (uint8_t *)VirtualAlloc(nullptr, size, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+			block.largePages = block.data != nullptr;
+		}
+#else
+		// transparent huge pages, the block must start on a huge page
+		block.data = (uint8_t *)AlignedMalloc(capacity, LargePageSize);
+#ifdef MADV_HUGEPAGE
+		if (block.data)
+			madvise(block.data, capacity, MADV_HUGEPAGE);
+#endif
+#endif
+	}
+
+	if (!block.data)
+		block.data = (uint8_t *)AlignedMalloc(capacity, Alignment);
+
+	if (!block.data)
+		block.capacity = 0;
+
+	return block;
+}
+
+
+
+void BufferPool::Free(PoolBlock & block)
+{
+#ifdef _WIN32
+	if (block.largePages)
+		VirtualFree(block.data, 0, MEM_RELEASE);
+	else
+		AlignedFree(block.data);
+#else
+	AlignedFree(block.data);
+#endif
+	block = PoolBlock();
+}
+
+
+
+PoolBlock BufferPool::acquire(size_t size)
+{
+	if (size == 0)
+		return PoolBlock();
+
+	size_t capacity = RoundUp(size);
+	int sizeClass = SizeClass(capacity);
+	bool largePages;
+
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+
+		if (sizeClass >= 0 && !mFree[sizeClass].empty())
+		{
+			PoolBlock block = mFree[sizeClass].back();
+			mFree[sizeClass].pop_back();
+			mCachedBytes -= block.capacity;
+			return block;
+		}
+
+		largePages = mLargePages;
+	}
+
+	// allocate outside the lock, the OS may take a while
+	return Allocate(capacity, largePages);
+}
+
+
+
+void BufferPool::release(PoolBlock & block)
+{
+	if (!block.data)
+		return;
+
+	int sizeClass = SizeClass(block.capacity);
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+
+		if (sizeClass >= 0 && mCachedBytes + block.capacity <= mMaxCachedBytes)
+		{
+			mFree[sizeClass].push_back(block);
+			mCachedBytes += block.capacity;
+			block = PoolBlock();
+			return;
+		}
+	}
+
+	Free(block);
+}
+
+
+
+void BufferPool::setLargePages(bool enable)
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	mLargePages = enable;
+}
+
+void BufferPool::setMaxCachedBytes(size_t bytes)
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	mMaxCachedBytes = bytes;
+}
+
+size_t BufferPool::cachedBytes() const
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	return mCachedBytes;
+}
+
+
+
+void BufferPool::trim()
+{
+	std::vector<PoolBlock> blocks;
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+
+		for (int i = 0; i < ClassCount; i++)
+		{
+			blocks.insert(blocks.end(), mFree[i].begin(), mFree[i].end());
+			mFree[i].clear();
+		}
+		mCachedBytes = 0;
+	}
+
+	for (PoolBlock & block : blocks)
+		Free(block);
+}
+
+END_NAMESPACE_YUP
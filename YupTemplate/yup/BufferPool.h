@@ -0,0 +1,96 @@
+// ========================================================================== //
+//
+//  BufferPool.h
+//  ---
+//  A process wide pool of large, 64-byte aligned memory blocks
+//
+//  Blocks are rounded up to size classes of 4 steps per power of two (at
+//  most 25% slack) and kept in a free list per class when released, so
+//  buffers that come and go every frame reuse memory that is already
+//  mapped. The contents of an acquired block are undefined.
+//
+//  Created: 2016-08-24
+//  Updated: 2016-08-24
+//
+//  (C) 2016 Yu-hsien Chang
+//
+// ========================================================================== //
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "yup.h"
+
+BEGIN_NAMESPACE_YUP
+
+// A block of pool memory, empty when data is null
+struct PoolBlock
+{
+	uint8_t * data = nullptr;
+	size_t capacity = 0;
+	bool largePages = false;
+};
+
+class BufferPool
+{
+public:
+	static const size_t Alignment = 64;
+	static const size_t MinBlockSize = 4096;
+	static const size_t LargePageSize = 2 * 1024 * 1024;
+
+private:
+	// 4 classes per power of two from MinBlockSize to 2^40 bytes
+	static const int ClassCount = (40 - 12 + 1) * 4;
+
+	mutable std::mutex mMutex;
+	std::vector<PoolBlock> mFree[ClassCount];
+	size_t mCachedBytes = 0;
+	size_t mMaxCachedBytes = 256 * 1024 * 1024;
+	bool mLargePages = false;
+
+	BufferPool() {}
+
+public:
+	// never destroyed, so buffers can still be released at exit
+	static BufferPool & Instance() {
+		static BufferPool * instance = new BufferPool();
+
+		return *instance;
+	}
+
+	BufferPool(const BufferPool &) = delete;
+	void operator=(const BufferPool &) = delete;
+
+	// a block of at least size bytes, an empty block for size 0
+	PoolBlock acquire(size_t size);
+
+	// give the block back to the pool and empty it
+	void release(PoolBlock & block);
+
+	// Back blocks of LargePageSize and up with large pages where the OS
+	// allows it (on Windows this needs the "Lock pages in memory" right).
+	// Falls back to normal pages silently.
+	void setLargePages(bool enable);
+
+	// free blocks beyond this are returned to the OS on release
+	void setMaxCachedBytes(size_t bytes);
+
+	// return all free blocks to the OS
+	void trim();
+
+	size_t cachedBytes() const;
+
+	// capacity of the size class of size
+	static size_t RoundUp(size_t size);
+
+private:
+	static int SizeClass(size_t capacity);
+	static PoolBlock Allocate(size_t capacity, bool largePages);
+	static void Free(PoolBlock & block);
+};
+
+END_NAMESPACE_YUP
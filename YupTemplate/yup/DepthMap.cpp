@@ -0,0 +1,146 @@
+// ========================================================================== //
+//
+//  DepthMap.cpp
+//  ---
+//  With AVX2 the table is read with 32 bit gathers of 8 depths at a time,
+//  the byte of each lane is the entry. The table has 3 bytes of padding so
+//  the gather of the last entry stays inside it.
+//
+//  Created: 2016-08-24
+//  Updated: 2016-08-24
+//
+//  (C) 2016 Yu-hsien Chang
+//
+// ========================================================================== //
+
+#include <cmath>
+
+#include "DepthMap.h"
+#include "PixelPack.h"
+#include "Simd.h"
+
+BEGIN_NAMESPACE_YUP
+
+DepthMap::DepthMap(int mode, float nearDepth, float farDepth)
+: mLut(65536 + 3, 0)
+, mMode(mode)
+, mNear(nearDepth)
+, mFar(farDepth)
+{
+	build();
+}
+
+
+
+void DepthMap::setMode(int mode)
+{
+	if (mode == mMode)
+		return;
+
+	mMode = mode;
+	build();
+}
+
+void DepthMap::setRange(float nearDepth, float farDepth)
+{
+	if (nearDepth == mNear && farDepth == mFar)
+		return;
+
+	mNear = nearDepth;
+	mFar = farDepth;
+	build();
+}
+
+
+
+void DepthMap::build()
+{
+	// the inverse curve needs a near plane in front of 0
+	const float nearDepth = (mMode == DEPTHMODE_INVERSE && mNear < 1) ? 1 : mNear;
+	const float farDepth = mFar > nearDepth ? mFar : nearDepth + 1;
+
+	const float invNear = 1 / nearDepth, invFar = 1 / farDepth;
+
+	mLut[0] = mMode == DEPTHMODE_NONE ? 255 : 0;
+	for (int d = 1; d < 65536; d++)
+	{
+		float z = (float)d;
+		z = z < nearDepth ? nearDepth : (z > farDepth ? farDepth : z);
+
+		float t;                                                // 0 to 1
+		switch (mMode)
+		{
+		case DEPTHMODE_LINEAR:
+			t = (z - nearDepth) / (farDepth - nearDepth);
+			break;
+		case DEPTHMODE_REVERSED_LINEAR:
+			t = (farDepth - z) / (farDepth - nearDepth);
+			break;
+		case DEPTHMODE_INVERSE:
+			t = (1 / z - invFar) / (invNear - invFar);
+			break;
+		default:
+			t = 1;
+			break;
+		}
+
+		mLut[d] = (uint8_t)std::lround(t * 255);
+	}
+}
+
+
+
+void DepthMap::map(const uint16_t *depth, uint8_t *out, size_t n) const
+{
+	const uint8_t *lut = mLut.data();
+	size_t i = 0;
+
+#if defined(YUP_SIMD_AVX2)
+	const __m256i byteMask = _mm256_set1_epi32(0xFF);
+	for (; i + 16 <= n; i += 16)
+	{
+		__m256i d = _mm256_loadu_si256((const __m256i *)(depth + i));
+		__m256i lo = _mm256_cvtepu16_epi32(_mm256_castsi256_si128(d));
+		__m256i hi = _mm256_cvtepu16_epi32(_mm256_extracti128_si256(d, 1));
+
+		lo = _mm256_and_si256(_mm256_i32gather_epi32((const int *)lut, lo, 1), byteMask);
+		hi = _mm256_and_si256(_mm256_i32gather_epi32((const int *)lut, hi, 1), byteMask);
+
+		// packus works per lane, the permute puts the 16 words back in order
+		__m256i w = _mm256_permute4x64_epi64(_mm256_packus_epi32(lo, hi), 0xD8);
+		__m128i b = _mm_packus_epi16(_mm256_castsi256_si128(w), _mm256_extracti128_si256(w, 1));
+		_mm_storeu_si128((__m128i *)(out + i), b);
+	}
+#endif
+
+	// the loads of an unrolled loop are independent, the lookups overlap
+	for (; i + 4 <= n; i += 4)
+	{
+		uint8_t a = lut[depth[i]], b = lut[depth[i + 1]], c = lut[depth[i + 2]], d = lut[depth[i + 3]];
+		out[i] = a;
+		out[i + 1] = b;
+		out[i + 2] = c;
+		out[i + 3] = d;
+	}
+
+	for (; i < n; ++i)
+		out[i] = lut[depth[i]];
+}
+
+
+
+void DepthMap::mapToAlpha(const uint16_t *depth, uint8_t *rgba, size_t n) const
+{
+	// in chunks that stay in L1 between the two passes
+	const size_t chunk = 4096;
+	uint8_t alpha[chunk];
+
+	for (size_t i = 0; i < n; i += chunk)
+	{
+		size_t count = n - i < chunk ? n - i : chunk;
+		map(depth + i, alpha, count);
+		PackDepthToAlpha(alpha, rgba + i * 4, count);
+	}
+}
+
+END_NAMESPACE_YUP
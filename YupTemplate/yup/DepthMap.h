@@ -0,0 +1,68 @@
+// ========================================================================== //
+//
+//  DepthMap.h
+//  ---
+//  Mapping of 16 bit depth to 8 bit for display
+//
+//  The curve is baked into a table of all 65536 depth values when the mode
+//  or range changes, so mapping a frame is one lookup per pixel whatever
+//  the curve. Near maps to the bright end for the reversed and the inverse
+//  curve. A depth of 0 is taken as no measurement and maps to 0, except
+//  with DEPTHMODE_NONE.
+//
+//  Created: 2016-08-24
+//  Updated: 2016-08-24
+//
+//  (C) 2016 Yu-hsien Chang
+//
+// ========================================================================== //
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "yup.h"
+
+// The depth modes of the shaders and of DepthMap
+#define DEPTHMODE_NONE				0			// no depth, 255
+#define DEPTHMODE_LINEAR			1			// near 0, far 255
+#define DEPTHMODE_REVERSED_LINEAR	2			// near 255, far 0
+#define DEPTHMODE_INVERSE			3			// 1 / depth, near 255, far 0
+
+BEGIN_NAMESPACE_YUP
+
+class DepthMap
+{
+private:
+	std::vector<uint8_t> mLut;			// 65536 entries, padded for 4 byte gathers
+
+	int mMode = DEPTHMODE_LINEAR;
+	float mNear = 0;
+	float mFar = 65535;
+
+	void build();
+
+public:
+	DepthMap(int mode = DEPTHMODE_LINEAR, float nearDepth = 0, float farDepth = 65535);
+
+	int mode() const { return mMode; }
+	float nearDepth() const { return mNear; }
+	float farDepth() const { return mFar; }
+
+	// near and far in depth units, depths outside are clamped
+	void setMode(int mode);
+	void setRange(float nearDepth, float farDepth);
+
+	const uint8_t * lut() const { return mLut.data(); }
+	uint8_t operator()(uint16_t depth) const { return mLut[depth]; }
+
+	// n depths to n bytes
+	void map(const uint16_t *depth, uint8_t *out, size_t n) const;
+
+	// n depths into the alpha channel of n RGBA pixels, the colour is kept
+	void mapToAlpha(const uint16_t *depth, uint8_t *rgba, size_t n) const;
+};
+
+END_NAMESPACE_YUP
@@ -0,0 +1,128 @@
+// ========================================================================== //
+//
+//  DirtyRegion.cpp
+//  ---
+//
+//  Created: 2016-08-24
+//  Updated: 2016-08-24
+//
+//  (C) 2016 Yu-hsien Chang
+//
+// ========================================================================== //
+
+#include <algorithm>
+
+#include "DirtyRegion.h"
+
+BEGIN_NAMESPACE_YUP
+
+bool DirtyRect::intersects(const DirtyRect &rect) const
+{
+	return x < rect.x + rect.width && rect.x < x + width &&
+		   y < rect.y + rect.height && rect.y < y + height;
+}
+
+DirtyRect DirtyRect::merged(const DirtyRect &rect) const
+{
+	if (empty())
+		return rect;
+	if (rect.empty())
+		return *this;
+
+	int x0 = std::min(x, rect.x);
+	int y0 = std::min(y, rect.y);
+	int x1 = std::max(x + width, rect.x + rect.width);
+	int y1 = std::max(y + height, rect.y + rect.height);
+
+	return DirtyRect(x0, y0, x1 - x0, y1 - y0);
+}
+
+
+void DirtyRegion::setBounds(int width, int height)
+{
+	mWidth = width;
+	mHeight = height;
+
+	// clip what is there to the new size
+	std::vector<DirtyRect> rects;
+	rects.swap(mRects);
+	for (const DirtyRect &rect : rects)
+		add(rect);
+}
+
+void DirtyRegion::setMaxRects(int maxRects)
+{
+	mMaxRects = std::max(1, maxRects);
+
+	while ((int)mRects.size() > mMaxRects)
+	{
+		// merge the cheapest pair
+		size_t bestI = 0, bestJ = 1;
+		int64_t bestWaste = INT64_MAX;
+		for (size_t i = 0; i < mRects.size(); i++)
+		{
+			for (size_t j = i + 1; j < mRects.size(); j++)
+			{
+				int64_t waste = mRects[i].merged(mRects[j]).area() - mRects[i].area() - mRects[j].area();
+				if (waste < bestWaste)
+				{
+					bestWaste = waste;
+					bestI = i;
+					bestJ = j;
+				}
+			}
+		}
+
+		DirtyRect rect = mRects[bestI].merged(mRects[bestJ]);
+		mRects.erase(mRects.begin() + bestJ);
+		mRects.erase(mRects.begin() + bestI);
+		add(rect);
+	}
+}
+
+void DirtyRegion::add(const DirtyRect &rect)
+{
+	// clip to the image
+	int x0 = std::max(rect.x, 0);
+	int y0 = std::max(rect.y, 0);
+	int x1 = std::min(rect.x + rect.width, mWidth);
+	int y1 = std::min(rect.y + rect.height, mHeight);
+
+	DirtyRect r(x0, y0, x1 - x0, y1 - y0);
+	if (r.empty())
+		return;
+
+	// absorb every rectangle that overlaps r or that r can take in for free,
+	// again after each merge as r has grown
+	bool merged = true;
+	while (merged)
+	{
+		merged = false;
+		for (size_t i = 0; i < mRects.size(); i++)
+		{
+			const DirtyRect &other = mRects[i];
+			if (r.intersects(other) || r.merged(other).area() <= r.area() + other.area())
+			{
+				r = r.merged(other);
+				mRects.erase(mRects.begin() + i);
+				merged = true;
+				break;
+			}
+		}
+	}
+
+	mRects.push_back(r);
+
+	if ((int)mRects.size() > mMaxRects)
+		setMaxRects(mMaxRects);
+}
+
+int64_t DirtyRegion::area() const
+{
+	int64_t total = 0;
+	for (const DirtyRect &rect : mRects)
+		total += rect.area();
+	return total;
+}
+
+END_NAMESPACE_YUP
@@ -0,0 +1,82 @@
+// ========================================================================== //
+//
+//  DirtyRegion.h
+//  ---
+//  A small set of rectangles covering the changed part of an image
+//
+//  Overlapping rectangles, and neighbours whose bounding box wastes no
+//  area, are merged as they are added, so the rectangles never overlap.
+//  Once there are more than the limit the two that waste the least area
+//  together are merged, so the set stays small and uploading it cheap.
+//
+//  Created: 2016-08-24
+//  Updated: 2016-08-24
+//
+//  (C) 2016 Yu-hsien Chang
+//
+// ========================================================================== //
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "yup.h"
+
+BEGIN_NAMESPACE_YUP
+
+struct DirtyRect
+{
+	int x = 0;
+	int y = 0;
+	int width = 0;
+	int height = 0;
+
+	DirtyRect() {}
+	DirtyRect(int x, int y, int width, int height)
+	: x(x), y(y), width(width), height(height)
+	{}
+
+	bool empty() const { return width <= 0 || height <= 0; }
+	int64_t area() const { return empty() ? 0 : (int64_t)width * height; }
+
+	bool intersects(const DirtyRect &rect) const;
+
+	// the smallest rectangle covering both
+	DirtyRect merged(const DirtyRect &rect) const;
+};
+
+class DirtyRegion
+{
+private:
+	std::vector<DirtyRect> mRects;
+
+	int mWidth = 0;
+	int mHeight = 0;
+	int mMaxRects = 8;
+
+public:
+	DirtyRegion() {}
+
+	// the image size, rectangles are clipped to it
+	void setBounds(int width, int height);
+
+	// beyond this the rectangles are merged, at least 1
+	void setMaxRects(int maxRects);
+
+	// mark a rectangle as changed
+	void add(const DirtyRect &rect);
+
+	// mark the whole image as changed
+	void addAll() { add(DirtyRect(0, 0, mWidth, mHeight)); }
+
+	void clear() { mRects.clear(); }
+
+	bool empty() const { return mRects.empty(); }
+	const std::vector<DirtyRect> & rects() const { return mRects; }
+
+	// total area of the rectangles
+	int64_t area() const;
+};
+
+END_NAMESPACE_YUP
@@ -0,0 +1,202 @@
+// ========================================================================== //
+//
+//  Downsample.cpp
+//  ---
+//  The box kernels sum in 16 bits and round once, like the scalar code, so
+//  both give the same bytes. The tent filter runs the vertical taps with
+//  SIMD into a 16 bit row and the horizontal taps on that row.
+//
+//  Created: 2016-08-24
+//  Updated: 2016-08-24
+//
+//  (C) 2016 Yu-hsien Chang
+//
+// ========================================================================== //
+
+#include <algorithm>
+
+#include "Downsample.h"
+#include "Simd.h"
+
+BEGIN_NAMESPACE_YUP
+
+// -------------------------------------------------------------------------- //
+//  box, one output row from input rows r0 and r1
+// -------------------------------------------------------------------------- //
+static void BoxRow(const uint8_t *r0, const uint8_t *r1, uint8_t *dst, int width, int srcWidth, int depth)
+{
+	int x = 0;
+
+#if defined(YUP_SIMD_SSE2)
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i two = _mm_set1_epi16(2);
+
+	if (depth == 4)
+	{
+		// 4 pixels out of 8
+		for (; x + 4 <= width; x += 4)
+		{
+			__m128i s[2];
+			for (int k = 0; k < 2; k++)
+			{
+				__m128i a = _mm_loadu_si128((const __m128i *)(r0 + x * 8) + k);
+				__m128i b = _mm_loadu_si128((const __m128i *)(r1 + x * 8) + k);
+				__m128i lo = _mm_add_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero));
+				__m128i hi = _mm_add_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero));
+
+				// the two pixels of each half side by side
+				s[k] = _mm_add_epi16(_mm_unpacklo_epi64(lo, hi), _mm_unpackhi_epi64(lo, hi));
+				s[k] = _mm_srli_epi16(_mm_add_epi16(s[k], two), 2);
+			}
+			_mm_storeu_si128((__m128i *)(dst + x * 4), _mm_packus_epi16(s[0], s[1]));
+		}
+	}
+	else if (depth == 1)
+	{
+		// 16 pixels out of 32
+		const __m128i low = _mm_set1_epi16(0x00FF);
+		for (; x + 16 <= width; x += 16)
+		{
+			__m128i s[2];
+			for (int k = 0; k < 2; k++)
+			{
+				__m128i a = _mm_loadu_si128((const __m128i *)(r0 + x * 2) + k);
+				__m128i b = _mm_loadu_si128((const __m128i *)(r1 + x * 2) + k);
+				s[k] = _mm_add_epi16(_mm_add_epi16(_mm_and_si128(a, low), _mm_srli_epi16(a, 8)),
+									 _mm_add_epi16(_mm_and_si128(b, low), _mm_srli_epi16(b, 8)));
+				s[k] = _mm_srli_epi16(_mm_add_epi16(s[k], two), 2);
+			}
+			_mm_storeu_si128((__m128i *)(dst + x), _mm_packus_epi16(s[0], s[1]));
+		}
+	}
+#endif
+
+	for (; x < width; ++x)
+	{
+		// a 1 pixel wide source pairs its column with itself
+		const int x0 = x * 2 * depth;
+		const int x1 = std::min(x * 2 + 1, srcWidth - 1) * depth;
+		for (int c = 0; c < depth; c++)
+			dst[x * depth + c] = (uint8_t)((r0[x0 + c] + r0[x1 + c] + r1[x0 + c] + r1[x1 + c] + 2) >> 2);
+	}
+}
+
+
+
+// -------------------------------------------------------------------------- //
+//  tent, vertical taps of 4 rows into sum, then horizontal taps of sum
+// -------------------------------------------------------------------------- //
+static void TentColumns(const uint8_t *r0, const uint8_t *r1, const uint8_t *r2, const uint8_t *r3, uint16_t *sum, int n)
+{
+	int i = 0;
+
+#if defined(YUP_SIMD_SSE2)
+	const __m128i zero = _mm_setzero_si128();
+	for (; i + 16 <= n; i += 16)
+	{
+		__m128i a = _mm_loadu_si128((const __m128i *)(r0 + i));
+		__m128i b = _mm_loadu_si128((const __m128i *)(r1 + i));
+		__m128i c = _mm_loadu_si128((const __m128i *)(r2 + i));
+		__m128i d = _mm_loadu_si128((const __m128i *)(r3 + i));
+
+		// a + 3 (b + c) + d, at most 8 * 255
+		__m128i lo = _mm_add_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(d, zero));
+		__m128i hi = _mm_add_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(d, zero));
+		__m128i midLo = _mm_add_epi16(_mm_unpacklo_epi8(b, zero), _mm_unpacklo_epi8(c, zero));
+		__m128i midHi = _mm_add_epi16(_mm_unpackhi_epi8(b, zero), _mm_unpackhi_epi8(c, zero));
+		lo = _mm_add_epi16(lo, _mm_add_epi16(midLo, _mm_add_epi16(midLo, midLo)));
+		hi = _mm_add_epi16(hi, _mm_add_epi16(midHi, _mm_add_epi16(midHi, midHi)));
+
+		_mm_storeu_si128((__m128i *)(sum + i), lo);
+		_mm_storeu_si128((__m128i *)(sum + i + 8), hi);
+	}
+#endif
+
+	for (; i < n; ++i)
+		sum[i] = (uint16_t)(r0[i] + 3 * (r1[i] + r2[i]) + r3[i]);
+}
+
+static void TentRow(const uint16_t *sum, uint8_t *dst, int width, int srcWidth, int depth)
+{
+	for (int x = 0; x < width; ++x)
+	{
+		const int x0 = std::max(x * 2 - 1, 0) * depth;
+		const int x1 = x * 2 * depth;
+		const int x2 = std::min(x * 2 + 1, srcWidth - 1) * depth;
+		const int x3 = std::min(x * 2 + 2, srcWidth - 1) * depth;
+		for (int c = 0; c < depth; c++)
+			dst[x * depth + c] = (uint8_t)((sum[x0 + c] + 3 * (sum[x1 + c] + sum[x2 + c]) + sum[x3 + c] + 32) >> 6);
+	}
+}
+
+
+
+void Downsample2x(const FrameView &src, FrameBuffer &dst, DownsampleFilter filter)
+{
+	const int srcWidth = src.width(), srcHeight = src.height(), depth = src.colorDepth();
+	const int width = std::max(srcWidth / 2, 1), height = std::max(srcHeight / 2, 1);
+
+	if (!dst.resize(width, height, depth) || src.empty())
+		return;
+
+	uint8_t *out = dst.data();
+	const size_t pitch = (size_t)width * depth;
+
+	if (filter == DOWNSAMPLE_BOX)
+	{
+		for (int y = 0; y < height; y++)
+			BoxRow(src.row(y * 2), src.row(std::min(y * 2 + 1, srcHeight - 1)), out + y * pitch, width, srcWidth, depth);
+		return;
+	}
+
+	std::vector<uint16_t> sum((size_t)srcWidth * depth);
+	for (int y = 0; y < height; y++)
+	{
+		const uint8_t *r0 = src.row(std::max(y * 2 - 1, 0));
+		const uint8_t *r1 = src.row(y * 2);
+		const uint8_t *r2 = src.row(std::min(y * 2 + 1, srcHeight - 1));
+		const uint8_t *r3 = src.row(std::min(y * 2 + 2, srcHeight - 1));
+
+		TentColumns(r0, r1, r2, r3, sum.data(), srcWidth * depth);
+		TentRow(sum.data(), out + y * pitch, width, srcWidth, depth);
+	}
+}
+
+
+
+// -------------------------------------------------------------------------- //
+//  MipPyramid
+// -------------------------------------------------------------------------- //
+void MipPyramid::build(const FrameView &base, int maxLevels, DownsampleFilter filter)
+{
+	mBase = base;
+
+	// levels until 1x1
+	int count = 0;
+	for (int w = base.width(), h = base.height(); w > 1 || h > 1; w = std::max(w / 2, 1), h = std::max(h / 2, 1))
+		count++;
+	if (base.empty())
+		count = 0;
+	if (maxLevels > 0)
+		count = std::min(count, maxLevels);
+
+	// the buffers of a previous build are reused
+	mLevels.resize(count);
+	for (int i = 0; i < count; i++)
+		Downsample2x(level(i), mLevels[i], filter);
+}
+
+
+
+size_t MipPyramid::totalBytes() const
+{
+	size_t total = 0;
+	for (int i = 0; i < levelCount(); i++)
+	{
+		FrameView view = level(i);
+		total += (size_t)view.pitch() * view.height();
+	}
+	return total;
+}
+
+END_NAMESPACE_YUP
@@ -0,0 +1,65 @@
+// ========================================================================== //
+//
+//  Downsample.h
+//  ---
+//  2x downsampling of 8 bit images and mip pyramids built from it
+//
+//  Level n + 1 is half the size of level n rounded down (at least 1), as
+//  for GL mipmaps. The box filter averages each 2x2 block, the tent filter
+//  weighs the 4x4 neighbourhood by 1 3 3 1 in both directions, which is
+//  what a bilinear reconstruction sampled at the block centres gives and
+//  aliases less. Each byte is a channel, 16 bit data is not supported.
+//
+//  Created: 2016-08-24
+//  Updated: 2016-08-24
+//
+//  (C) 2016 Yu-hsien Chang
+//
+// ========================================================================== //
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "yup.h"
+#include "FrameBuffer.h"
+#include "FrameView.h"
+
+BEGIN_NAMESPACE_YUP
+
+enum DownsampleFilter
+{
+	DOWNSAMPLE_BOX,
+	DOWNSAMPLE_TENT
+};
+
+// src at half the size into dst, which is resized to fit
+void Downsample2x(const FrameView &src, FrameBuffer &dst, DownsampleFilter filter = DOWNSAMPLE_BOX);
+
+// The levels below a base image. build() does not touch GL, so it can run
+// on a worker thread, the levels can then be uploaded on the GL thread
+// with gl::UploadMipPyramid() or handed to CV code at lower resolution.
+class MipPyramid
+{
+private:
+	FrameView mBase;
+	std::vector<FrameBuffer> mLevels;			// level 1 onwards
+
+public:
+	MipPyramid() {}
+
+	// Build down to 1x1, or to maxLevels levels below the base if > 0. The
+	// base is not copied, it must outlive the use of level(0).
+	void build(const FrameView &base, int maxLevels = 0, DownsampleFilter filter = DOWNSAMPLE_BOX);
+
+	// number of levels including the base
+	int levelCount() const { return mBase.empty() ? 0 : (int)mLevels.size() + 1; }
+
+	FrameView level(int i) const { return i == 0 ? mBase : mLevels[i - 1].view(); }
+
+	// bytes of all levels including the base, packed
+	size_t totalBytes() const;
+};
+
+END_NAMESPACE_YUP
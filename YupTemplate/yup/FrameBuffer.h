@@ -15,6 +15,7 @@
 
 #include <cstdint>
 #include <cstring>
+#include <utility>
 
 #ifdef YUP_INCLUDE_OPENCV
 #include <opencv2/imgproc/imgproc.hpp>
@@ -25,26 +26,48 @@
 #endif
 
 #include "yup.h"
+#include "BufferPool.h"
+#include "DepthMap.h"
+#include "DirtyRegion.h"
+#include "FrameCodec.h"
+#include "FrameView.h"
+#include "PixelPack.h"
 
 BEGIN_NAMESPACE_YUP
 
 #ifdef YUP_INCLUDE_OPENCV
 
-static void LoadMatrix8(cv::Mat &mat, const uint8_t *data);
-static void LoadMatrix16(cv::Mat &mat, const uint16_t *data);
+// Copy an image into mat, srcStride in bytes from one row of data to the
+// next, 0 for rows as long as the rows of mat
+static void LoadMatrix8(cv::Mat &mat, const uint8_t *data, size_t srcStride = 0);
+static void LoadMatrix16(cv::Mat &mat, const uint16_t *data, size_t srcStride = 0);
 
 #endif // YUP_INCLUDE_OPENCV
 
 // A simple RGBA frame buffer
+//
+// The storage comes from BufferPool, 64 byte aligned, and is not zeroed:
+// the contents are undefined until written, call clear() or resize() with
+// clear set if zeros are needed.
+//
+// compress() keeps the pixels in a CompressedFrame instead and gives the
+// block back, for frames that are kept but rarely read. data() and the
+// other accessors decompress on demand, so while compressed even the const
+// accessors change the buffer and must not race.
 class FrameBuffer
 {
 private:
-	uint8_t * mData = nullptr;
+	mutable PoolBlock mBlock;
+	mutable uint8_t * mData = nullptr; // mBlock.data, null while compressed
+	mutable CompressedFrame mCompressed;
 
 	int mWidth = 0;
 	int mHeight = 0;
 	int mColorDepth = 4;
 
+	// changed since the last upload, see UploadDirtyRegion() in GlUtil.h
+	DirtyRegion mDirty;
+
 public:
 	FrameBuffer(int width = 0, int height = 0, int colorDepth = 4)
 	: mColorDepth(colorDepth)
@@ -52,46 +75,123 @@ public:
 		resize(width, height);
 	}
 
+	FrameBuffer(const FrameBuffer & buffer)
+	: mColorDepth(buffer.mColorDepth)
+	{
+		*this = buffer;
+	}
+
+	// takes the storage of buffer, which is left empty
+	FrameBuffer(FrameBuffer && buffer) noexcept {
+		*this = std::move(buffer);
+	}
+
 	~FrameBuffer() {
-		if (mData) {
-			delete[] mData;
-			mData = nullptr;
-		}
+		BufferPool::Instance().release(mBlock);
+		mData = nullptr;
 	}
 
 	int width() const { return mWidth; }
 	int height() const { return mHeight; }
+	int colorDepth() const { return mColorDepth; }
 	int pitch() const { return mWidth * mColorDepth; }
 	int size() const { return mWidth * mHeight * mColorDepth; } // Return the size of mdata
+	size_t capacity() const { return mBlock.capacity; }
+
+	uint8_t * data() { decompress(); return mData; }
+	const uint8_t * cst_data() const { decompress(); return mData; }
+
+	operator const uint8_t *() { return cst_data(); }
 
-	uint8_t * data() { return mData; }
-	const uint8_t * cst_data() const { return mData; }
+	// a view of the pixels, valid while the buffer is not resized, compressed
+	// or destroyed
+	FrameView view() const { return FrameView(cst_data(), mWidth, mHeight, mColorDepth); }
 
-	operator const uint8_t *() { return mData; }
+	// Compress the pixels losslessly and release the block, false if there
+	// is nothing to compress or no memory for it
+	bool compress() {
+		if (isCompressed())
+			return true;
+		if (!mData || !mCompressed.compress(view()))
+			return false;
 
-	void resize(int width, int height, int colorDepth = 0) {
+		BufferPool::Instance().release(mBlock);
+		mData = nullptr;
+		return true;
+	}
+
+	// Back to plain pixels, false if no block could be allocated, in which
+	// case the buffer stays compressed and data() is null
+	bool decompress() const {
+		if (!isCompressed())
+			return true;
+
+		PoolBlock block = BufferPool::Instance().acquire(size());
+		if (!block.data)
+			return false;
+
+		mCompressed.decompress(block.data);
+		mCompressed.clear();
+		mBlock = block;
+		mData = mBlock.data;
+		return true;
+	}
+
+	bool isCompressed() const { return !mCompressed.empty(); }
+	size_t compressedBytes() const { return mCompressed.compressedBytes(); }
+
+	// Keeps the current block while the new size fits in it and uses at least
+	// a quarter of it, so switching resolutions back and forth does not
+	// allocate. The contents are undefined afterwards unless clear is set.
+	// If the allocation fails the buffer is left empty, 0 x 0, and false is
+	// returned.
+	bool resize(int width, int height, int colorDepth = 0, bool clear = false) {
 		if (colorDepth == 0)
 			colorDepth = mColorDepth;
 
-		if (mWidth * mHeight * mColorDepth != width * height * colorDepth)
+		// the contents are undefined anyway
+		mCompressed.clear();
+
+		size_t dataSize = (size_t)width * height * colorDepth;
+
+		if (dataSize > mBlock.capacity || dataSize < mBlock.capacity / 4)
 		{
-			if (mData)
-				delete[] mData;
+			BufferPool & pool = BufferPool::Instance();
+			pool.release(mBlock);
+			mBlock = pool.acquire(dataSize);
+			mData = mBlock.data;
 
-			size_t dataSize = width * height * mColorDepth;
-			mData = new uint8_t[dataSize];
-			memset(mData, 0, dataSize);
+			if (dataSize > 0 && !mData)
+				width = height = 0;
 		}
 		mWidth = width;
 		mHeight = height;
 		mColorDepth = colorDepth;
+
+		mDirty.setBounds(width, height);
+		mDirty.addAll();
+
+		if (clear && mData)
+			memset(mData, 0, dataSize);
+
+		return mData || dataSize == 0;
 	}
 
 	void clear() {
+		discardCompressed();
 		if(mData)
 			memset(mData, 0, size());
+		mDirty.addAll();
 	}
 
+	// Writes through data() are not tracked, mark what they changed
+	void markDirty(int x, int y, int width, int height) { mDirty.add(DirtyRect(x, y, width, height)); }
+	void markDirty() { mDirty.addAll(); }
+	void clearDirty() { mDirty.clear(); }
+
+	DirtyRegion & dirtyRegion() { return mDirty; }
+	const DirtyRegion & dirtyRegion() const { return mDirty; }
+
 	// Set the alpha channel to 0
 	void clearMask() {
 
@@ -100,60 +200,205 @@ public:
 	void setData(const uint8_t *data) {
 		
 		// Blit the image
+		if (!beginWrite(true))
+			return;
 		memcpy_s(mData, size(), data, size());
+		mDirty.addAll();
 	}
 
+	// Blit an image into rect, which must lie inside the buffer, and mark
+	// only rect as changed. srcStride is in bytes, 0 for packed rows.
+	void setData(const uint8_t *data, const DirtyRect &rect, int srcStride = 0) {
 
-	void setData(const uint8_t *colorData, const uint8_t *depthData) {
+		if (!beginWrite(false))
+			return;
 
-		uint8_t *dst = mData;
+		const int rowBytes = rect.width * mColorDepth;
+		if (srcStride == 0)
+			srcStride = rowBytes;
+
+		for (int y = 0; y < rect.height; y++)
+			memcpy_s(mData + ((size_t)(rect.y + y) * mWidth + rect.x) * mColorDepth, rowBytes, data + (size_t)y * srcStride, rowBytes);
+
+		mDirty.add(rect);
+	}
+
+	// Copy a view, row by row if it has padding. Better still, hand the view
+	// on to its consumer as is, it does not need a FrameBuffer.
+	void setData(const FrameView &view) {
 
-		// Expand for more efficiency
+		if (!resize(view.width(), view.height(), view.colorDepth()))
+			return;
 
-		if (mColorDepth >= 4)
+		if (view.isContinuous())
 		{
-			// Copy both color and depth
-			for (int i = 0; i<mHeight; i++)
-			{
-				for (int j = 0; j<mWidth; j++)
-				{
-					if (colorData)
-					{
-						dst[0] = *colorData++;
-						dst[1] = *colorData++;
-						dst[2] = *colorData++;
-					}
+			memcpy_s(mData, size(), view.data(), size());
+			return;
+		}
+
+		for (int y = 0; y < mHeight; y++)
+			memcpy_s(mData + (size_t)y * pitch(), pitch(), view.row(y), pitch());
+	}
+
+
+	void setData(const uint8_t *colorData, const uint8_t *depthData, bool bgr = false) {
+
+		if (mColorDepth < 4)
+		{
+			// Copy only color, or only depth
+			if (mColorDepth == 3 && colorData)
+				setData(colorData);
+			else if (mColorDepth == 1 && depthData)
+				setData(depthData);
+			return;
+		}
+
+		// 4 channels with color are all written, the others keep some bytes
+		if (!beginWrite(mColorDepth == 4 && colorData))
+			return;
 
-					if (depthData)
-						dst[3] = *depthData++;
-					else
-						dst[3] = 0xFF;
+		const size_t count = (size_t)mWidth * mHeight;
+		mDirty.addAll();
 
-					dst += mColorDepth;
+		if (mColorDepth == 4 && (colorData || depthData))
+		{
+			// one specialised kernel per combination, no branch per pixel
+			if (colorData && depthData)
+				bgr ? PackBGRDToRGBA(colorData, depthData, mData, count) : PackRGBDToRGBA(colorData, depthData, mData, count);
+			else if (colorData)
+				bgr ? PackBGRToRGBA(colorData, mData, count) : PackRGBToRGBA(colorData, mData, count);
+			else
+				PackDepthToAlpha(depthData, mData, count);
+		}
+		else
+		{
+			// Copy both color and depth, the alpha is 0xFF without depth
+			const int r = bgr ? 2 : 0, b = bgr ? 0 : 2;
+			uint8_t *dst = mData;
+			for (size_t i = 0; i < count; i++)
+			{
+				if (colorData)
+				{
+					dst[0] = colorData[r];
+					dst[1] = colorData[1];
+					dst[2] = colorData[b];
+					colorData += 3;
 				}
+
+				dst[3] = depthData ? *depthData++ : 0xFF;
+				dst += mColorDepth;
 			}
 		}
-		else if (mColorDepth == 3 && colorData)
+	}
+
+	// 16 bit depth through depthMap, in chunks so the mapped depth stays in
+	// L1 for the packing
+	void setData(const uint8_t *colorData, const uint16_t *depthData, const DepthMap &depthMap, bool bgr = false) {
+
+		if (!depthData)
 		{
-			// Copy only color
-			setData(colorData);
+			setData(colorData, (const uint8_t *)nullptr, bgr);
+			return;
 		}
-		else if (mColorDepth == 1 && depthData)
+
+		// depth alone, or depth with color in 3 or 4 channels, writes every byte
+		if (!beginWrite(mColorDepth == 1 || (colorData && (mColorDepth == 3 || mColorDepth == 4))))
+			return;
+
+		const size_t count = (size_t)mWidth * mHeight;
+		mDirty.addAll();
+
+		if (mColorDepth == 1)
 		{
-			// Copy only depth
-			setData(depthData);
+			depthMap.map(depthData, mData, count);
+			return;
+		}
+
+		const size_t chunk = 4096;
+		uint8_t depth[chunk];
+
+		for (size_t i = 0; i < count; i += chunk)
+		{
+			const size_t n = count - i < chunk ? count - i : chunk;
+			depthMap.map(depthData + i, depth, n);
+
+			uint8_t *dst = mData + i * mColorDepth;
+			const uint8_t *color = colorData ? colorData + i * 3 : nullptr;
+
+			if (mColorDepth == 4)
+			{
+				if (color)
+					bgr ? PackBGRDToRGBA(color, depth, dst, n) : PackRGBDToRGBA(color, depth, dst, n);
+				else
+					PackDepthToAlpha(depth, dst, n);
+			}
+			else if (mColorDepth > 4)
+			{
+				const int r = bgr ? 2 : 0, b = bgr ? 0 : 2;
+				for (size_t k = 0; k < n; k++, dst += mColorDepth)
+				{
+					if (color)
+					{
+						dst[0] = color[k * 3 + r];
+						dst[1] = color[k * 3 + 1];
+						dst[2] = color[k * 3 + b];
+					}
+					dst[3] = depth[k];
+				}
+			}
+			else if (mColorDepth == 3 && color)
+				memcpy_s(dst, n * 3, color, n * 3);
 		}
 	}
 
 	void operator=(const FrameBuffer & buffer)
 	{
-		resize(buffer.mWidth, buffer.mHeight, buffer.mColorDepth);
-		memcpy_s(mData, size(), buffer.mData, size());
+		if (this == &buffer)
+			return;
+
+		// stays compressed, the copy is of the compressed data
+		if (buffer.isCompressed())
+		{
+			BufferPool::Instance().release(mBlock);
+			mData = nullptr;
+			mCompressed = buffer.mCompressed;
+			mWidth = buffer.mWidth;
+			mHeight = buffer.mHeight;
+			mColorDepth = buffer.mColorDepth;
+			mDirty.setBounds(mWidth, mHeight);
+			mDirty.addAll();
+			return;
+		}
+
+		if (resize(buffer.mWidth, buffer.mHeight, buffer.mColorDepth) && mData)
+			memcpy_s(mData, size(), buffer.mData, size());
+	}
+
+	void operator=(FrameBuffer && buffer)
+	{
+		if (this == &buffer)
+			return;
+
+		BufferPool::Instance().release(mBlock);
+		mBlock = buffer.mBlock;
+		mData = buffer.mData;
+		mWidth = buffer.mWidth;
+		mHeight = buffer.mHeight;
+		mColorDepth = buffer.mColorDepth;
+		mCompressed = std::move(buffer.mCompressed);
+		mDirty = std::move(buffer.mDirty);
+
+		buffer.mBlock = PoolBlock();
+		buffer.mData = nullptr;
+		buffer.mCompressed.clear();
+		buffer.mWidth = buffer.mHeight = 0;
+		buffer.mDirty = DirtyRegion();
 	}
 
 #ifdef YUP_INCLUDE_OPENCV
 
-	void setData(const cv::Mat &colorMat, const cv::Mat &depthMat, bool showDepth = false) {
+	// colorMat is packed as is (R first), set bgr for the usual OpenCV order
+	void setData(const cv::Mat &colorMat, const cv::Mat &depthMat, bool showDepth = false, bool bgr = false) {
 
 		// accept only char type matrices
 		CV_Assert(colorMat.depth() == CV_8U && colorMat.elemSize() == 3);
@@ -164,7 +409,8 @@ public:
 		int height = colorMat.rows;
 
 		// Resize mBackBuffer to fit the image
-		resize(width, height);
+		if (!resize(width, height))
+			return;
 
 		if (colorMat.isContinuous() && depthMat.isContinuous())
 		{
@@ -173,19 +419,33 @@ public:
 		}
 
 		uint8_t *dst = mData;
-		const uint8_t *pColor;
-		const uint8_t *pDepth;
 		for (int h = 0; h < height; ++h)
 		{
-			pColor = colorMat.ptr<uint8_t>(h);
-			pDepth = depthMat.ptr<uint8_t>(h);
+			const uint8_t *pColor = colorMat.ptr<uint8_t>(h);
+			const uint8_t *pDepth = depthMat.ptr<uint8_t>(h);
+
+			if (mColorDepth == 4)
+			{
+				// the kernels write packed 4 byte pixels
+				if (showDepth)
+					PackDepthToRGBA(pDepth, dst, width);
+				else if (bgr)
+					PackBGRDToRGBA(pColor, pDepth, dst, width);
+				else
+					PackRGBDToRGBA(pColor, pDepth, dst, width);
+
+				dst += width * 4;
+				continue;
+			}
+
+			const int r = bgr ? 2 : 0, b = bgr ? 0 : 2;
 			for (int w = 0; w < width; ++w)
 			{
 				if (!showDepth)
 				{
-					dst[0] = pColor[w * 3];
+					dst[0] = pColor[w * 3 + r];
 					dst[1] = pColor[w * 3 + 1];
-					dst[2] = pColor[w * 3 + 2];
+					dst[2] = pColor[w * 3 + b];
 					dst[3] = pDepth[w];
 				}
 				else
@@ -201,73 +461,75 @@ public:
 		}
 	}
 
+	// Copy into mat, which is (re)allocated if it does not have the size and
+	// the channels of the buffer
 	void loadMatrix(cv::Mat &mat) const {
-		// accept only char type matrices
-		CV_Assert(mat.rows == mHeight);
-		CV_Assert(mat.cols == mWidth);
-		
-		LoadMatrix8(mat, mData);
+		mat.create(mHeight, mWidth, CV_8UC(mColorDepth));
+
+		LoadMatrix8(mat, cst_data());
+	}
+
+	// A matrix header over the pixels, no copy. It shares the memory of the
+	// buffer and is valid while the buffer is not resized or destroyed.
+	cv::Mat matrix() {
+		return cv::Mat(mHeight, mWidth, CV_8UC(mColorDepth), data());
 	}
 
 #endif // YUP_INCLUDE_OPENCV
 
+private:
+	// all pixels are about to be written, the compressed ones are not needed
+	void discardCompressed() {
+		if (isCompressed())
+			resize(mWidth, mHeight);
+	}
+
+	// Plain pixels to write to, false if there are none. whole is set when
+	// every byte gets overwritten, the old frame is then dropped undecoded.
+	bool beginWrite(bool whole) {
+		if (whole)
+			discardCompressed();
+		else if (!decompress())
+			return false;
+
+		return mData != nullptr;
+	}
 };
 
 #ifdef YUP_INCLUDE_OPENCV
 
-static void LoadMatrix8(cv::Mat &mat, const uint8_t *data)
+// one memcpy when both sides are continuous, one per row otherwise
+static void LoadMatrixRows(cv::Mat &mat, const uint8_t *data, size_t srcStride)
 {
-	// accept only char type matrices
-	CV_Assert(mat.depth() == CV_8U);
-
-	const int channels = mat.channels();
+	const size_t rowBytes = mat.cols * mat.elemSize();
 
-	int nRows = mat.rows;
-	int nCols = mat.cols * channels;
+	if (srcStride == 0)
+		srcStride = rowBytes;
 
-	if (mat.isContinuous())
+	if (mat.isContinuous() && srcStride == rowBytes)
 	{
-		nCols *= nRows;
-		nRows = 1;
+		memcpy_s(mat.data, rowBytes * mat.rows, data, rowBytes * mat.rows);
+		return;
 	}
 
-
-	uint8_t* p;
-	for (int r = 0; r < nRows; ++r)
-	{
-		p = mat.ptr<uint8_t>(r);
-		for (int c = 0; c < nCols; ++c)
-			p[c] = data[c];
-
-		data += nCols * channels;
-	}
+	for (int r = 0; r < mat.rows; ++r)
+		memcpy_s(mat.ptr<uint8_t>(r), rowBytes, data + r * srcStride, rowBytes);
 }
 
-static void LoadMatrix16(cv::Mat &mat, const uint16_t *data)
+static void LoadMatrix8(cv::Mat &mat, const uint8_t *data, size_t srcStride)
 {
 	// accept only char type matrices
-	CV_Assert(mat.depth() == CV_16U);
-
-	const int channels = mat.channels();
-
-	int nRows = mat.rows;
-	int nCols = mat.cols * channels;
+	CV_Assert(mat.depth() == CV_8U);
 
-	if (mat.isContinuous())
-	{
-		nCols *= nRows;
-		nRows = 1;
-	}
+	LoadMatrixRows(mat, data, srcStride);
+}
 
-	uint16_t* p;
-	for (int r = 0; r < nRows; ++r)
-	{
-		p = mat.ptr<uint16_t>(r);
-		for (int c = 0; c < nCols; ++c)
-			p[c] = data[c];
+static void LoadMatrix16(cv::Mat &mat, const uint16_t *data, size_t srcStride)
+{
+	// accept only 16 bit matrices
+	CV_Assert(mat.depth() == CV_16U);
 
-		data += nCols * channels;
-	}
+	LoadMatrixRows(mat, (const uint8_t *)data, srcStride);
 }
 
 #endif // YUP_INCLUDE_OPENCV
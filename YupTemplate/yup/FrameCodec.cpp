@@ -0,0 +1,655 @@
+// ========================================================================== //
+//
+//  FrameCodec.cpp
+//  ---
+//
+//  Created: 2016-08-24
+//  Updated: 2016-08-24
+//
+//  (C) 2016 Yu-hsien Chang
+//
+// ========================================================================== //
+
+#include <algorithm>
+#include <cstring>
+
+#include "FrameCodec.h"
+#include "BufferPool.h"
+#include "FrameBuffer.h"
+#include "Parallel.h"
+#include "Simd.h"
+
+BEGIN_NAMESPACE_YUP
+
+// -------------------------------------------------------------------------- //
+//  residual blocks
+// -------------------------------------------------------------------------- //
+static const int BlockSize = 16;
+static const int ZeroRun = 0x80;			// header of a run of 1 to 128 zero blocks
+static const int MaxBlockBytes = 1 + BlockSize * 2;
+
+// bits needed for v < 2^16
+static inline int BitWidth(uint32_t v)
+{
+	int width = 0;
+	if (v >= 1u << 8) { width += 8; v >>= 8; }
+	if (v >= 1u << 4) { width += 4; v >>= 4; }
+	if (v >= 1u << 2) { width += 2; v >>= 2; }
+	if (v >= 1u << 1) { width += 1; v >>= 1; }
+	return width + (int)v;
+}
+
+static inline uint16_t BlockBits(const uint16_t *symbols, size_t count)
+{
+#if defined(YUP_SIMD_SSE2)
+	if (count == BlockSize)
+	{
+		__m128i bits = _mm_or_si128(_mm_loadu_si128((const __m128i *)symbols), _mm_loadu_si128((const __m128i *)(symbols + 8)));
+		bits = _mm_or_si128(bits, _mm_srli_si128(bits, 8));
+		bits = _mm_or_si128(bits, _mm_srli_si128(bits, 4));
+		bits = _mm_or_si128(bits, _mm_srli_si128(bits, 2));
+		return (uint16_t)_mm_cvtsi128_si32(bits);
+	}
+#endif
+
+	uint16_t bits = 0;
+	for (size_t k = 0; k < count; k++)
+		bits |= symbols[k];
+	return bits;
+}
+
+
+
+// 16 values of Width bits are 2 * Width bytes, a little endian bit stream
+// (x86 only). Each value is one step of a template, so every shift and
+// word index is a constant and no loop or branch is left.
+template <int Width, int K>
+struct BlockPacker
+{
+	static const int Word = K * Width / 64;
+	static const int Shift = K * Width % 64;
+	static const bool Straddles = Shift + Width > 64;
+
+	static inline void Pack(const uint16_t *symbols, uint64_t *words)
+	{
+		words[Word] |= (uint64_t)symbols[K] << Shift;
+		if (Straddles)
+			words[Straddles ? Word + 1 : Word] |= (uint64_t)symbols[K] >> ((64 - Shift) & 63);
+
+		BlockPacker<Width, K + 1>::Pack(symbols, words);
+	}
+
+	static inline void Unpack(const uint64_t *words, uint16_t *symbols)
+	{
+		uint64_t v = words[Word] >> Shift;
+		if (Straddles)
+			v |= words[Straddles ? Word + 1 : Word] << ((64 - Shift) & 63);
+		symbols[K] = (uint16_t)(v & ((1u << Width) - 1));
+
+		BlockPacker<Width, K + 1>::Unpack(words, symbols);
+	}
+};
+
+template <int Width>
+struct BlockPacker<Width, BlockSize>
+{
+	static inline void Pack(const uint16_t *, uint64_t *) {}
+	static inline void Unpack(const uint64_t *, uint16_t *) {}
+};
+
+template <int Width>
+static void PackBlock(const uint16_t *symbols, uint8_t *out)
+{
+	uint64_t words[4] = {};
+	BlockPacker<Width, 0>::Pack(symbols, words);
+	memcpy(out, words, 2 * Width);
+}
+
+template <int Width>
+static void UnpackBlock(const uint8_t *in, uint16_t *symbols)
+{
+	uint64_t words[4] = {};
+	memcpy(words, in, 2 * Width);
+	BlockPacker<Width, 0>::Unpack(words, symbols);
+}
+
+typedef void (*PackBlockFunc)(const uint16_t *, uint8_t *);
+typedef void (*UnpackBlockFunc)(const uint8_t *, uint16_t *);
+
+static const PackBlockFunc PackBlockFuncs[17] = {
+	nullptr,           PackBlock<1>,  PackBlock<2>,  PackBlock<3>,  PackBlock<4>,
+	PackBlock<5>,  PackBlock<6>,  PackBlock<7>,  PackBlock<8>,
+	PackBlock<9>,  PackBlock<10>, PackBlock<11>, PackBlock<12>,
+	PackBlock<13>, PackBlock<14>, PackBlock<15>, PackBlock<16>,
+};
+
+static const UnpackBlockFunc UnpackBlockFuncs[17] = {
+	nullptr,             UnpackBlock<1>,  UnpackBlock<2>,  UnpackBlock<3>,  UnpackBlock<4>,
+	UnpackBlock<5>,  UnpackBlock<6>,  UnpackBlock<7>,  UnpackBlock<8>,
+	UnpackBlock<9>,  UnpackBlock<10>, UnpackBlock<11>, UnpackBlock<12>,
+	UnpackBlock<13>, UnpackBlock<14>, UnpackBlock<15>, UnpackBlock<16>,
+};
+
+// n symbols to out, returns the bytes written
+static size_t PackBlocks(const uint16_t *symbols, size_t n, uint8_t *out)
+{
+	uint8_t *p = out;
+
+	size_t i = 0;
+	while (i < n)
+	{
+		size_t count = std::min((size_t)BlockSize, n - i);
+		uint16_t bits = BlockBits(symbols + i, count);
+
+		if (bits == 0)
+		{
+			int run = 0;
+			do
+			{
+				i += count;
+				run++;
+				count = std::min((size_t)BlockSize, n - i);
+				bits = i < n ? BlockBits(symbols + i, count) : 1;
+			} while (run < 128 && bits == 0);
+
+			*p++ = (uint8_t)(ZeroRun | (run - 1));
+			continue;
+		}
+
+		const int width = BitWidth(bits);
+		*p++ = (uint8_t)width;
+
+		// the last, short block is padded with zeros
+		const uint16_t *block = symbols + i;
+		uint16_t padded[BlockSize];
+		if (count < BlockSize)
+		{
+			memset(padded, 0, sizeof(padded));
+			memcpy(padded, block, count * sizeof(uint16_t));
+			block = padded;
+		}
+
+		PackBlockFuncs[width](block, p);
+		p += 2 * width;
+		i += count;
+	}
+
+	return p - out;
+}
+
+static void UnpackBlocks(const uint8_t *in, uint16_t *symbols, size_t n)
+{
+	size_t i = 0;
+	while (i < n)
+	{
+		const int header = *in++;
+
+		if (header & ZeroRun)
+		{
+			size_t count = std::min((size_t)((header & ~ZeroRun) + 1) * BlockSize, n - i);
+			memset(symbols + i, 0, count * sizeof(uint16_t));
+			i += count;
+			continue;
+		}
+
+		const int width = header;
+		const size_t count = std::min((size_t)BlockSize, n - i);
+
+		if (count == BlockSize)
+			UnpackBlockFuncs[width](in, symbols + i);
+		else
+		{
+			uint16_t padded[BlockSize];
+			UnpackBlockFuncs[width](in, padded);
+			memcpy(symbols + i, padded, count * sizeof(uint16_t));
+		}
+
+		in += 2 * width;
+		i += count;
+	}
+}
+
+
+
+// -------------------------------------------------------------------------- //
+//  prediction
+// -------------------------------------------------------------------------- //
+// the wrapped difference, zigzagged so small magnitudes are small
+static inline uint16_t ZigZag8(int d)
+{
+	d = (int)((uint32_t)d << 24) >> 24;
+	return (uint16_t)(((uint32_t)d << 1) ^ (uint32_t)(d >> 31));
+}
+
+static inline uint16_t ZigZag16(int d)
+{
+	d = (int)((uint32_t)d << 16) >> 16;
+	return (uint16_t)(((uint32_t)d << 1) ^ (uint32_t)(d >> 31));
+}
+
+static inline int UnZigZag(uint16_t s)
+{
+	return (s >> 1) ^ -(int)(s & 1);
+}
+
+// LOCO-I median of the left, upper and upper left sample, which is the
+// median of a, b and a + b - c. Written with masks, as branches on image
+// data mispredict.
+static inline int Med(int a, int b, int c)
+{
+	const int ab = (a - b) & ((a - b) >> 31);
+	const int lo = b + ab, hi = a - ab;
+
+	int g = a + b - c;
+	g += (hi - g) & ((hi - g) >> 31);			// min(hi, g)
+	return lo - ((lo - g) & ((lo - g) >> 31));	// max(lo, g)
+}
+
+#if defined(YUP_SIMD_SSE2)
+static inline __m128i Load8x8(const uint8_t *p)
+{
+	return _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)p), _mm_setzero_si128());
+}
+
+static inline __m128i ZigZag8x8(__m128i d)
+{
+	d = _mm_srai_epi16(_mm_slli_epi16(d, 8), 8);
+	return _mm_xor_si128(_mm_slli_epi16(d, 1), _mm_srai_epi16(d, 15));
+}
+
+static inline __m128i ZigZag16x8(__m128i d)
+{
+	return _mm_xor_si128(_mm_slli_epi16(d, 1), _mm_srai_epi16(d, 15));
+}
+
+static inline __m128i UnZigZag16x8(__m128i s)
+{
+	const __m128i sign = _mm_sub_epi16(_mm_setzero_si128(), _mm_and_si128(s, _mm_set1_epi16(1)));
+	return _mm_xor_si128(_mm_srli_epi16(s, 1), sign);
+}
+
+// green of RGBA pixels moved onto red and blue
+static inline __m128i GreenOnRB(__m128i p)
+{
+	return _mm_or_si128(_mm_and_si128(_mm_srli_epi32(p, 8), _mm_set1_epi32(0x000000FF)),
+	                    _mm_and_si128(_mm_slli_epi32(p, 8), _mm_set1_epi32(0x00FF0000)));
+}
+#endif
+
+// 8 bit channels, MED of the left, upper and upper left sample. The first
+// row is coded below a row of zeros, which gives the left sample as the
+// prediction, and the first pixel of a row is predicted from above.
+static void EncodeRow8(const uint8_t *cur, const uint8_t *prev, uint16_t *symbols, int count, int channels)
+{
+	int i = 0;
+	for (; i < channels && i < count; i++)
+		symbols[i] = ZigZag8(cur[i] - prev[i]);
+
+#if defined(YUP_SIMD_SSE2)
+	for (; i + 8 <= count; i += 8)
+	{
+		const __m128i a = Load8x8(cur + i - channels), b = Load8x8(prev + i), c = Load8x8(prev + i - channels);
+		const __m128i lo = _mm_min_epi16(a, b), hi = _mm_max_epi16(a, b);
+		const __m128i pred = _mm_max_epi16(lo, _mm_min_epi16(hi, _mm_sub_epi16(_mm_add_epi16(a, b), c)));
+		_mm_storeu_si128((__m128i *)(symbols + i), ZigZag8x8(_mm_sub_epi16(Load8x8(cur + i), pred)));
+	}
+#endif
+	for (; i < count; i++)
+		symbols[i] = ZigZag8(cur[i] - Med(cur[i - channels], prev[i], prev[i - channels]));
+}
+
+#if defined(YUP_SIMD_SSE2)
+// The channels of a pixel side by side in 16 bit lanes, one pixel per step.
+// Reads and writes 4 bytes (and 4 symbols) per pixel, so with 3 channels
+// the rows and the symbols need a byte and a symbol of padding.
+template <int Channels>
+static void DecodeRowMed(const uint16_t *symbols, uint8_t *cur, const uint8_t *prev, int count)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i low = _mm_set1_epi16(0x00FF);
+
+	__m128i left = zero, upLeft = zero;
+	for (int i = 0; i < count; i += Channels)
+	{
+		uint32_t bytes;
+		memcpy(&bytes, prev + i, 4);
+		const __m128i up = _mm_unpacklo_epi8(_mm_cvtsi32_si128((int)bytes), zero);
+		const __m128i d = UnZigZag16x8(_mm_loadl_epi64((const __m128i *)(symbols + i)));
+
+		const __m128i lo = _mm_min_epi16(left, up), hi = _mm_max_epi16(left, up);
+		const __m128i pred = _mm_max_epi16(lo, _mm_min_epi16(hi, _mm_sub_epi16(_mm_add_epi16(left, up), upLeft)));
+		left = _mm_and_si128(_mm_add_epi16(pred, d), low);
+		upLeft = up;
+
+		bytes = (uint32_t)_mm_cvtsi128_si32(_mm_packus_epi16(left, left));
+		memcpy(cur + i, &bytes, 4);
+	}
+}
+#endif
+
+// Each sample depends on the one decoded before it, so only the channels
+// of a pixel are decoded together
+static void DecodeRow8(const uint16_t *symbols, uint8_t *cur, const uint8_t *prev, int count, int channels)
+{
+#if defined(YUP_SIMD_SSE2)
+	if (channels == 3)
+	{
+		DecodeRowMed<3>(symbols, cur, prev, count);
+		return;
+	}
+	if (channels == 4)
+	{
+		DecodeRowMed<4>(symbols, cur, prev, count);
+		return;
+	}
+#endif
+
+	int i = 0;
+	for (; i < channels && i < count; i++)
+		cur[i] = (uint8_t)(prev[i] + UnZigZag(symbols[i]));
+
+	for (; i < count; i++)
+		cur[i] = (uint8_t)(Med(cur[i - channels], prev[i], prev[i - channels]) + UnZigZag(symbols[i]));
+}
+
+// 16 bit depth, from the row above, the first row from the left. Depth is
+// smooth enough that the median does not pay for its cost here.
+static void EncodeRow16(const uint16_t *cur, const uint16_t *prev, uint16_t *symbols, int count)
+{
+	int i = 0;
+	if (!prev)
+	{
+		if (count > 0)
+			symbols[i++] = ZigZag16(cur[0]);
+	}
+
+	const uint16_t *pred = prev ? prev : cur - 1;
+
+#if defined(YUP_SIMD_SSE2)
+	for (; i + 8 <= count; i += 8)
+	{
+		__m128i d = _mm_sub_epi16(_mm_loadu_si128((const __m128i *)(cur + i)), _mm_loadu_si128((const __m128i *)(pred + i)));
+		_mm_storeu_si128((__m128i *)(symbols + i), ZigZag16x8(d));
+	}
+#endif
+	for (; i < count; i++)
+		symbols[i] = ZigZag16(cur[i] - pred[i]);
+}
+
+static void DecodeRow16(const uint16_t *symbols, uint16_t *cur, const uint16_t *prev, int count)
+{
+	if (!prev)
+	{
+		int left = 0;
+		for (int i = 0; i < count; i++)
+			cur[i] = (uint16_t)(left = (uint16_t)(left + UnZigZag(symbols[i])));
+		return;
+	}
+
+	int i = 0;
+#if defined(YUP_SIMD_SSE2)
+	for (; i + 8 <= count; i += 8)
+	{
+		__m128i d = UnZigZag16x8(_mm_loadu_si128((const __m128i *)(symbols + i)));
+		_mm_storeu_si128((__m128i *)(cur + i), _mm_add_epi16(_mm_loadu_si128((const __m128i *)(prev + i)), d));
+	}
+#endif
+	for (; i < count; i++)
+		cur[i] = (uint16_t)(prev[i] + UnZigZag(symbols[i]));
+}
+
+// Read a row as samples, green subtracted from red and blue
+static void ReadRow8(const uint8_t *src, uint8_t *row, int count, int channels)
+{
+	if (channels < 3)
+	{
+		memcpy(row, src, count);
+		return;
+	}
+
+	int i = 0;
+#if defined(YUP_SIMD_SSE2)
+	if (channels == 4)
+	{
+		for (; i + 16 <= count; i += 16)
+		{
+			__m128i p = _mm_loadu_si128((const __m128i *)(src + i));
+			_mm_storeu_si128((__m128i *)(row + i), _mm_sub_epi8(p, GreenOnRB(p)));
+		}
+	}
+#endif
+	for (; i < count; i += channels)
+	{
+		row[i] = (uint8_t)(src[i] - src[i + 1]);
+		row[i + 1] = src[i + 1];
+		row[i + 2] = (uint8_t)(src[i + 2] - src[i + 1]);
+		for (int k = 3; k < channels; k++)
+			row[i + k] = src[i + k];
+	}
+}
+
+static void WriteRow8(const uint8_t *row, uint8_t *dst, int count, int channels)
+{
+	if (channels < 3)
+	{
+		memcpy(dst, row, count);
+		return;
+	}
+
+	int i = 0;
+#if defined(YUP_SIMD_SSE2)
+	if (channels == 4)
+	{
+		for (; i + 16 <= count; i += 16)
+		{
+			__m128i p = _mm_loadu_si128((const __m128i *)(row + i));
+			_mm_storeu_si128((__m128i *)(dst + i), _mm_add_epi8(p, GreenOnRB(p)));
+		}
+	}
+#endif
+	for (; i < count; i += channels)
+	{
+		dst[i] = (uint8_t)(row[i] + row[i + 1]);
+		dst[i + 1] = row[i + 1];
+		dst[i + 2] = (uint8_t)(row[i + 2] + row[i + 1]);
+		for (int k = 3; k < channels; k++)
+			dst[i + k] = row[i + k];
+	}
+}
+
+// Per thread buffers, kept between calls so the worker pool codes frame
+// after frame without allocating
+struct CodecScratch
+{
+	static const size_t RowPad = 16;
+
+	std::vector<uint16_t> symbols;
+	std::vector<uint8_t> rows8;				// a row of zeros and two rows
+	std::vector<uint16_t> rows16;			// two rows
+	size_t stride = 0;						// of the rows, with padding
+
+	void reserve(size_t symbolCount, size_t rowSamples)
+	{
+		if (symbols.size() < symbolCount + RowPad)
+			symbols.resize(symbolCount + RowPad);
+
+		if (stride < rowSamples + RowPad)
+		{
+			stride = rowSamples + RowPad;
+			rows8.assign(stride * 3, 0);
+			rows16.assign(stride * 2, 0);
+		}
+	}
+
+	const uint8_t * zeros8() const { return rows8.data(); }
+	uint8_t * row8(int y) { return rows8.data() + stride * (1 + (y & 1)); }
+	uint16_t * row16(int y) { return rows16.data() + stride * (y & 1); }
+};
+
+static CodecScratch & ThreadScratch()
+{
+	static thread_local CodecScratch scratch;
+	return scratch;
+}
+
+// rows [begin, end) of frame to symbols, the rows are read into scratch so
+// they need not be aligned
+static void EncodeBand(const FrameView &frame, int begin, int end, int channels, CodecScratch &scratch)
+{
+	const int count = frame.width() * channels;
+	uint16_t *symbols = scratch.symbols.data();
+
+	if (frame.colorDepth() == 2)
+	{
+		for (int y = begin; y < end; y++, symbols += count)
+		{
+			uint16_t *cur = scratch.row16(y);
+			memcpy(cur, frame.row(y), count * sizeof(uint16_t));
+			EncodeRow16(cur, y > begin ? scratch.row16(y - 1) : nullptr, symbols, count);
+		}
+		return;
+	}
+
+	for (int y = begin; y < end; y++, symbols += count)
+	{
+		uint8_t *cur = scratch.row8(y);
+		ReadRow8(frame.row(y), cur, count, channels);
+		EncodeRow8(cur, y > begin ? scratch.row8(y - 1) : scratch.zeros8(), symbols, count, channels);
+	}
+}
+
+// symbols to rows [begin, end) of an image of width pixels per row at data
+static void DecodeBand(uint8_t *data, int width, int colorDepth, int begin, int end, int channels, CodecScratch &scratch)
+{
+	const int count = width * channels;
+	const size_t pitch = (size_t)width * colorDepth;
+	const uint16_t *symbols = scratch.symbols.data();
+
+	if (colorDepth == 2)
+	{
+		for (int y = begin; y < end; y++, symbols += count)
+		{
+			uint16_t *cur = scratch.row16(y);
+			DecodeRow16(symbols, cur, y > begin ? scratch.row16(y - 1) : nullptr, count);
+			memcpy(data + y * pitch, cur, count * sizeof(uint16_t));
+		}
+		return;
+	}
+
+	for (int y = begin; y < end; y++, symbols += count)
+	{
+		uint8_t *cur = scratch.row8(y);
+		DecodeRow8(symbols, cur, y > begin ? scratch.row8(y - 1) : scratch.zeros8(), count, channels);
+		WriteRow8(cur, data + y * pitch, count, channels);
+	}
+}
+
+
+
+// -------------------------------------------------------------------------- //
+//  CompressedFrame
+// -------------------------------------------------------------------------- //
+bool CompressedFrame::compress(const FrameView &frame)
+{
+	mData.clear();
+	mBandOffsets.clear();
+
+	mWidth = frame.width();
+	mHeight = frame.height();
+	mColorDepth = frame.colorDepth();
+
+	const bool depth16 = mColorDepth == 2;
+	const int channels = depth16 ? 1 : mColorDepth;
+	const int bands = (mHeight + BandRows - 1) / BandRows;
+	const size_t bandSymbols = (size_t)BandRows * mWidth * channels;
+	const size_t bandBytes = (bandSymbols + BlockSize - 1) / BlockSize * MaxBlockBytes;
+
+	// each band is coded into its own slot of the worst case size, then the
+	// slots are packed together
+	PoolBlock scratch = BufferPool::Instance().acquire(bands * bandBytes);
+	if (!scratch.data && bands > 0)
+	{
+		mWidth = mHeight = 0;
+		return false;
+	}
+
+	std::vector<size_t> sizes(bands);
+
+	ParallelRows(bands, 1, [&](int bandBegin, int bandEnd) {
+		CodecScratch &local = ThreadScratch();
+		local.reserve(bandSymbols, (size_t)mWidth * channels);
+
+		for (int b = bandBegin; b < bandEnd; b++)
+		{
+			const int begin = b * BandRows, end = std::min(begin + BandRows, mHeight);
+			EncodeBand(frame, begin, end, channels, local);
+
+			sizes[b] = PackBlocks(local.symbols.data(), (size_t)(end - begin) * mWidth * channels, scratch.data + b * bandBytes);
+		}
+	}, 1);
+
+	mBandOffsets.assign(bands + 1, 0);
+	for (int b = 0; b < bands; b++)
+		mBandOffsets[b + 1] = (uint32_t)(mBandOffsets[b] + sizes[b]);
+
+	// a fresh vector, so the capacity is the compressed size
+	std::vector<uint8_t> data(mBandOffsets[bands]);
+	for (int b = 0; b < bands; b++)
+		memcpy(data.data() + mBandOffsets[b], scratch.data + b * bandBytes, sizes[b]);
+	mData.swap(data);
+
+	BufferPool::Instance().release(scratch);
+
+	return true;
+}
+
+
+
+void CompressedFrame::clear()
+{
+	mData.clear();
+	mData.shrink_to_fit();
+	mBandOffsets.clear();
+	mWidth = mHeight = 0;
+}
+
+
+
+bool CompressedFrame::decompress(FrameBuffer &frame) const
+{
+	if (empty())
+		return false;
+
+	if (!frame.resize(mWidth, mHeight, mColorDepth))
+		return false;
+
+	return decompress(frame.data());
+}
+
+
+
+bool CompressedFrame::decompress(uint8_t *data) const
+{
+	if (empty() || (!data && rawBytes() > 0))
+		return false;
+
+	const bool depth16 = mColorDepth == 2;
+	const int channels = depth16 ? 1 : mColorDepth;
+	const int bands = (int)mBandOffsets.size() - 1;
+
+	ParallelRows(bands, 1, [&](int bandBegin, int bandEnd) {
+		CodecScratch &local = ThreadScratch();
+		local.reserve((size_t)BandRows * mWidth * channels, (size_t)mWidth * channels);
+
+		for (int b = bandBegin; b < bandEnd; b++)
+		{
+			const int begin = b * BandRows, end = std::min(begin + BandRows, mHeight);
+			UnpackBlocks(mData.data() + mBandOffsets[b], local.symbols.data(), (size_t)(end - begin) * mWidth * channels);
+			DecodeBand(data, mWidth, mColorDepth, begin, end, channels, local);
+		}
+	}, 1);
+
+	return true;
+}
+
+END_NAMESPACE_YUP
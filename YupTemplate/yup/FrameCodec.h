@@ -0,0 +1,77 @@
+// ========================================================================== //
+//
+//  FrameCodec.h
+//  ---
+//  Lossless compression of frames for keeping them in memory, see also
+//  FrameBuffer::compress()
+//
+//  Each 8 bit channel is predicted from its left, upper and upper left
+//  neighbour (the LOCO-I median predictor), colour with green subtracted
+//  from red and blue first. Frames of 2 bytes per pixel are taken as 16 bit
+//  depth and predicted from the row above. The residuals are packed in
+//  blocks of 16 at the bit width of the largest, and runs of all zero
+//  blocks take a single byte.
+//
+//  The image is cut into bands of rows that are coded independently, on
+//  as many threads as ParallelRows() uses.
+//
+//  Created: 2016-08-24
+//  Updated: 2016-08-24
+//
+//  (C) 2016 Yu-hsien Chang
+//
+// ========================================================================== //
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "yup.h"
+#include "FrameView.h"
+
+BEGIN_NAMESPACE_YUP
+
+class FrameBuffer;
+
+// A frame in compressed form, e.g. for a replay buffer
+class CompressedFrame
+{
+private:
+	std::vector<uint8_t> mData;
+	std::vector<uint32_t> mBandOffsets;			// start of each band in mData, and the end
+
+	int mWidth = 0;
+	int mHeight = 0;
+	int mColorDepth = 0;
+
+public:
+	static const int BandRows = 32;
+
+	CompressedFrame() {}
+
+	explicit CompressedFrame(const FrameView &frame) { compress(frame); }
+
+	// replaces the contents, the storage is sized to the result, false and
+	// empty if the scratch memory could not be allocated
+	bool compress(const FrameView &frame);
+
+	// into frame, which is resized to fit
+	bool decompress(FrameBuffer &frame) const;
+
+	// into width() * height() * colorDepth() bytes at data, rows packed
+	bool decompress(uint8_t *data) const;
+
+	void clear();
+
+	int width() const { return mWidth; }
+	int height() const { return mHeight; }
+	int colorDepth() const { return mColorDepth; }
+	bool empty() const { return mBandOffsets.empty(); }
+
+	size_t compressedBytes() const { return mData.size(); }
+	size_t rawBytes() const { return (size_t)mWidth * mHeight * mColorDepth; }
+};
+
+END_NAMESPACE_YUP
@@ -0,0 +1,184 @@
+// ========================================================================== //
+//
+//  FrameRing.cpp
+//  ---
+//
+//  Created: 2016-08-24
+//  Updated: 2016-08-24
+//
+//  (C) 2016 Yu-hsien Chang
+//
+// ========================================================================== //
+
+#include <chrono>
+
+#include "FrameRing.h"
+
+BEGIN_NAMESPACE_YUP
+
+FrameRing::FrameRing(int capacity, int width, int height, int colorDepth)
+	: mSlots(new Slot[capacity])
+	, mCapacity(capacity)
+	, mSequence(0)
+{
+	for (int i = 0; i < capacity; i++)
+		mSlots[i].frame.resize(width, height, colorDepth);
+}
+
+
+int64_t FrameRing::Now()
+{
+	using namespace std::chrono;
+	return duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+
+int FrameRing::acquire()
+{
+	// a few rounds, a reader may take the chosen slot before we do
+	for (int attempt = 0; attempt < 4; attempt++)
+	{
+		int best = -1;
+		uint64_t bestSequence = UINT64_MAX;
+
+		for (int i = 0; i < mCapacity; i++)
+		{
+			int state = mSlots[i].state.load(std::memory_order_acquire);
+			if (state == Free)
+			{
+				best = i;
+				break;
+			}
+
+			uint64_t sequence = mSlots[i].sequence.load(std::memory_order_relaxed);
+			if (state == 0 && sequence < bestSequence)
+			{
+				best = i;
+				bestSequence = sequence;
+			}
+		}
+
+		if (best < 0)
+			return -1;
+
+		int expected = mSlots[best].state.load(std::memory_order_relaxed);
+		if ((expected == Free || expected == 0) &&
+			mSlots[best].state.compare_exchange_strong(expected, Writing, std::memory_order_acquire))
+			return best;
+	}
+
+	return -1;
+}
+
+void FrameRing::publish(int slot, int64_t timestamp)
+{
+	Slot &s = mSlots[slot];
+	s.timestamp.store(timestamp, std::memory_order_relaxed);
+	s.sequence.store(++mSequence, std::memory_order_relaxed);
+
+	// the frame, timestamp and sequence become visible with the state
+	s.state.store(0, std::memory_order_release);
+}
+
+void FrameRing::cancel(int slot)
+{
+	// the old frame may be half overwritten, do not publish it again
+	mSlots[slot].state.store(Free, std::memory_order_release);
+}
+
+
+bool FrameRing::tryRead(int i, uint64_t sequence)
+{
+	Slot &s = mSlots[i];
+
+	int state = s.state.load(std::memory_order_relaxed);
+	while (state >= 0)
+	{
+		if (s.state.compare_exchange_weak(state, state + 1, std::memory_order_acquire))
+		{
+			// written again between the scan and the increment
+			if (s.sequence.load(std::memory_order_relaxed) != sequence)
+			{
+				release(i);
+				return false;
+			}
+			return true;
+		}
+	}
+
+	return false;
+}
+
+int FrameRing::acquireLatest()
+{
+	for (int attempt = 0; attempt < 4; attempt++)
+	{
+		int best = -1;
+		uint64_t bestSequence = 0;
+
+		for (int i = 0; i < mCapacity; i++)
+		{
+			if (mSlots[i].state.load(std::memory_order_acquire) < 0)
+				continue;
+
+			uint64_t sequence = mSlots[i].sequence.load(std::memory_order_relaxed);
+			if (best < 0 || sequence > bestSequence)
+			{
+				best = i;
+				bestSequence = sequence;
+			}
+		}
+
+		if (best < 0)
+			return -1;
+
+		if (tryRead(best, bestSequence))
+			return best;
+	}
+
+	return -1;
+}
+
+int FrameRing::acquireNearest(int64_t timestamp)
+{
+	for (int attempt = 0; attempt < 4; attempt++)
+	{
+		int best = -1;
+		uint64_t bestSequence = 0;
+		int64_t bestDistance = 0;
+
+		for (int i = 0; i < mCapacity; i++)
+		{
+			if (mSlots[i].state.load(std::memory_order_acquire) < 0)
+				continue;
+
+			uint64_t sequence = mSlots[i].sequence.load(std::memory_order_relaxed);
+			int64_t distance = mSlots[i].timestamp.load(std::memory_order_relaxed) - timestamp;
+			if (distance < 0)
+				distance = -distance;
+
+			// ties go to the newer frame
+			if (best < 0 || distance < bestDistance || (distance == bestDistance && sequence > bestSequence))
+			{
+				best = i;
+				bestSequence = sequence;
+				bestDistance = distance;
+			}
+		}
+
+		if (best < 0)
+			return -1;
+
+		if (tryRead(best, bestSequence))
+			return best;
+	}
+
+	return -1;
+}
+
+void FrameRing::release(int slot)
+{
+	mSlots[slot].state.fetch_sub(1, std::memory_order_release);
+}
+
+END_NAMESPACE_YUP
@@ -0,0 +1,100 @@
+// ========================================================================== //
+//
+//  FrameRing.h
+//  ---
+//  A fixed ring of preallocated, timestamped FrameBuffers
+//
+//  A capture thread acquire()s a slot, fills its frame and publish()es it
+//  with the capture time. Readers take the latest frame, or the one nearest
+//  to a time (e.g. of a VR pose), and release() it when done. Published
+//  frames stay readable until the slot is written again, and the writer
+//  reuses the oldest frame nobody is reading, so the ring is also a short
+//  history. Nothing allocates or locks after construction: each slot has
+//  one atomic state word, and any number of threads can write or read.
+//
+//  Created: 2016-08-24
+//  Updated: 2016-08-24
+//
+//  (C) 2016 Yu-hsien Chang
+//
+// ========================================================================== //
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include "yup.h"
+#include "FrameBuffer.h"
+
+BEGIN_NAMESPACE_YUP
+
+class FrameRing
+{
+private:
+	// state: Free, Writing, or the number of readers (0 and up) of a
+	// published frame
+	static const int Free = -2;
+	static const int Writing = -1;
+
+	struct alignas(64) Slot
+	{
+		FrameBuffer frame;
+		std::atomic<int> state;
+		std::atomic<int64_t> timestamp;
+		std::atomic<uint64_t> sequence;
+
+		Slot() : state(Free), timestamp(0), sequence(0) {}
+	};
+
+	std::unique_ptr<Slot[]> mSlots;
+	int mCapacity = 0;
+
+	std::atomic<uint64_t> mSequence;
+
+	// take slot i for reading if it still holds sequence
+	bool tryRead(int i, uint64_t sequence);
+
+public:
+	FrameRing(int capacity, int width, int height, int colorDepth = 4);
+
+	FrameRing(const FrameRing &) = delete;
+	void operator=(const FrameRing &) = delete;
+
+	int capacity() const { return mCapacity; }
+
+	// steady clock in microseconds, the time base of the timestamps
+	static int64_t Now();
+
+	// ---- writer ----
+
+	// A slot to write, free or with the oldest frame nobody reads, -1 if
+	// every slot is busy. Its frame keeps its size and old contents.
+	int acquire();
+
+	// make the frame readable, with a new sequence number
+	void publish(int slot, int64_t timestamp);
+
+	// give a slot back without publishing it
+	void cancel(int slot);
+
+	// ---- readers ----
+
+	// the newest frame, -1 if none
+	int acquireLatest();
+
+	// the frame captured nearest to timestamp, -1 if none
+	int acquireNearest(int64_t timestamp);
+
+	// done with a frame from acquireLatest() or acquireNearest()
+	void release(int slot);
+
+	// ---- slots held by the caller ----
+
+	FrameBuffer & frame(int slot) { return mSlots[slot].frame; }
+	int64_t timestamp(int slot) const { return mSlots[slot].timestamp.load(std::memory_order_relaxed); }
+	uint64_t sequence(int slot) const { return mSlots[slot].sequence.load(std::memory_order_relaxed); }
+};
+
+END_NAMESPACE_YUP
@@ -0,0 +1,131 @@
+// ========================================================================== //
+//
+//  FrameView.h
+//  ---
+//  A non-owning, read only view of an image in memory that belongs to
+//  someone else
+//
+//  The view does not copy the pixels and gives no write access to them,
+//  writers go through the owner (FrameBuffer marks what changed). The owner of the memory can pass a
+//  release callback, which runs once the last copy of the view is gone, so
+//  a driver buffer or a cv::Mat stays alive as long as any view of it.
+//  Copies share that reference, moves hand it over.
+//
+//  Created: 2016-08-24
+//  Updated: 2016-08-24
+//
+//  (C) 2016 Yu-hsien Chang
+//
+// ========================================================================== //
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+#ifdef YUP_INCLUDE_OPENCV
+#include <opencv2/core/core.hpp>
+#endif
+
+#include "yup.h"
+
+BEGIN_NAMESPACE_YUP
+
+class FrameView
+{
+private:
+	// holds the release callback, shared by all copies of the view
+	std::shared_ptr<const void> mOwner;
+
+	const uint8_t * mData = nullptr;
+
+	int mWidth = 0;
+	int mHeight = 0;
+	int mColorDepth = 4;
+	int mStride = 0;			// bytes from one row to the next
+
+public:
+	FrameView() {}
+
+	// stride 0 means tightly packed rows
+	FrameView(const uint8_t *data, int width, int height, int colorDepth = 4, int stride = 0, std::function<void()> release = nullptr)
+	: mData(data)
+	, mWidth(width)
+	, mHeight(height)
+	, mColorDepth(colorDepth)
+	, mStride(stride ? stride : width * colorDepth)
+	{
+		if (release)
+			mOwner = std::shared_ptr<const void>(data, [release](const void *) { release(); });
+	}
+
+#ifdef YUP_INCLUDE_OPENCV
+
+	// shares the matrix data, the view keeps a reference to it
+	explicit FrameView(const cv::Mat &mat)
+	: FrameView(mat.data, mat.cols, mat.rows, (int)mat.elemSize(), (int)mat.step[0])
+	{
+		if (mData)
+			mOwner = std::make_shared<cv::Mat>(mat);
+	}
+
+#endif // YUP_INCLUDE_OPENCV
+
+	FrameView(const FrameView &) = default;
+	FrameView & operator=(const FrameView &) = default;
+
+	// the moved from view is left empty
+	FrameView(FrameView && view) noexcept {
+		*this = std::move(view);
+	}
+
+	FrameView & operator=(FrameView && view) noexcept {
+		if (this != &view)
+		{
+			mOwner = std::move(view.mOwner);
+			mData = view.mData;
+			mWidth = view.mWidth;
+			mHeight = view.mHeight;
+			mColorDepth = view.mColorDepth;
+			mStride = view.mStride;
+			view.reset();
+		}
+		return *this;
+	}
+
+	int width() const { return mWidth; }
+	int height() const { return mHeight; }
+	int colorDepth() const { return mColorDepth; }
+	int stride() const { return mStride; }
+	int pitch() const { return mWidth * mColorDepth; }			// bytes of pixels in a row
+	bool empty() const { return mData == nullptr; }
+
+	// true when the rows follow each other without padding
+	bool isContinuous() const { return mStride == pitch(); }
+
+	const uint8_t * data() const { return mData; }
+	const uint8_t * row(int y) const { return mData + (size_t)y * mStride; }
+
+#ifdef YUP_INCLUDE_OPENCV
+
+	// Copy into mat (1 byte channels), which is (re)allocated if it does not
+	// have the size and the channels of the view. A cv::Mat header over the
+	// pixels would be writable, so there is none.
+	void loadMatrix(cv::Mat &mat) const {
+		// the header is only read by copyTo
+		cv::Mat(mHeight, mWidth, CV_8UC(mColorDepth), const_cast<uint8_t *>(mData), mStride).copyTo(mat);
+	}
+
+#endif // YUP_INCLUDE_OPENCV
+
+	// drop the reference, the release callback runs if this was the last one
+	void reset() {
+		mOwner.reset();
+		mData = nullptr;
+		mWidth = mHeight = mStride = 0;
+	}
+};
+
+END_NAMESPACE_YUP
@@ -0,0 +1,252 @@
+// ========================================================================== //
+//
+//  Frustum.cpp
+//  ---
+//  The SIMD paths test 4 items at a time with the same operation order as
+//  the scalar tests, so both give the same answer.
+//
+//  Created: 2016-08-24
+//  Updated: 2016-08-24
+//
+//  (C) 2016 Yu-hsien Chang
+//
+// ========================================================================== //
+
+#include "Frustum.h"
+#include "Simd.h"
+
+BEGIN_NAMESPACE_YUP
+
+// a plane that every point is inside of
+static const float OPEN_PLANE_D = 1e30f;
+
+
+
+// -------------------------------------------------------------------------- //
+//  Gribb/Hartmann, the planes are sums/differences of the rows of the matrix
+// -------------------------------------------------------------------------- //
+void Frustum::set(const Matrix4& viewProj)
+{
+    const float* m = viewProj.get();
+
+    for (int i = 0; i < PlaneCount; i++)
+    {
+        // row 3 +/- row 0 (left/right), row 1 (bottom/top), row 2 (near/far)
+        int row = i / 2;
+        float sign = (i % 2 == 0) ? 1.0f : -1.0f;
+
+        float a = m[3]  + sign * m[row];
+        float b = m[7]  + sign * m[4 + row];
+        float c = m[11] + sign * m[8 + row];
+        float d = m[15] + sign * m[12 + row];
+
+        float invLength = 1.0f / sqrtf(a*a + b*b + c*c);
+        mPlanes[i].normal.set(a * invLength, b * invLength, c * invLength);
+        mPlanes[i].d = d * invLength;
+    }
+
+    // corners of the clip space cube in world space
+    Matrix4 inv = viewProj;
+    inv.invertGeneral();
+    for (int i = 0; i < 8; i++)
+    {
+        Vector4 p = inv * Vector4((i & 1) ? 1.0f : -1.0f,
+                                  (i & 2) ? 1.0f : -1.0f,
+                                  (i & 4) ? 1.0f : -1.0f, 1.0f);
+        mCorners[i].set(p.x / p.w, p.y / p.w, p.z / p.w);
+    }
+    mHasCorners = true;
+}
+
+
+
+bool Frustum::containsCorners(const Plane& plane) const
+{
+    for (int i = 0; i < 8; i++)
+    {
+        // tolerance for the rounding of the corners, which grows with distance
+        float tolerance = 1e-4f * (1.0f + mCorners[i].length());
+        if (plane.distance(mCorners[i]) < -tolerance)
+            return false;
+    }
+    return true;
+}
+
+
+
+Frustum Frustum::Combine(const Frustum& a, const Frustum& b)
+{
+    Frustum r;
+    if (!a.mHasCorners || !b.mHasCorners)
+        return r;
+
+    for (int i = 0; i < PlaneCount; i++)
+    {
+        if (b.containsCorners(a.mPlanes[i]))
+            r.mPlanes[i] = a.mPlanes[i];
+        else if (a.containsCorners(b.mPlanes[i]))
+            r.mPlanes[i] = b.mPlanes[i];
+        else
+            r.mPlanes[i].d = OPEN_PLANE_D;
+    }
+
+    // the union is not a frustum, keep it from being combined again
+    return r;
+}
+
+
+
+Frustum::Frustum()
+{
+    for (int i = 0; i < PlaneCount; i++)
+        mPlanes[i].d = OPEN_PLANE_D;
+}
+
+
+
+// -------------------------------------------------------------------------- //
+//  single tests
+// -------------------------------------------------------------------------- //
+bool Frustum::contains(const Vector3& p) const
+{
+    for (int i = 0; i < PlaneCount; i++)
+        if (mPlanes[i].distance(p) < 0.0f)
+            return false;
+    return true;
+}
+
+bool Frustum::intersects(const BoundingBox& box) const
+{
+    Vector3 c = (box.min + box.max) * 0.5f;
+    Vector3 e = (box.max - box.min) * 0.5f;
+    for (int i = 0; i < PlaneCount; i++)
+    {
+        const Plane& p = mPlanes[i];
+        float dist = p.normal.x*c.x + p.normal.y*c.y + p.normal.z*c.z + p.d;
+        float radius = fabsf(p.normal.x)*e.x + fabsf(p.normal.y)*e.y + fabsf(p.normal.z)*e.z;
+        if (dist + radius < 0.0f)
+            return false;
+    }
+    return true;
+}
+
+bool Frustum::intersects(const BoundingSphere& sphere) const
+{
+    for (int i = 0; i < PlaneCount; i++)
+        if (mPlanes[i].distance(sphere.center) + sphere.radius < 0.0f)
+            return false;
+    return true;
+}
+
+
+
+// -------------------------------------------------------------------------- //
+//  batched tests
+// -------------------------------------------------------------------------- //
+#if defined(YUP_SIMD_SSE2)
+// 4 items against all planes, returns a 4 bit mask of the visible ones
+static inline int Visible4(const Plane* planes, __m128 cx, __m128 cy, __m128 cz,
+                           __m128 ex, __m128 ey, __m128 ez, __m128 r, bool isBox)
+{
+    const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+    const __m128 zero = _mm_setzero_ps();
+    __m128 outside = zero;
+
+    for (int i = 0; i < Frustum::PlaneCount; i++)
+    {
+        const Plane& p = planes[i];
+        const __m128 nx = _mm_set1_ps(p.normal.x), ny = _mm_set1_ps(p.normal.y), nz = _mm_set1_ps(p.normal.z);
+
+        __m128 dist = _mm_mul_ps(nx, cx);
+        dist = _mm_add_ps(dist, _mm_mul_ps(ny, cy));
+        dist = _mm_add_ps(dist, _mm_mul_ps(nz, cz));
+        dist = _mm_add_ps(dist, _mm_set1_ps(p.d));
+
+        if (isBox)
+        {
+            r = _mm_mul_ps(_mm_and_ps(nx, absMask), ex);
+            r = _mm_add_ps(r, _mm_mul_ps(_mm_and_ps(ny, absMask), ey));
+            r = _mm_add_ps(r, _mm_mul_ps(_mm_and_ps(nz, absMask), ez));
+        }
+
+        outside = _mm_or_ps(outside, _mm_cmplt_ps(_mm_add_ps(dist, r), zero));
+    }
+
+    return ~_mm_movemask_ps(outside) & 0xF;
+}
+
+static inline size_t AppendVisible(int mask, size_t base, uint32_t* visible, size_t count)
+{
+    for (int k = 0; k < 4; k++)
+        if (mask & (1 << k))
+            visible[count++] = (uint32_t)(base + k);
+    return count;
+}
+#endif
+
+
+
+size_t Frustum::cull(const BoundingBox* boxes, size_t n, uint32_t* visible) const
+{
+    size_t count = 0;
+    size_t i = 0;
+
+#if defined(YUP_SIMD_SSE2)
+    const __m128 half = _mm_set1_ps(0.5f);
+    for (; i + 4 <= n; i += 4)
+    {
+        // (min.x, min.y, min.z, max.x) and (min.z, max.x, max.y, max.z) of each box
+        __m128 a0 = _mm_loadu_ps(&boxes[i].min.x),     b0 = _mm_loadu_ps(&boxes[i].min.z);
+        __m128 a1 = _mm_loadu_ps(&boxes[i + 1].min.x), b1 = _mm_loadu_ps(&boxes[i + 1].min.z);
+        __m128 a2 = _mm_loadu_ps(&boxes[i + 2].min.x), b2 = _mm_loadu_ps(&boxes[i + 2].min.z);
+        __m128 a3 = _mm_loadu_ps(&boxes[i + 3].min.x), b3 = _mm_loadu_ps(&boxes[i + 3].min.z);
+        _MM_TRANSPOSE4_PS(a0, a1, a2, a3);              // minX, minY, minZ, maxX
+        _MM_TRANSPOSE4_PS(b0, b1, b2, b3);              // minZ, maxX, maxY, maxZ
+
+        __m128 cx = _mm_mul_ps(_mm_add_ps(a0, a3), half), ex = _mm_mul_ps(_mm_sub_ps(a3, a0), half);
+        __m128 cy = _mm_mul_ps(_mm_add_ps(a1, b2), half), ey = _mm_mul_ps(_mm_sub_ps(b2, a1), half);
+        __m128 cz = _mm_mul_ps(_mm_add_ps(a2, b3), half), ez = _mm_mul_ps(_mm_sub_ps(b3, a2), half);
+
+        int mask = Visible4(mPlanes, cx, cy, cz, ex, ey, ez, _mm_setzero_ps(), true);
+        count = AppendVisible(mask, i, visible, count);
+    }
+#endif
+
+    for (; i < n; ++i)
+        if (intersects(boxes[i]))
+            visible[count++] = (uint32_t)i;
+
+    return count;
+}
+
+
+
+size_t Frustum::cull(const BoundingSphere* spheres, size_t n, uint32_t* visible) const
+{
+    size_t count = 0;
+    size_t i = 0;
+
+#if defined(YUP_SIMD_SSE2)
+    const __m128 zero = _mm_setzero_ps();
+    for (; i + 4 <= n; i += 4)
+    {
+        // a sphere is 4 floats, a transpose gives x, y, z and radius of 4 spheres
+        __m128 s0 = _mm_loadu_ps(&spheres[i].center.x);
+        __m128 s1 = _mm_loadu_ps(&spheres[i + 1].center.x);
+        __m128 s2 = _mm_loadu_ps(&spheres[i + 2].center.x);
+        __m128 s3 = _mm_loadu_ps(&spheres[i + 3].center.x);
+        _MM_TRANSPOSE4_PS(s0, s1, s2, s3);
+
+        int mask = Visible4(mPlanes, s0, s1, s2, zero, zero, zero, s3, false);
+        count = AppendVisible(mask, i, visible, count);
+    }
+#endif
+
+    for (; i < n; ++i)
+        if (intersects(spheres[i]))
+            visible[count++] = (uint32_t)i;
+
+    return count;
+}
+
+END_NAMESPACE_YUP
@@ -0,0 +1,105 @@
+// ========================================================================== //
+//
+//  Frustum.h
+//  ---
+//  View frustum extracted from a view-projection matrix, and visibility
+//  tests of bounding boxes and spheres against it
+//
+//  A point p is inside a plane when dot(normal, p) + d >= 0. The planes are
+//  normalized, so the value is the signed distance in world units.
+//
+//  Created: 2016-08-24
+//  Updated: 2016-08-24
+//
+//  (C) 2016 Yu-hsien Chang
+//
+// ========================================================================== //
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "yup.h"
+#include "Vectors.h"
+#include "Matrices.h"
+
+BEGIN_NAMESPACE_YUP
+
+struct Plane
+{
+    Vector3 normal;
+    float d = 0.0f;
+
+    float distance(const Vector3& p) const { return normal.x*p.x + normal.y*p.y + normal.z*p.z + d; }
+};
+
+// axis aligned box, empty when min > max
+struct BoundingBox
+{
+    Vector3 min;
+    Vector3 max;
+
+    BoundingBox() : min(1e30f, 1e30f, 1e30f), max(-1e30f, -1e30f, -1e30f) {}
+    BoundingBox(const Vector3& min, const Vector3& max) : min(min), max(max) {}
+
+    bool isEmpty() const { return min.x > max.x || min.y > max.y || min.z > max.z; }
+    void clear() { *this = BoundingBox(); }
+
+    void add(float x, float y, float z)
+    {
+        min.set(x < min.x ? x : min.x, y < min.y ? y : min.y, z < min.z ? z : min.z);
+        max.set(x > max.x ? x : max.x, y > max.y ? y : max.y, z > max.z ? z : max.z);
+    }
+    void add(const Vector3& p) { add(p.x, p.y, p.z); }
+};
+
+struct BoundingSphere
+{
+    Vector3 center;
+    float radius = 0.0f;
+
+    BoundingSphere() {}
+    BoundingSphere(const Vector3& center, float radius) : center(center), radius(radius) {}
+};
+
+
+
+class Frustum
+{
+public:
+    enum { Left, Right, Bottom, Top, Near, Far, PlaneCount };
+
+private:
+    Plane mPlanes[PlaneCount];
+    Vector3 mCorners[8];
+    bool mHasCorners = false;                           // false if it contains everything
+
+public:
+    Frustum();                                          // contains everything
+    explicit Frustum(const Matrix4& viewProj) { set(viewProj); }
+
+    // extract the planes of an OpenGL view-projection matrix (clip z in [-w, w])
+    void set(const Matrix4& viewProj);
+
+    // One frustum containing both a and b, e.g. the two eyes of an HMD.
+    // Each side takes the plane of a or b that contains the other frustum,
+    // or is left open if neither does, so the test stays conservative.
+    static Frustum Combine(const Frustum& a, const Frustum& b);
+
+    const Plane& getPlane(int index) const { return mPlanes[index]; }
+
+    bool contains(const Vector3& p) const;
+    bool intersects(const BoundingBox& box) const;
+    bool intersects(const BoundingSphere& sphere) const;
+
+    // Batched tests, write the indices of the visible items to visible and
+    // return how many there are. visible must hold n entries.
+    size_t cull(const BoundingBox* boxes, size_t n, uint32_t* visible) const;
+    size_t cull(const BoundingSphere* spheres, size_t n, uint32_t* visible) const;
+
+private:
+    bool containsCorners(const Plane& plane) const;     // all corners inside the plane
+};
+
+END_NAMESPACE_YUP
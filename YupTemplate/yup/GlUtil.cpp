@@ -17,6 +17,7 @@
 #include "Log.h"
 
 #include <stdio.h>
+#include <vector>
 
 BEGIN_NAMESPACE_YUP_GL
 
@@ -166,6 +167,127 @@ void UpdateTexture(GLuint texId, int width, int height, GLenum format, GLenum ty
 	glBindTexture(GL_TEXTURE_2D, 0);
 }
 
+// * Update an OpenGL texture straight from a view, the rows are read in place
+void UpdateTexture(GLuint texId, const FrameView &view, GLenum format, GLenum type)
+{
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+	glBindTexture(GL_TEXTURE_2D, texId);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+
+	if (view.stride() % view.colorDepth() == 0)
+	{
+		// the row length is in pixels, 1 byte alignment as rows of 3 byte
+		// pixels need not start on 4 bytes
+		glPixelStorei(GL_UNPACK_ROW_LENGTH, view.stride() / view.colorDepth());
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+		glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, view.width(), view.height(), format, type, view.data());
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	}
+	else
+	{
+		// a stride GL cannot express, one row at a time
+		glPixelStorei(GL_UNPACK_ROW_LENGTH, view.width());
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+		for (int y = 0; y < view.height(); y++)
+			glTexSubImage2D(GL_TEXTURE_2D, 0, 0, y, view.width(), 1, format, type, view.row(y));
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	}
+
+	glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+// * Update the changed parts of an OpenGL texture from a FrameBuffer
+void UploadDirtyRegion(GLuint texId, FrameBuffer &buffer, GLenum format)
+{
+	const DirtyRegion &dirty = buffer.dirtyRegion();
+	if (dirty.empty())
+		return;
+
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+	glBindTexture(GL_TEXTURE_2D, texId);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+	glPixelStorei(GL_UNPACK_ROW_LENGTH, buffer.width());
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+	const uint8_t *data = buffer.cst_data();
+	for (const DirtyRect &rect : dirty.rects())
+	{
+		const uint8_t *pixels = data + ((size_t)rect.y * buffer.width() + rect.x) * buffer.colorDepth();
+		glTexSubImage2D(GL_TEXTURE_2D, 0, rect.x, rect.y, rect.width, rect.height, format, GL_UNSIGNED_BYTE, pixels);
+	}
+
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	buffer.clearDirty();
+}
+
+// * Upload a mip pyramid to an OpenGL texture with one buffer copy
+bool UploadMipPyramid(GLuint texId, GLuint bufferId, const MipPyramid &pyramid, GLint internalformat, GLenum format)
+{
+	const int levels = pyramid.levelCount();
+	if (levels == 0)
+		return false;
+
+	// orphan the old storage so the driver does not wait for its last use
+	const size_t total = pyramid.totalBytes();
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, bufferId);
+	glBufferData(GL_PIXEL_UNPACK_BUFFER, total, NULL, GL_STREAM_DRAW);
+
+	uint8_t *mapped = (uint8_t *)glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, total, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+	if (!mapped)
+	{
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		GlDumpError("UploadMipPyramid: glMapBufferRange()");
+		return false;
+	}
+
+	// the levels packed one after the other
+	std::vector<size_t> offsets(levels);
+	size_t offset = 0;
+	for (int i = 0; i < levels; i++)
+	{
+		FrameView level = pyramid.level(i);
+		offsets[i] = offset;
+		for (int y = 0; y < level.height(); y++, offset += level.pitch())
+			memcpy(mapped + offset, level.row(y), level.pitch());
+	}
+
+	glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+
+	glBindTexture(GL_TEXTURE_2D, texId);
+	glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+	// levels that already have storage of the right size are only updated,
+	// the others (re)allocated
+	for (int i = 0; i < levels; i++)
+	{
+		FrameView level = pyramid.level(i);
+
+		GLint width = 0, height = 0;
+		glGetTexLevelParameteriv(GL_TEXTURE_2D, i, GL_TEXTURE_WIDTH, &width);
+		glGetTexLevelParameteriv(GL_TEXTURE_2D, i, GL_TEXTURE_HEIGHT, &height);
+
+		if (width == level.width() && height == level.height())
+			glTexSubImage2D(GL_TEXTURE_2D, i, 0, 0, level.width(), level.height(), format, GL_UNSIGNED_BYTE, (const void *)offsets[i]);
+		else
+			glTexImage2D(GL_TEXTURE_2D, i, internalformat, level.width(), level.height(), 0, format, GL_UNSIGNED_BYTE, (const void *)offsets[i]);
+	}
+
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levels - 1);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+
+	glBindTexture(GL_TEXTURE_2D, 0);
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+	return GlDumpError("UploadMipPyramid");
+}
+
 
 bool GlDumpError(const std::string &msg)
 {
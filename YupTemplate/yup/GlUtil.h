@@ -19,6 +19,9 @@
 
 #include "yup.h"
 #include "inc_sdl.h"
+#include "Downsample.h"
+#include "FrameBuffer.h"
+#include "FrameView.h"
 
 BEGIN_NAMESPACE_YUP_GL
 
@@ -27,8 +30,24 @@ GLuint CompileGLShader(const char *pchShaderName, const char *pchVertexShader, c
 // OpenGL utility functions
 bool GenTexture(GLuint *texId, GLsizei width, GLsizei height, GLint internalformat, GLenum format, GLenum type, const void *pixels = NULL);
 bool GenBuffer(GLuint &bufferID, size_t size);
+
+// The updates write level 0 only and set GL_TEXTURE_MAX_LEVEL back to 0, as
+// the other levels would be stale. Upload the pyramid again with
+// UploadMipPyramid() after them to sample mipmaps.
 void UpdateTexture(GLuint texId, int width, int height, GLenum format, GLenum type, GLuint bufferId);
 void UpdateTexture(GLuint texId, int width, int height, GLenum format, GLenum type, const void *pixels = NULL);
+void UpdateTexture(GLuint texId, const FrameView &view, GLenum format, GLenum type = GL_UNSIGNED_BYTE);
+
+// Upload only the dirty rectangles of buffer to level 0 of a texture of its
+// size and clear them, 1 byte channels. Like the updates above it sets
+// GL_TEXTURE_MAX_LEVEL to 0.
+void UploadDirtyRegion(GLuint texId, FrameBuffer &buffer, GLenum format);
+
+// Upload all levels of pyramid to a texture through the pixel buffer
+// bufferId, which is resized to fit, and turn on trilinear filtering.
+// Levels are allocated on the first upload and when their size changes,
+// then only updated; the internalformat of existing levels is kept.
+bool UploadMipPyramid(GLuint texId, GLuint bufferId, const MipPyramid &pyramid, GLint internalformat, GLenum format);
 
 bool GlDumpError(const std::string &msg);
 
@@ -0,0 +1,221 @@
+// ========================================================================== //
+//
+//  Half.cpp
+//  ---
+//  Based on the conversions of Fabian Giesen (public domain). The SSE2 code
+//  does the same integer/float steps as the scalar code on 4 lanes, F16C
+//  does it in hardware with the same rounding.
+//
+//  Created: 2016-08-24
+//  Updated: 2016-08-24
+//
+//  (C) 2016 Yu-hsien Chang
+//
+// ========================================================================== //
+
+#include <cstring>
+
+#include "Half.h"
+#include "Simd.h"
+
+BEGIN_NAMESPACE_YUP
+
+static inline uint32_t FloatBits(float f)
+{
+    uint32_t u;
+    memcpy(&u, &f, sizeof(u));
+    return u;
+}
+
+static inline float BitsFloat(uint32_t u)
+{
+    float f;
+    memcpy(&f, &u, sizeof(f));
+    return f;
+}
+
+
+
+// -------------------------------------------------------------------------- //
+//  scalar, also used for the remainder of the SIMD loops
+// -------------------------------------------------------------------------- //
+uint16_t FloatToHalfBits(float f)
+{
+    const uint32_t f32Infinity = 255u << 23;
+    const uint32_t f16Max = (127u + 16) << 23;                  // rounds to infinity from here
+    const uint32_t minNormal = (127u - 14) << 23;               // smallest float giving a normal half
+    const uint32_t subnormalMagic = ((127u - 15) + (23 - 10) + 1) << 23;
+
+    uint32_t u = FloatBits(f);
+    uint32_t sign = u & 0x80000000u;
+    u ^= sign;
+
+    uint32_t h;
+    if (u >= f16Max)
+    {
+        // infinity, or a quiet NaN with the top of the payload
+        h = (u > f32Infinity) ? (0x7e00 | ((u >> 13) & 0x3ff)) : 0x7c00;
+    }
+    else if (u < minNormal)
+    {
+        // the float add aligns and rounds the mantissa of a subnormal half
+        h = FloatBits(BitsFloat(u) + BitsFloat(subnormalMagic)) - subnormalMagic;
+    }
+    else
+    {
+        // rebias the exponent and round to nearest even
+        uint32_t mantissaOdd = (u >> 13) & 1;
+        u += ((15u - 127) << 23) + 0xfff + mantissaOdd;
+        h = u >> 13;
+    }
+
+    return (uint16_t)(h | (sign >> 16));
+}
+
+
+
+float HalfBitsToFloat(uint16_t h)
+{
+    const uint32_t shiftedExponent = 0x7c00u << 13;
+    const float subnormalMagic = BitsFloat(113u << 23);
+
+    uint32_t u = (uint32_t)(h & 0x7fff) << 13;
+    uint32_t exponent = u & shiftedExponent;
+    u += (127u - 15) << 23;
+
+    if (exponent == shiftedExponent)
+    {
+        // infinity or NaN, NaNs come out quiet
+        u += (128u - 16) << 23;
+        if (u & 0x007fffff)
+            u |= 0x00400000;
+    }
+    else if (exponent == 0)
+    {
+        // zero or subnormal, renormalized by the float subtract
+        u = FloatBits(BitsFloat(u + (1u << 23)) - subnormalMagic);
+    }
+
+    return BitsFloat(u | ((uint32_t)(h & 0x8000) << 16));
+}
+
+
+
+// -------------------------------------------------------------------------- //
+//  4 lanes of FloatToHalfBits() and HalfBitsToFloat()
+// -------------------------------------------------------------------------- //
+#if defined(YUP_SIMD_SSE2) && !defined(YUP_SIMD_F16C)
+// the halfs are in the low 16 bits of each lane, sign extended
+static inline __m128i FloatToHalf4(__m128 f)
+{
+    const __m128i f16Max = _mm_set1_epi32((127 + 16) << 23);
+    const __m128i minNormal = _mm_set1_epi32((127 - 14) << 23);
+    const __m128i subnormalMagic = _mm_set1_epi32(((127 - 15) + (23 - 10) + 1) << 23);
+    const __m128i normalBias = _mm_set1_epi32((int)(0xfffu + ((15u - 127) << 23)));
+
+    __m128 sign = _mm_and_ps(f, _mm_castsi128_ps(_mm_set1_epi32((int)0x80000000u)));
+    __m128i u = _mm_castps_si128(_mm_xor_ps(f, sign));
+
+    // infinity or NaN
+    __m128i isNaN = _mm_castps_si128(_mm_cmpunord_ps(f, f));
+    __m128i payload = _mm_or_si128(_mm_set1_epi32(0x200), _mm_and_si128(_mm_srli_epi32(u, 13), _mm_set1_epi32(0x3ff)));
+    __m128i special = _mm_or_si128(_mm_set1_epi32(0x7c00), _mm_and_si128(isNaN, payload));
+
+    // subnormal
+    __m128i subnormal = _mm_sub_epi32(_mm_castps_si128(_mm_add_ps(_mm_castsi128_ps(u), _mm_castsi128_ps(subnormalMagic))), subnormalMagic);
+
+    // normal, -1 in lanes where the half mantissa is odd
+    __m128i mantissaOdd = _mm_srai_epi32(_mm_slli_epi32(u, 31 - 13), 31);
+    __m128i normal = _mm_srli_epi32(_mm_sub_epi32(_mm_add_epi32(u, normalBias), mantissaOdd), 13);
+
+    __m128i isSubnormal = _mm_cmpgt_epi32(minNormal, u);
+    __m128i isRegular = _mm_cmpgt_epi32(f16Max, u);
+    __m128i h = _mm_or_si128(_mm_and_si128(isSubnormal, subnormal), _mm_andnot_si128(isSubnormal, normal));
+    h = _mm_or_si128(_mm_and_si128(isRegular, h), _mm_andnot_si128(isRegular, special));
+
+    return _mm_or_si128(h, _mm_srai_epi32(_mm_castps_si128(sign), 16));
+}
+
+// the halfs are in the low 16 bits of each lane, zero extended
+static inline __m128 HalfToFloat4(__m128i h)
+{
+    const __m128i shiftedExponent = _mm_set1_epi32(0x7c00 << 13);
+    const __m128i bias = _mm_set1_epi32((127 - 15) << 23);
+    const __m128 subnormalMagic = _mm_castsi128_ps(_mm_set1_epi32(113 << 23));
+
+    __m128i u = _mm_slli_epi32(_mm_and_si128(h, _mm_set1_epi32(0x7fff)), 13);
+    __m128i exponent = _mm_and_si128(u, shiftedExponent);
+    u = _mm_add_epi32(u, bias);
+
+    // infinity or NaN, NaNs come out quiet
+    __m128i isSpecial = _mm_cmpeq_epi32(exponent, shiftedExponent);
+    __m128i isNaN = _mm_andnot_si128(_mm_cmpeq_epi32(_mm_and_si128(u, _mm_set1_epi32(0x007fffff)), _mm_setzero_si128()), isSpecial);
+    __m128i special = _mm_or_si128(_mm_add_epi32(u, _mm_set1_epi32((128 - 16) << 23)), _mm_and_si128(isNaN, _mm_set1_epi32(0x00400000)));
+
+    // zero or subnormal
+    __m128i isSubnormal = _mm_cmpeq_epi32(exponent, _mm_setzero_si128());
+    __m128i subnormal = _mm_castps_si128(_mm_sub_ps(_mm_castsi128_ps(_mm_add_epi32(u, _mm_set1_epi32(1 << 23))), subnormalMagic));
+
+    u = _mm_or_si128(_mm_andnot_si128(isSpecial, u), _mm_and_si128(isSpecial, special));
+    u = _mm_or_si128(_mm_andnot_si128(isSubnormal, u), _mm_and_si128(isSubnormal, subnormal));
+
+    __m128i sign = _mm_slli_epi32(_mm_and_si128(h, _mm_set1_epi32(0x8000)), 16);
+    return _mm_castsi128_ps(_mm_or_si128(u, sign));
+}
+#endif
+
+
+
+// -------------------------------------------------------------------------- //
+//  arrays
+// -------------------------------------------------------------------------- //
+void ConvertFloatToHalf(const float* in, Half* out, size_t n)
+{
+    size_t i = 0;
+
+#if defined(YUP_SIMD_F16C)
+    for (; i + 8 <= n; i += 8)
+    {
+        __m128i h = _mm256_cvtps_ph(_mm256_loadu_ps(in + i), _MM_FROUND_TO_NEAREST_INT);
+        _mm_storeu_si128((__m128i *)(out + i), h);
+    }
+#elif defined(YUP_SIMD_SSE2)
+    for (; i + 8 <= n; i += 8)
+    {
+        // the lanes are sign extended, so the signed saturation keeps them
+        __m128i lo = FloatToHalf4(_mm_loadu_ps(in + i));
+        __m128i hi = FloatToHalf4(_mm_loadu_ps(in + i + 4));
+        _mm_storeu_si128((__m128i *)(out + i), _mm_packs_epi32(lo, hi));
+    }
+#endif
+
+    for (; i < n; ++i)
+        out[i].bits = FloatToHalfBits(in[i]);
+}
+
+
+
+void ConvertHalfToFloat(const Half* in, float* out, size_t n)
+{
+    size_t i = 0;
+
+#if defined(YUP_SIMD_F16C)
+    for (; i + 8 <= n; i += 8)
+    {
+        __m128i h = _mm_loadu_si128((const __m128i *)(in + i));
+        _mm256_storeu_ps(out + i, _mm256_cvtph_ps(h));
+    }
+#elif defined(YUP_SIMD_SSE2)
+    for (; i + 8 <= n; i += 8)
+    {
+        __m128i h = _mm_loadu_si128((const __m128i *)(in + i));
+        _mm_storeu_ps(out + i,     HalfToFloat4(_mm_unpacklo_epi16(h, _mm_setzero_si128())));
+        _mm_storeu_ps(out + i + 4, HalfToFloat4(_mm_unpackhi_epi16(h, _mm_setzero_si128())));
+    }
+#endif
+
+    for (; i < n; ++i)
+        out[i] = HalfBitsToFloat(in[i].bits);
+}
+
+END_NAMESPACE_YUP
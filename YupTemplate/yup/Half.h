@@ -0,0 +1,68 @@
+// ========================================================================== //
+//
+//  Half.h
+//  ---
+//  IEEE 754 half precision (binary16) for storage
+//
+//  Half has no arithmetic, large datasets are stored as Half and converted
+//  to float for the math. The array conversions round to nearest even and
+//  give the same bits on every code path (F16C, SSE2 and scalar), NaNs keep
+//  the top bits of their payload like F16C does.
+//
+//  Created: 2016-08-24
+//  Updated: 2016-08-24
+//
+//  (C) 2016 Yu-hsien Chang
+//
+// ========================================================================== //
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "yup.h"
+#include "Vectors.h"
+
+BEGIN_NAMESPACE_YUP
+
+uint16_t FloatToHalfBits(float f);                      // round to nearest even
+float HalfBitsToFloat(uint16_t h);                      // exact
+
+struct Half
+{
+    uint16_t bits;
+
+    Half() : bits(0) {};
+    explicit Half(float f) : bits(FloatToHalfBits(f)) {};
+
+    explicit operator float() const                     { return HalfBitsToFloat(bits); }
+
+    static Half FromBits(uint16_t bits)                 { Half h; h.bits = bits; return h; }
+};
+
+// Storage only, convert with e.g. Vector3(v) and Vector3h(v)
+typedef Vector2T<Half>      Vector2h;
+typedef Vector3T<Half>      Vector3h;
+typedef Vector4T<Half>      Vector4h;
+
+static_assert(sizeof(Vector3h) == 6, "Vector3h must be 3 packed halfs");
+
+
+
+// n values, in and out must not overlap
+void ConvertFloatToHalf(const float* in, Half* out, size_t n);
+void ConvertHalfToFloat(const Half* in, float* out, size_t n);
+
+// Vector3 arrays are laid out as AoS
+inline void ConvertFloatToHalf(const Vector3* in, Vector3h* out, size_t n)
+{
+    ConvertFloatToHalf(&in->x, &out->x, n * 3);
+}
+
+inline void ConvertHalfToFloat(const Vector3h* in, Vector3* out, size_t n)
+{
+    ConvertHalfToFloat(&in->x, &out->x, n * 3);
+}
+
+END_NAMESPACE_YUP
@@ -26,26 +26,11 @@ const float DEG2RAD = 3.141593f / 180.0f;
 const float RAD2DEG = 180.0f / 3.141593f;
 const float EPSILON = 0.00001f;
 
-
-
-// -------------------------------------------------------------------------- //
-//  transpose 2x2 matrix
-// -------------------------------------------------------------------------- //
-Matrix2& Matrix2::transpose()
-{
-    std::swap(m[1],  m[2]);
-    return *this;
-}
-
-
-
-// -------------------------------------------------------------------------- //
-//  return the determinant of 2x2 matrix
-// -------------------------------------------------------------------------- //
-float Matrix2::getDeterminant() const
-{
-    return m[0] * m[3] - m[1] * m[2];
-}
+// float keeps the constants above, so its results do not change
+template <typename T> inline T Deg2Rad()            { return (T)(M_PI / 180.0); }
+template <typename T> inline T Rad2Deg()            { return (T)(180.0 / M_PI); }
+template <> inline float Deg2Rad<float>()           { return DEG2RAD; }
+template <> inline float Rad2Deg<float>()           { return RAD2DEG; }
 
 
 
@@ -53,16 +38,17 @@ float Matrix2::getDeterminant() const
 //  inverse of 2x2 matrix
 //  If cannot find inverse, set identity matrix
 // -------------------------------------------------------------------------- //
-Matrix2& Matrix2::invert()
+template <typename T>
+Matrix2T<T>& Matrix2T<T>::invert()
 {
-    float determinant = getDeterminant();
-    if(fabs(determinant) <= EPSILON)
+    T determinant = getDeterminant();
+    if(std::fabs(determinant) <= EPSILON)
     {
         return identity();
     }
 
-    float tmp = m[0];   // copy the first element
-    float invDeterminant = 1.0f / determinant;
+    T tmp = m[0];   // copy the first element
+    T invDeterminant = 1.0f / determinant;
     m[0] =  invDeterminant * m[3];
     m[1] = -invDeterminant * m[1];
     m[2] = -invDeterminant * m[2];
@@ -79,10 +65,11 @@ Matrix2& Matrix2::invert()
 //      | s  c |
 //  angle = atan(s / c)
 // -------------------------------------------------------------------------- //
-float Matrix2::getAngle() const
+template <typename T>
+T Matrix2T<T>::getAngle() const
 {
     // angle between -pi ~ +pi (-180 ~ +180)
-    return RAD2DEG * atan2f(m[1], m[0]);
+    return Rad2Deg<T>() * std::atan2(m[1], m[0]);
 }
 
 //=============================================================================
@@ -92,40 +79,15 @@ float Matrix2::getAngle() const
 
 
 
-// -------------------------------------------------------------------------- //
-//  transpose 3x3 matrix
-// -------------------------------------------------------------------------- //
-Matrix3& Matrix3::transpose()
-{
-    std::swap(m[1],  m[3]);
-    std::swap(m[2],  m[6]);
-    std::swap(m[5],  m[7]);
-
-    return *this;
-}
-
-
-
-// -------------------------------------------------------------------------- //
-//  return determinant of 3x3 matrix
-// -------------------------------------------------------------------------- //
-float Matrix3::getDeterminant() const
-{
-    return m[0] * (m[4] * m[8] - m[5] * m[7]) -
-           m[1] * (m[3] * m[8] - m[5] * m[6]) +
-           m[2] * (m[3] * m[7] - m[4] * m[6]);
-}
-
-
-
 // -------------------------------------------------------------------------- //
 //  inverse 3x3 matrix
 //  If cannot find inverse, set identity matrix
 // -------------------------------------------------------------------------- //
-Matrix3& Matrix3::invert()
+template <typename T>
+Matrix3T<T>& Matrix3T<T>::invert()
 {
-    float determinant, invDeterminant;
-    float tmp[9];
+    T determinant, invDeterminant;
+    T tmp[9];
 
     tmp[0] = m[4] * m[8] - m[5] * m[7];
     tmp[1] = m[2] * m[7] - m[1] * m[8];
@@ -139,7 +101,7 @@ Matrix3& Matrix3::invert()
 
     // check determinant if it is 0
     determinant = m[0] * tmp[0] + m[1] * tmp[3] + m[2] * tmp[6];
-    if(fabs(determinant) <= EPSILON)
+    if(std::fabs(determinant) <= EPSILON)
     {
         return identity(); // cannot inverse, make it idenety matrix
     }
@@ -175,14 +137,15 @@ Matrix3& Matrix3::invert()
 //  Yaw  : asin(m[6]) = asin(Sy)
 //  Roll : atan(-m[3] / m[0]) = atan(SzCy/CzCy)
 // -------------------------------------------------------------------------- //
-Vector3 Matrix3::getAngle() const
+template <typename T>
+Vector3T<T> Matrix3T<T>::getAngle() const
 {
-    float pitch, yaw, roll;         // 3 angles
+    T pitch, yaw, roll;         // 3 angles
 
     // find yaw (around y-axis) first
     // NOTE: asin() returns -90~+90, so correct the angle range -180~+180
     // using z value of forward vector
-    yaw = RAD2DEG * asinf(m[6]);
+    yaw = Rad2Deg<T>() * std::asin(m[6]);
     if(m[8] < 0)
     {
         if(yaw >= 0) yaw = 180.0f - yaw;
@@ -194,15 +157,15 @@ Vector3 Matrix3::getAngle() const
     if(m[0] > -EPSILON && m[0] < EPSILON)
     {
         roll  = 0;  //@@ assume roll=0
-        pitch = RAD2DEG * atan2f(m[1], m[4]);
+        pitch = Rad2Deg<T>() * std::atan2(m[1], m[4]);
     }
     else
     {
-        roll = RAD2DEG * atan2f(-m[3], m[0]);
-        pitch = RAD2DEG * atan2f(-m[7], m[8]);
+        roll = Rad2Deg<T>() * std::atan2(-m[3], m[0]);
+        pitch = Rad2Deg<T>() * std::atan2(-m[7], m[8]);
     }
 
-    return Vector3(pitch, yaw, roll);
+    return Vector3T<T>(pitch, yaw, roll);
 }
 
 //=============================================================================
@@ -212,27 +175,11 @@ Vector3 Matrix3::getAngle() const
 
 
 
-// -------------------------------------------------------------------------- //
-//  transpose 4x4 matrix
-// -------------------------------------------------------------------------- //
-Matrix4& Matrix4::transpose()
-{
-    std::swap(m[1],  m[4]);
-    std::swap(m[2],  m[8]);
-    std::swap(m[3],  m[12]);
-    std::swap(m[6],  m[9]);
-    std::swap(m[7],  m[13]);
-    std::swap(m[11], m[14]);
-
-    return *this;
-}
-
-
-
 // -------------------------------------------------------------------------- //
 //  inverse 4x4 matrix
 // -------------------------------------------------------------------------- //
-Matrix4& Matrix4::invert()
+template <typename T>
+Matrix4T<T>& Matrix4T<T>::invert()
 {
     // If the 4th row is [0,0,0,1] then it is affine matrix and
     // it has no projective transformation.
@@ -242,7 +189,7 @@ Matrix4& Matrix4::invert()
     {
         this->invertGeneral();
         /*@@ invertProjective() is not optimized (slower than generic one)
-        if(fabs(m[0]*m[5] - m[1]*m[4]) > EPSILON)
+        if(std::fabs(m[0]*m[5] - m[1]*m[4]) > EPSILON)
             this->invertProjective();   // inverse using matrix partition
         else
             this->invertGeneral();      // generalized inverse
@@ -254,56 +201,6 @@ Matrix4& Matrix4::invert()
 
 
 
-// -------------------------------------------------------------------------- //
-//  compute the inverse of 4x4 Euclidean transformation matrix
-//
-//  Euclidean transformation is translation, rotation, and reflection.
-//  With Euclidean transform, only the position and orientation of the object
-//  will be changed. Euclidean transform does not change the shape of an object
-//  (no scaling). Length and angle are reserved.
-//
-//  Use inverseAffine() if the matrix has scale and shear transformation.
-//
-//  M = [ R | T ]
-//      [ --+-- ]    (R denotes 3x3 rotation/reflection matrix)
-//      [ 0 | 1 ]    (T denotes 1x3 translation matrix)
-//
-//  y = M*x  ->  y = R*x + T  ->  x = R^-1*(y - T)  ->  x = R^T*y - R^T*T
-//  (R is orthogonal,  R^-1 = R^T)
-//
-//   [ R | T ]-1    [ R^T | -R^T * T ]    (R denotes 3x3 rotation matrix)
-//   [ --+-- ]   =  [ ----+--------- ]    (T denotes 1x3 translation)
-//   [ 0 | 1 ]      [  0  |     1    ]    (R^T denotes R-transpose)
-// -------------------------------------------------------------------------- //
-Matrix4& Matrix4::invertEuclidean()
-{
-    // transpose 3x3 rotation matrix part
-    // | R^T | 0 |
-    // | ----+-- |
-    // |  0  | 1 |
-    float tmp;
-    tmp = m[1];  m[1] = m[4];  m[4] = tmp;
-    tmp = m[2];  m[2] = m[8];  m[8] = tmp;
-    tmp = m[6];  m[6] = m[9];  m[9] = tmp;
-
-    // compute translation part -R^T * T
-    // | 0 | -R^T x |
-    // | --+------- |
-    // | 0 |   0    |
-    float x = m[12];
-    float y = m[13];
-    float z = m[14];
-    m[12] = -(m[0] * x + m[4] * y + m[8] * z);
-    m[13] = -(m[1] * x + m[5] * y + m[9] * z);
-    m[14] = -(m[2] * x + m[6] * y + m[10]* z);
-
-    // last row should be unchanged (0,0,0,1)
-
-    return *this;
-}
-
-
-
 // -------------------------------------------------------------------------- //
 //  compute the inverse of a 4x4 affine transformation matrix
 //
@@ -320,19 +217,20 @@ Matrix4& Matrix4::invertEuclidean()
 //   [ --+-- ]   = [ -----+---------- ]
 //   [ 0 | 1 ]     [  0   +     1     ]
 // -------------------------------------------------------------------------- //
-Matrix4& Matrix4::invertAffine()
+template <typename T>
+Matrix4T<T>& Matrix4T<T>::invertAffine()
 {
     // R^-1
-    Matrix3 r(m[0],m[1],m[2], m[4],m[5],m[6], m[8],m[9],m[10]);
+    Matrix3T<T> r(m[0],m[1],m[2], m[4],m[5],m[6], m[8],m[9],m[10]);
     r.invert();
     m[0] = r[0];  m[1] = r[1];  m[2] = r[2];
     m[4] = r[3];  m[5] = r[4];  m[6] = r[5];
     m[8] = r[6];  m[9] = r[7];  m[10]= r[8];
 
     // -R^-1 * T
-    float x = m[12];
-    float y = m[13];
-    float z = m[14];
+    T x = m[12];
+    T y = m[13];
+    T z = m[14];
     m[12] = -(r[0] * x + r[3] * y + r[6] * z);
     m[13] = -(r[1] * x + r[4] * y + r[7] * z);
     m[14] = -(r[2] * x + r[5] * y + r[8] * z);
@@ -364,43 +262,44 @@ Matrix4& Matrix4::invertAffine()
 //        The matrix is invertable even if det(A)=0, so must check det(A) before
 //        calling this function, and use invertGeneric() instead.
 // -------------------------------------------------------------------------- //
-Matrix4& Matrix4::invertProjective()
+template <typename T>
+Matrix4T<T>& Matrix4T<T>::invertProjective()
 {
     // partition
-    Matrix2 a(m[0], m[1], m[4], m[5]);
-    Matrix2 b(m[8], m[9], m[12], m[13]);
-    Matrix2 c(m[2], m[3], m[6], m[7]);
-    Matrix2 d(m[10], m[11], m[14], m[15]);
+    Matrix2T<T> a(m[0], m[1], m[4], m[5]);
+    Matrix2T<T> b(m[8], m[9], m[12], m[13]);
+    Matrix2T<T> c(m[2], m[3], m[6], m[7]);
+    Matrix2T<T> d(m[10], m[11], m[14], m[15]);
 
     // pre-compute repeated parts
     a.invert();             // A^-1
-    Matrix2 ab = a * b;     // A^-1 * B
-    Matrix2 ca = c * a;     // C * A^-1
-    Matrix2 cab = ca * b;   // C * A^-1 * B
-    Matrix2 dcab = d - cab; // D - C * A^-1 * B
+    Matrix2T<T> ab = a * b;     // A^-1 * B
+    Matrix2T<T> ca = c * a;     // C * A^-1
+    Matrix2T<T> cab = ca * b;   // C * A^-1 * B
+    Matrix2T<T> dcab = d - cab; // D - C * A^-1 * B
 
     // check determinant if |D - C * A^-1 * B| = 0
     //NOTE: this function assumes det(A) is already checked. if |A|=0 then,
     //      cannot use this function.
-    float determinant = dcab[0] * dcab[3] - dcab[1] * dcab[2];
-    if(fabs(determinant) <= EPSILON)
+    T determinant = dcab[0] * dcab[3] - dcab[1] * dcab[2];
+    if(std::fabs(determinant) <= EPSILON)
     {
         return identity();
     }
 
     // compute D' and -D'
-    Matrix2 d1 = dcab;      //  (D - C * A^-1 * B)
+    Matrix2T<T> d1 = dcab;      //  (D - C * A^-1 * B)
     d1.invert();            //  (D - C * A^-1 * B)^-1
-    Matrix2 d2 = -d1;       // -(D - C * A^-1 * B)^-1
+    Matrix2T<T> d2 = -d1;       // -(D - C * A^-1 * B)^-1
 
     // compute C'
-    Matrix2 c1 = d2 * ca;   // -D' * (C * A^-1)
+    Matrix2T<T> c1 = d2 * ca;   // -D' * (C * A^-1)
 
     // compute B'
-    Matrix2 b1 = ab * d2;   // (A^-1 * B) * -D'
+    Matrix2T<T> b1 = ab * d2;   // (A^-1 * B) * -D'
 
     // compute A'
-    Matrix2 a1 = a - (ab * c1); // A^-1 - (A^-1 * B) * C'
+    Matrix2T<T> a1 = a - (ab * c1); // A^-1 - (A^-1 * B) * C'
 
     // assemble inverse matrix
     m[0] = a1[0];  m[4] = a1[2]; /*|*/ m[8] = b1[0];  m[12]= b1[2];
@@ -419,40 +318,94 @@ Matrix4& Matrix4::invertProjective()
 //  If cannot find inverse, return indentity matrix
 //  M^-1 = adj(M) / det(M)
 // -------------------------------------------------------------------------- //
-Matrix4& Matrix4::invertGeneral()
+template <typename T>
+Matrix4T<T>& Matrix4T<T>::invertGeneral()
 {
+#ifdef YUP_SIMD_SSE2
+    if constexpr (std::is_same<T, float>::value)
+    {
+        // Computes four cofactors per instruction. Column i of the matrix is left
+        // out of cofactors 4i..4i+3, and each lane leaves out one row. The
+        // arithmetic is done in the same order as getCofactor(), so the result is
+        // identical to the scalar code.
+        const __m128 col[4] = { _mm_loadu_ps(&m[0]), _mm_loadu_ps(&m[4]), _mm_loadu_ps(&m[8]), _mm_loadu_ps(&m[12]) };
+        __m128 cof[4];
+        for(int i = 0; i < 4; ++i)
+        {
+            const __m128 a = col[i < 1 ? 1 : 0];
+            const __m128 b = col[i < 2 ? 2 : 1];
+            const __m128 c = col[i < 3 ? 3 : 2];
+
+            // rows (1,0,0,0), (2,2,1,1), (3,3,3,2) of each remaining column
+            const __m128 a0 = _mm_shuffle_ps(a, a, _MM_SHUFFLE(0,0,0,1));
+            const __m128 a1 = _mm_shuffle_ps(a, a, _MM_SHUFFLE(1,1,2,2));
+            const __m128 a2 = _mm_shuffle_ps(a, a, _MM_SHUFFLE(2,3,3,3));
+            const __m128 b0 = _mm_shuffle_ps(b, b, _MM_SHUFFLE(0,0,0,1));
+            const __m128 b1 = _mm_shuffle_ps(b, b, _MM_SHUFFLE(1,1,2,2));
+            const __m128 b2 = _mm_shuffle_ps(b, b, _MM_SHUFFLE(2,3,3,3));
+            const __m128 c0 = _mm_shuffle_ps(c, c, _MM_SHUFFLE(0,0,0,1));
+            const __m128 c1 = _mm_shuffle_ps(c, c, _MM_SHUFFLE(1,1,2,2));
+            const __m128 c2 = _mm_shuffle_ps(c, c, _MM_SHUFFLE(2,3,3,3));
+
+            __m128 t = _mm_mul_ps(a0, _mm_sub_ps(_mm_mul_ps(b1, c2), _mm_mul_ps(b2, c1)));
+            t = _mm_sub_ps(t, _mm_mul_ps(a1, _mm_sub_ps(_mm_mul_ps(b0, c2), _mm_mul_ps(b2, c0))));
+            t = _mm_add_ps(t, _mm_mul_ps(a2, _mm_sub_ps(_mm_mul_ps(b0, c1), _mm_mul_ps(b1, c0))));
+            cof[i] = t;
+        }
+
+        float cofactor[4];
+        _mm_storeu_ps(cofactor, cof[0]);
+        float determinant = m[0] * cofactor[0] - m[1] * cofactor[1] + m[2] * cofactor[2] - m[3] * cofactor[3];
+        if(std::fabs(determinant) <= EPSILON)
+        {
+            return identity();
+        }
+
+        // adj(M) is the transpose of the cofactor matrix, with alternating signs
+        _MM_TRANSPOSE4_PS(cof[0], cof[1], cof[2], cof[3]);
+        float invDeterminant = 1.0f / determinant;
+        const __m128 evenCol = _mm_setr_ps( invDeterminant, -invDeterminant,  invDeterminant, -invDeterminant);
+        const __m128 oddCol  = _mm_setr_ps(-invDeterminant,  invDeterminant, -invDeterminant,  invDeterminant);
+        _mm_storeu_ps(&m[0],  _mm_mul_ps(evenCol, cof[0]));
+        _mm_storeu_ps(&m[4],  _mm_mul_ps(oddCol,  cof[1]));
+        _mm_storeu_ps(&m[8],  _mm_mul_ps(evenCol, cof[2]));
+        _mm_storeu_ps(&m[12], _mm_mul_ps(oddCol,  cof[3]));
+
+        return *this;
+    }
+#endif
     // get cofactors of minor matrices
-    float cofactor0 = getCofactor(m[5],m[6],m[7], m[9],m[10],m[11], m[13],m[14],m[15]);
-    float cofactor1 = getCofactor(m[4],m[6],m[7], m[8],m[10],m[11], m[12],m[14],m[15]);
-    float cofactor2 = getCofactor(m[4],m[5],m[7], m[8],m[9], m[11], m[12],m[13],m[15]);
-    float cofactor3 = getCofactor(m[4],m[5],m[6], m[8],m[9], m[10], m[12],m[13],m[14]);
+    T cofactor0 = getCofactor(m[5],m[6],m[7], m[9],m[10],m[11], m[13],m[14],m[15]);
+    T cofactor1 = getCofactor(m[4],m[6],m[7], m[8],m[10],m[11], m[12],m[14],m[15]);
+    T cofactor2 = getCofactor(m[4],m[5],m[7], m[8],m[9], m[11], m[12],m[13],m[15]);
+    T cofactor3 = getCofactor(m[4],m[5],m[6], m[8],m[9], m[10], m[12],m[13],m[14]);
 
     // get determinant
-    float determinant = m[0] * cofactor0 - m[1] * cofactor1 + m[2] * cofactor2 - m[3] * cofactor3;
-    if(fabs(determinant) <= EPSILON)
+    T determinant = m[0] * cofactor0 - m[1] * cofactor1 + m[2] * cofactor2 - m[3] * cofactor3;
+    if(std::fabs(determinant) <= EPSILON)
     {
         return identity();
     }
 
     // get rest of cofactors for adj(M)
-    float cofactor4 = getCofactor(m[1],m[2],m[3], m[9],m[10],m[11], m[13],m[14],m[15]);
-    float cofactor5 = getCofactor(m[0],m[2],m[3], m[8],m[10],m[11], m[12],m[14],m[15]);
-    float cofactor6 = getCofactor(m[0],m[1],m[3], m[8],m[9], m[11], m[12],m[13],m[15]);
-    float cofactor7 = getCofactor(m[0],m[1],m[2], m[8],m[9], m[10], m[12],m[13],m[14]);
+    T cofactor4 = getCofactor(m[1],m[2],m[3], m[9],m[10],m[11], m[13],m[14],m[15]);
+    T cofactor5 = getCofactor(m[0],m[2],m[3], m[8],m[10],m[11], m[12],m[14],m[15]);
+    T cofactor6 = getCofactor(m[0],m[1],m[3], m[8],m[9], m[11], m[12],m[13],m[15]);
+    T cofactor7 = getCofactor(m[0],m[1],m[2], m[8],m[9], m[10], m[12],m[13],m[14]);
 
-    float cofactor8 = getCofactor(m[1],m[2],m[3], m[5],m[6], m[7],  m[13],m[14],m[15]);
-    float cofactor9 = getCofactor(m[0],m[2],m[3], m[4],m[6], m[7],  m[12],m[14],m[15]);
-    float cofactor10= getCofactor(m[0],m[1],m[3], m[4],m[5], m[7],  m[12],m[13],m[15]);
-    float cofactor11= getCofactor(m[0],m[1],m[2], m[4],m[5], m[6],  m[12],m[13],m[14]);
+    T cofactor8 = getCofactor(m[1],m[2],m[3], m[5],m[6], m[7],  m[13],m[14],m[15]);
+    T cofactor9 = getCofactor(m[0],m[2],m[3], m[4],m[6], m[7],  m[12],m[14],m[15]);
+    T cofactor10= getCofactor(m[0],m[1],m[3], m[4],m[5], m[7],  m[12],m[13],m[15]);
+    T cofactor11= getCofactor(m[0],m[1],m[2], m[4],m[5], m[6],  m[12],m[13],m[14]);
 
-    float cofactor12= getCofactor(m[1],m[2],m[3], m[5],m[6], m[7],  m[9], m[10],m[11]);
-    float cofactor13= getCofactor(m[0],m[2],m[3], m[4],m[6], m[7],  m[8], m[10],m[11]);
-    float cofactor14= getCofactor(m[0],m[1],m[3], m[4],m[5], m[7],  m[8], m[9], m[11]);
-    float cofactor15= getCofactor(m[0],m[1],m[2], m[4],m[5], m[6],  m[8], m[9], m[10]);
+    T cofactor12= getCofactor(m[1],m[2],m[3], m[5],m[6], m[7],  m[9], m[10],m[11]);
+    T cofactor13= getCofactor(m[0],m[2],m[3], m[4],m[6], m[7],  m[8], m[10],m[11]);
+    T cofactor14= getCofactor(m[0],m[1],m[3], m[4],m[5], m[7],  m[8], m[9], m[11]);
+    T cofactor15= getCofactor(m[0],m[1],m[2], m[4],m[5], m[6],  m[8], m[9], m[10]);
 
     // build inverse matrix = adj(M) / det(M)
     // adjugate of M is the transpose of the cofactor matrix of M
-    float invDeterminant = 1.0f / determinant;
+    T invDeterminant = 1.0f / determinant;
     m[0] =  invDeterminant * cofactor0;
     m[1] = -invDeterminant * cofactor4;
     m[2] =  invDeterminant * cofactor8;
@@ -478,100 +431,36 @@ Matrix4& Matrix4::invertGeneral()
 
 
 
-// -------------------------------------------------------------------------- //
-//  return determinant of 4x4 matrix
-// -------------------------------------------------------------------------- //
-float Matrix4::getDeterminant() const
-{
-    return m[0] * getCofactor(m[5],m[6],m[7], m[9],m[10],m[11], m[13],m[14],m[15]) -
-           m[1] * getCofactor(m[4],m[6],m[7], m[8],m[10],m[11], m[12],m[14],m[15]) +
-           m[2] * getCofactor(m[4],m[5],m[7], m[8],m[9], m[11], m[12],m[13],m[15]) -
-           m[3] * getCofactor(m[4],m[5],m[6], m[8],m[9], m[10], m[12],m[13],m[14]);
-}
-
-
-
-// -------------------------------------------------------------------------- //
-//  compute cofactor of 3x3 minor matrix without sign
-//  input params are 9 elements of the minor matrix
-//  NOTE: The caller must know its sign.
-// -------------------------------------------------------------------------- //
-float Matrix4::getCofactor(float m0, float m1, float m2,
-                           float m3, float m4, float m5,
-                           float m6, float m7, float m8) const
-{
-    return m0 * (m4 * m8 - m5 * m7) -
-           m1 * (m3 * m8 - m5 * m6) +
-           m2 * (m3 * m7 - m4 * m6);
-}
-
-
-
-// -------------------------------------------------------------------------- //
-//  translate this matrix by (x, y, z)
-// -------------------------------------------------------------------------- //
-Matrix4& Matrix4::translate(const Vector3& v)
-{
-    return translate(v.x, v.y, v.z);
-}
-
-Matrix4& Matrix4::translate(float x, float y, float z)
-{
-    m[0] += m[3] * x;   m[4] += m[7] * x;   m[8] += m[11]* x;   m[12]+= m[15]* x;
-    m[1] += m[3] * y;   m[5] += m[7] * y;   m[9] += m[11]* y;   m[13]+= m[15]* y;
-    m[2] += m[3] * z;   m[6] += m[7] * z;   m[10]+= m[11]* z;   m[14]+= m[15]* z;
-
-    return *this;
-}
-
-
-
-// -------------------------------------------------------------------------- //
-//  uniform scale
-// -------------------------------------------------------------------------- //
-Matrix4& Matrix4::scale(float s)
-{
-    return scale(s, s, s);
-}
-
-Matrix4& Matrix4::scale(float x, float y, float z)
-{
-    m[0] *= x;   m[4] *= x;   m[8] *= x;   m[12] *= x;
-    m[1] *= y;   m[5] *= y;   m[9] *= y;   m[13] *= y;
-    m[2] *= z;   m[6] *= z;   m[10]*= z;   m[14] *= z;
-    return *this;
-}
-
-
-
 // -------------------------------------------------------------------------- //
 //  build a rotation matrix with given angle(degree) and rotation axis, then
 //  multiply it with this object
 // -------------------------------------------------------------------------- //
-Matrix4& Matrix4::rotate(float angle, const Vector3& axis)
+template <typename T>
+Matrix4T<T>& Matrix4T<T>::rotate(T angle, const Vector3T<T>& axis)
 {
     return rotate(angle, axis.x, axis.y, axis.z);
 }
 
-Matrix4& Matrix4::rotate(float angle, float x, float y, float z)
+template <typename T>
+Matrix4T<T>& Matrix4T<T>::rotate(T angle, T x, T y, T z)
 {
-    float c = cosf(angle * DEG2RAD);    // cosine
-    float s = sinf(angle * DEG2RAD);    // sine
-    float c1 = 1.0f - c;                // 1 - c
-    float m0 = m[0],  m4 = m[4],  m8 = m[8],  m12= m[12],
+    T c = std::cos(angle * Deg2Rad<T>());    // cosine
+    T s = std::sin(angle * Deg2Rad<T>());    // sine
+    T c1 = 1.0f - c;                // 1 - c
+    T m0 = m[0],  m4 = m[4],  m8 = m[8],  m12= m[12],
           m1 = m[1],  m5 = m[5],  m9 = m[9],  m13= m[13],
           m2 = m[2],  m6 = m[6],  m10= m[10], m14= m[14];
 
     // build rotation matrix
-    float r0 = x * x * c1 + c;
-    float r1 = x * y * c1 + z * s;
-    float r2 = x * z * c1 - y * s;
-    float r4 = x * y * c1 - z * s;
-    float r5 = y * y * c1 + c;
-    float r6 = y * z * c1 + x * s;
-    float r8 = x * z * c1 + y * s;
-    float r9 = y * z * c1 - x * s;
-    float r10= z * z * c1 + c;
+    T r0 = x * x * c1 + c;
+    T r1 = x * y * c1 + z * s;
+    T r2 = x * z * c1 - y * s;
+    T r4 = x * y * c1 - z * s;
+    T r5 = y * y * c1 + c;
+    T r6 = y * z * c1 + x * s;
+    T r8 = x * z * c1 + y * s;
+    T r9 = y * z * c1 - x * s;
+    T r10= z * z * c1 + c;
 
     // multiply rotation matrix
     m[0] = r0 * m0 + r4 * m1 + r8 * m2;
@@ -590,11 +479,12 @@ Matrix4& Matrix4::rotate(float angle, float x, float y, float z)
     return *this;
 }
 
-Matrix4& Matrix4::rotateX(float angle)
+template <typename T>
+Matrix4T<T>& Matrix4T<T>::rotateX(T angle)
 {
-    float c = cosf(angle * DEG2RAD);
-    float s = sinf(angle * DEG2RAD);
-    float m1 = m[1],  m2 = m[2],
+    T c = std::cos(angle * Deg2Rad<T>());
+    T s = std::sin(angle * Deg2Rad<T>());
+    T m1 = m[1],  m2 = m[2],
           m5 = m[5],  m6 = m[6],
           m9 = m[9],  m10= m[10],
           m13= m[13], m14= m[14];
@@ -611,11 +501,12 @@ Matrix4& Matrix4::rotateX(float angle)
     return *this;
 }
 
-Matrix4& Matrix4::rotateY(float angle)
+template <typename T>
+Matrix4T<T>& Matrix4T<T>::rotateY(T angle)
 {
-    float c = cosf(angle * DEG2RAD);
-    float s = sinf(angle * DEG2RAD);
-    float m0 = m[0],  m2 = m[2],
+    T c = std::cos(angle * Deg2Rad<T>());
+    T s = std::sin(angle * Deg2Rad<T>());
+    T m0 = m[0],  m2 = m[2],
           m4 = m[4],  m6 = m[6],
           m8 = m[8],  m10= m[10],
           m12= m[12], m14= m[14];
@@ -632,11 +523,12 @@ Matrix4& Matrix4::rotateY(float angle)
     return *this;
 }
 
-Matrix4& Matrix4::rotateZ(float angle)
+template <typename T>
+Matrix4T<T>& Matrix4T<T>::rotateZ(T angle)
 {
-    float c = cosf(angle * DEG2RAD);
-    float s = sinf(angle * DEG2RAD);
-    float m0 = m[0],  m1 = m[1],
+    T c = std::cos(angle * Deg2Rad<T>());
+    T s = std::sin(angle * Deg2Rad<T>());
+    T m0 = m[0],  m1 = m[1],
           m4 = m[4],  m5 = m[5],
           m8 = m[8],  m9 = m[9],
           m12= m[12], m13= m[13];
@@ -662,18 +554,19 @@ Matrix4& Matrix4::rotateZ(float angle)
 //  translation values.
 //  NOTE: It is for rotating object to look at the target, NOT for camera
 // -------------------------------------------------------------------------- //
-Matrix4& Matrix4::lookAt(const Vector3& target)
+template <typename T>
+Matrix4T<T>& Matrix4T<T>::lookAt(const Vector3T<T>& target)
 {
     // compute forward vector and normalize
-    Vector3 position = Vector3(m[12], m[13], m[14]);
-    Vector3 forward = target - position;
+    Vector3T<T> position = Vector3T<T>(m[12], m[13], m[14]);
+    Vector3T<T> forward = target - position;
     forward.normalize();
-    Vector3 up;             // up vector of object
-    Vector3 left;           // left vector of object
+    Vector3T<T> up;             // up vector of object
+    Vector3T<T> left;           // left vector of object
 
     // compute temporal up vector
     // if forward vector is near Y-axis, use up vector (0,0,-1) or (0,0,1)
-    if(fabs(forward.x) < EPSILON && fabs(forward.z) < EPSILON)
+    if(std::fabs(forward.x) < EPSILON && std::fabs(forward.z) < EPSILON)
     {
         // forward vector is pointing +Y axis
         if(forward.y > 0)
@@ -704,19 +597,20 @@ Matrix4& Matrix4::lookAt(const Vector3& target)
     return *this;
 }
 
-Matrix4& Matrix4::lookAt(const Vector3& target, const Vector3& upVec)
+template <typename T>
+Matrix4T<T>& Matrix4T<T>::lookAt(const Vector3T<T>& target, const Vector3T<T>& upVec)
 {
     // compute forward vector and normalize
-    Vector3 position = Vector3(m[12], m[13], m[14]);
-    Vector3 forward = target - position;
+    Vector3T<T> position = Vector3T<T>(m[12], m[13], m[14]);
+    Vector3T<T> forward = target - position;
     forward.normalize();
 
     // compute left vector
-    Vector3 left = upVec.cross(forward);
+    Vector3T<T> left = upVec.cross(forward);
     left.normalize();
 
     // compute orthonormal up vector
-    Vector3 up = forward.cross(left);
+    Vector3T<T> up = forward.cross(left);
     up.normalize();
 
     // NOTE: overwrite rotation and scale info of the current matrix
@@ -727,14 +621,16 @@ Matrix4& Matrix4::lookAt(const Vector3& target, const Vector3& upVec)
     return *this;
 }
 
-Matrix4& Matrix4::lookAt(float tx, float ty, float tz)
+template <typename T>
+Matrix4T<T>& Matrix4T<T>::lookAt(T tx, T ty, T tz)
 {
-    return lookAt(Vector3(tx, ty, tz));
+    return lookAt(Vector3T<T>(tx, ty, tz));
 }
 
-Matrix4& Matrix4::lookAt(float tx, float ty, float tz, float ux, float uy, float uz)
+template <typename T>
+Matrix4T<T>& Matrix4T<T>::lookAt(T tx, T ty, T tz, T ux, T uy, T uz)
 {
-    return lookAt(Vector3(tx, ty, tz), Vector3(ux, uy, uz));
+    return lookAt(Vector3T<T>(tx, ty, tz), Vector3T<T>(ux, uy, uz));
 }
 
 
@@ -742,9 +638,10 @@ Matrix4& Matrix4::lookAt(float tx, float ty, float tz, float ux, float uy, float
 // -------------------------------------------------------------------------- //
 //  return 3x3 matrix containing rotation only
 // -------------------------------------------------------------------------- //
-Matrix3 Matrix4::getRotationMatrix() const
+template <typename T>
+Matrix3T<T> Matrix4T<T>::getRotationMatrix() const
 {
-    Matrix3 mat(m[0], m[1], m[2],
+    Matrix3T<T> mat(m[0], m[1], m[2],
                 m[4], m[5], m[6],
                 m[8], m[9], m[10]);
     return mat;
@@ -756,9 +653,10 @@ Matrix3 Matrix4::getRotationMatrix() const
 // -------------------------------------------------------------------------- //
 //  skew with a given angle on the axis
 // -------------------------------------------------------------------------- //
-Matrix4& Matrix4::skew(float angle, const Vector3& axis)
+template <typename T>
+Matrix4T<T>& Matrix4T<T>::skew(T angle, const Vector3T<T>& axis)
 {
-    float t = tanf(angle * DEG2RAD);    // tangent
+    T t = std::tan(angle * Deg2Rad<T>());    // tangent
     m[0] += m[1] * t;
     m[4] += m[5] * t;
     m[8] += m[9] * t;
@@ -783,14 +681,15 @@ Matrix4& Matrix4::skew(float angle, const Vector3& axis)
 //  Yaw  : asin(m[8]) = asin(Sy)
 //  Roll : atan(-m[4] / m[0]) = atan(SzCy/CzCy)
 // -------------------------------------------------------------------------- //
-Vector3 Matrix4::getAngle() const
+template <typename T>
+Vector3T<T> Matrix4T<T>::getAngle() const
 {
-    float pitch, yaw, roll;         // 3 angles
+    T pitch, yaw, roll;         // 3 angles
 
     // find yaw (around y-axis) first
     // NOTE: asin() returns -90~+90, so correct the angle range -180~+180
     // using z value of forward vector
-    yaw = RAD2DEG * asinf(m[8]);
+    yaw = Rad2Deg<T>() * std::asin(m[8]);
     if(m[10] < 0)
     {
         if(yaw >= 0) yaw = 180.0f - yaw;
@@ -802,15 +701,28 @@ Vector3 Matrix4::getAngle() const
     if(m[0] > -EPSILON && m[0] < EPSILON)
     {
         roll  = 0;  //@@ assume roll=0
-        pitch = RAD2DEG * atan2f(m[1], m[5]);
+        pitch = Rad2Deg<T>() * std::atan2(m[1], m[5]);
     }
     else
     {
-        roll = RAD2DEG * atan2f(-m[4], m[0]);
-        pitch = RAD2DEG * atan2f(-m[9], m[10]);
+        roll = Rad2Deg<T>() * std::atan2(-m[4], m[0]);
+        pitch = Rad2Deg<T>() * std::atan2(-m[9], m[10]);
     }
 
-    return Vector3(pitch, yaw, roll);
+    return Vector3T<T>(pitch, yaw, roll);
 }
 
-END_NAMESPACE_YUP
\ No newline at end of file
+
+
+
+// ========================================================================== //
+//  instantiations, the float ones are declared extern in Matrices.h
+// ========================================================================== //
+template class Matrix2T<float>;
+template class Matrix3T<float>;
+template class Matrix4T<float>;
+template class Matrix2T<double>;
+template class Matrix3T<double>;
+template class Matrix4T<double>;
+
+END_NAMESPACE_YUP
@@ -9,6 +9,9 @@
 //             | 2 5 8 |    |  2  6 10 14 |
 //                          |  3  7 11 15 |
 //
+//  Templated on the element type like Vectors.h, Matrix2/3/4 are the float
+//  ones and Matrix2d/3d/4d the double ones.
+//
 //  Created: 2016-08-24
 //  Updated: 2016-08-24
 //
@@ -20,63 +23,87 @@
 
 #include <iostream>
 #include <iomanip>
+#include <type_traits>
 #include "Vectors.h"
 
 #include "yup.h"
+#include "Simd.h"
 
 BEGIN_NAMESPACE_YUP
 
 // ========================================================================== //
 //  2x2 matrix
 // ========================================================================== //
-class Matrix2
+template <typename T>
+class Matrix2T
 {
 public:
     // constructors
-    Matrix2();  // init with identity
-    Matrix2(const float src[4]);
-    Matrix2(float m0, float m1, float m2, float m3);
-
-    void        set(const float src[4]);
-    void        set(float m0, float m1, float m2, float m3);
-    void        setRow(int index, const float row[2]);
-    void        setRow(int index, const Vector2& v);
-    void        setColumn(int index, const float col[2]);
-    void        setColumn(int index, const Vector2& v);
-
-    const float* get() const;
-    float       getDeterminant() const;
-    float       getAngle() const;                       // retrieve angle (degree) from matrix
-
-    Matrix2&    identity();
-    Matrix2&    transpose();                            // transpose itself and return reference
-    Matrix2&    invert();
+    constexpr Matrix2T();                               // init with identity
+    constexpr Matrix2T(const T src[4]);
+    template <typename U>
+    constexpr explicit Matrix2T(const Matrix2T<U>& rhs) { for (int i = 0; i < 4; i++) m[i] = (T)rhs[i]; }
+    constexpr Matrix2T(T m0, T m1, T m2, T m3);
+
+    constexpr void set(const T src[4]);
+    constexpr void set(T m0, T m1, T m2, T m3);
+    constexpr void setRow(int index, const T row[2]);
+    constexpr void setRow(int index, const Vector2T<T>& v);
+    constexpr void setColumn(int index, const T col[2]);
+    constexpr void setColumn(int index, const Vector2T<T>& v);
+
+    constexpr const T* get() const;
+    constexpr T getDeterminant() const;
+    T           getAngle() const;                       // retrieve angle (degree) from matrix
+
+    constexpr Matrix2T& identity();
+    constexpr Matrix2T& transpose();                    // transpose itself and return reference
+    Matrix2T&   invert();
 
     // operators
-    Matrix2     operator+(const Matrix2& rhs) const;    // add rhs
-    Matrix2     operator-(const Matrix2& rhs) const;    // subtract rhs
-    Matrix2&    operator+=(const Matrix2& rhs);         // add rhs and update this object
-    Matrix2&    operator-=(const Matrix2& rhs);         // subtract rhs and update this object
-    Vector2     operator*(const Vector2& rhs) const;    // multiplication: v' = M * v
-    Matrix2     operator*(const Matrix2& rhs) const;    // multiplication: M3 = M1 * M2
-    Matrix2&    operator*=(const Matrix2& rhs);         // multiplication: M1' = M1 * M2
-    bool        operator==(const Matrix2& rhs) const;   // exact compare, no epsilon
-    bool        operator!=(const Matrix2& rhs) const;   // exact compare, no epsilon
-    float       operator[](int index) const;            // subscript operator v[0], v[1]
-    float&      operator[](int index);                  // subscript operator v[0], v[1]
+    constexpr Matrix2T operator+(const Matrix2T& rhs) const; // add rhs
+    constexpr Matrix2T operator-(const Matrix2T& rhs) const; // subtract rhs
+    constexpr Matrix2T& operator+=(const Matrix2T& rhs); // add rhs and update this object
+    constexpr Matrix2T& operator-=(const Matrix2T& rhs); // subtract rhs and update this object
+    constexpr Vector2T<T> operator*(const Vector2T<T>& rhs) const; // multiplication: v' = M * v
+    constexpr Matrix2T operator*(const Matrix2T& rhs) const; // multiplication: M3 = M1 * M2
+    constexpr Matrix2T& operator*=(const Matrix2T& rhs); // multiplication: M1' = M1 * M2
+    constexpr bool operator==(const Matrix2T& rhs) const; // exact compare, no epsilon
+    constexpr bool operator!=(const Matrix2T& rhs) const; // exact compare, no epsilon
+    constexpr T operator[](int index) const;            // subscript operator v[0], v[1]
+    constexpr T& operator[](int index);                 // subscript operator v[0], v[1]
 
     // friends functions
-    friend Matrix2 operator-(const Matrix2& m);                     // unary operator (-)
-    friend Matrix2 operator*(float scalar, const Matrix2& m);       // pre-multiplication
-    friend Vector2 operator*(const Vector2& vec, const Matrix2& m); // pre-multiplication
-    friend std::ostream& operator<<(std::ostream& os, const Matrix2& m);
+    // unary operator (-)
+    friend constexpr Matrix2T operator-(const Matrix2T& rhs)
+    {
+        return Matrix2T(-rhs[0], -rhs[1], -rhs[2], -rhs[3]);
+    }
+    // pre-multiplication
+    friend constexpr Matrix2T operator*(T s, const Matrix2T& rhs)
+    {
+        return Matrix2T(s*rhs[0], s*rhs[1], s*rhs[2], s*rhs[3]);
+    }
+    // pre-multiplication
+    friend constexpr Vector2T<T> operator*(const Vector2T<T>& v, const Matrix2T& rhs)
+    {
+        return Vector2T<T>(v.x*rhs[0] + v.y*rhs[1],  v.x*rhs[2] + v.y*rhs[3]);
+    }
+    friend std::ostream& operator<<(std::ostream& os, const Matrix2T& m)
+    {
+        os << std::fixed << std::setprecision(5);
+        os << "[" << std::setw(10) << m[0] << " " << std::setw(10) << m[2] << "]\n"
+           << "[" << std::setw(10) << m[1] << " " << std::setw(10) << m[3] << "]\n";
+        os << std::resetiosflags(std::ios_base::fixed | std::ios_base::floatfield);
+        return os;
+    }
 
     // static functions
 
 protected:
 
 private:
-    float m[4];
+    T m[4] = {};
 
 };
 
@@ -85,56 +112,79 @@ private:
 // ========================================================================== //
 //  3x3 matrix
 // ========================================================================== //
-class Matrix3
+template <typename T>
+class Matrix3T
 {
 public:
     // constructors
-    Matrix3();  // init with identity
-    Matrix3(const float src[9]);
-    Matrix3(float m0, float m1, float m2,           // 1st column
-            float m3, float m4, float m5,           // 2nd column
-            float m6, float m7, float m8);          // 3rd column
-
-    void        set(const float src[9]);
-    void        set(float m0, float m1, float m2,   // 1st column
-                    float m3, float m4, float m5,   // 2nd column
-                    float m6, float m7, float m8);  // 3rd column
-    void        setRow(int index, const float row[3]);
-    void        setRow(int index, const Vector3& v);
-    void        setColumn(int index, const float col[3]);
-    void        setColumn(int index, const Vector3& v);
-
-    const float* get() const;
-    float       getDeterminant() const;
-    Vector3     getAngle() const;                       // return (pitch, yaw, roll)
-
-    Matrix3&    identity();
-    Matrix3&    transpose();                            // transpose itself and return reference
-    Matrix3&    invert();
+    constexpr Matrix3T();                               // init with identity
+    constexpr Matrix3T(const T src[9]);
+    template <typename U>
+    constexpr explicit Matrix3T(const Matrix3T<U>& rhs) { for (int i = 0; i < 9; i++) m[i] = (T)rhs[i]; }
+    constexpr Matrix3T(T m0, T m1, T m2,                // 1st column
+                       T m3, T m4, T m5,                // 2nd column
+                       T m6, T m7, T m8);               // 3rd column
+
+    constexpr void set(const T src[9]);
+    constexpr void set(T m0, T m1, T m2,                // 1st column
+                       T m3, T m4, T m5,                // 2nd column
+                       T m6, T m7, T m8);               // 3rd column
+    constexpr void setRow(int index, const T row[3]);
+    constexpr void setRow(int index, const Vector3T<T>& v);
+    constexpr void setColumn(int index, const T col[3]);
+    constexpr void setColumn(int index, const Vector3T<T>& v);
+
+    constexpr const T* get() const;
+    constexpr T getDeterminant() const;
+    Vector3T<T> getAngle() const;                       // return (pitch, yaw, roll)
+
+    constexpr Matrix3T& identity();
+    constexpr Matrix3T& transpose();                    // transpose itself and return reference
+    Matrix3T&   invert();
 
     // operators
-    Matrix3     operator+(const Matrix3& rhs) const;    // add rhs
-    Matrix3     operator-(const Matrix3& rhs) const;    // subtract rhs
-    Matrix3&    operator+=(const Matrix3& rhs);         // add rhs and update this object
-    Matrix3&    operator-=(const Matrix3& rhs);         // subtract rhs and update this object
-    Vector3     operator*(const Vector3& rhs) const;    // multiplication: v' = M * v
-    Matrix3     operator*(const Matrix3& rhs) const;    // multiplication: M3 = M1 * M2
-    Matrix3&    operator*=(const Matrix3& rhs);         // multiplication: M1' = M1 * M2
-    bool        operator==(const Matrix3& rhs) const;   // exact compare, no epsilon
-    bool        operator!=(const Matrix3& rhs) const;   // exact compare, no epsilon
-    float       operator[](int index) const;            // subscript operator v[0], v[1]
-    float&      operator[](int index);                  // subscript operator v[0], v[1]
+    constexpr Matrix3T operator+(const Matrix3T& rhs) const; // add rhs
+    constexpr Matrix3T operator-(const Matrix3T& rhs) const; // subtract rhs
+    constexpr Matrix3T& operator+=(const Matrix3T& rhs); // add rhs and update this object
+    constexpr Matrix3T& operator-=(const Matrix3T& rhs); // subtract rhs and update this object
+    constexpr Vector3T<T> operator*(const Vector3T<T>& rhs) const; // multiplication: v' = M * v
+    constexpr Matrix3T operator*(const Matrix3T& rhs) const; // multiplication: M3 = M1 * M2
+    constexpr Matrix3T& operator*=(const Matrix3T& rhs); // multiplication: M1' = M1 * M2
+    constexpr bool operator==(const Matrix3T& rhs) const; // exact compare, no epsilon
+    constexpr bool operator!=(const Matrix3T& rhs) const; // exact compare, no epsilon
+    constexpr T operator[](int index) const;            // subscript operator v[0], v[1]
+    constexpr T& operator[](int index);                 // subscript operator v[0], v[1]
 
     // friends functions
-    friend Matrix3 operator-(const Matrix3& m);                     // unary operator (-)
-    friend Matrix3 operator*(float scalar, const Matrix3& m);       // pre-multiplication
-    friend Vector3 operator*(const Vector3& vec, const Matrix3& m); // pre-multiplication
-    friend std::ostream& operator<<(std::ostream& os, const Matrix3& m);
+    // unary operator (-)
+    friend constexpr Matrix3T operator-(const Matrix3T& rhs)
+    {
+        return Matrix3T(-rhs[0], -rhs[1], -rhs[2], -rhs[3], -rhs[4], -rhs[5], -rhs[6], -rhs[7], -rhs[8]);
+    }
+    // pre-multiplication
+    friend constexpr Matrix3T operator*(T s, const Matrix3T& rhs)
+    {
+        return Matrix3T(s*rhs[0], s*rhs[1], s*rhs[2], s*rhs[3], s*rhs[4], s*rhs[5], s*rhs[6], s*rhs[7], s*rhs[8]);
+    }
+    // pre-multiplication
+    friend constexpr Vector3T<T> operator*(const Vector3T<T>& v, const Matrix3T& m)
+    {
+        return Vector3T<T>(v.x*m[0] + v.y*m[1] + v.z*m[2],  v.x*m[3] + v.y*m[4] + v.z*m[5],  v.x*m[6] + v.y*m[7] + v.z*m[8]);
+    }
+    friend std::ostream& operator<<(std::ostream& os, const Matrix3T& m)
+    {
+        os << std::fixed << std::setprecision(5);
+        os << "[" << std::setw(10) << m[0] << " " << std::setw(10) << m[3] << " " << std::setw(10) << m[6] << "]\n"
+           << "[" << std::setw(10) << m[1] << " " << std::setw(10) << m[4] << " " << std::setw(10) << m[7] << "]\n"
+           << "[" << std::setw(10) << m[2] << " " << std::setw(10) << m[5] << " " << std::setw(10) << m[8] << "]\n";
+        os << std::resetiosflags(std::ios_base::fixed | std::ios_base::floatfield);
+        return os;
+    }
 
 protected:
 
 private:
-    float m[9];
+    T m[9] = {};
 
 };
 
@@ -143,101 +193,150 @@ private:
 // ========================================================================== //
 //  4x4 matrix
 // ========================================================================== //
-class Matrix4
+template <typename T>
+class Matrix4T
 {
 public:
     // constructors
-    Matrix4();  // init with identity
-    Matrix4(const float src[16]);
-    Matrix4(float m00, float m01, float m02, float m03, // 1st column
-            float m04, float m05, float m06, float m07, // 2nd column
-            float m08, float m09, float m10, float m11, // 3rd column
-            float m12, float m13, float m14, float m15);// 4th column
-
-    void        set(const float src[16]);
-    void        set(float m00, float m01, float m02, float m03, // 1st column
-                    float m04, float m05, float m06, float m07, // 2nd column
-                    float m08, float m09, float m10, float m11, // 3rd column
-                    float m12, float m13, float m14, float m15);// 4th column
-    void        setRow(int index, const float row[4]);
-    void        setRow(int index, const Vector4& v);
-    void        setRow(int index, const Vector3& v);
-    void        setColumn(int index, const float col[4]);
-    void        setColumn(int index, const Vector4& v);
-    void        setColumn(int index, const Vector3& v);
-
-    const float* get() const;
-    const float* getTranspose();                        // return transposed matrix
-    float       getDeterminant() const;
-    Matrix3     getRotationMatrix() const;              // return 3x3 rotation part
-    Vector3     getAngle() const;                       // return (pitch, yaw, roll)
-
-    Matrix4&    identity();
-    Matrix4&    transpose();                            // transpose itself and return reference
-    Matrix4&    invert();                               // check best inverse method before inverse
-    Matrix4&    invertEuclidean();                      // inverse of Euclidean transform matrix
-    Matrix4&    invertAffine();                         // inverse of affine transform matrix
-    Matrix4&    invertProjective();                     // inverse of projective matrix using partitioning
-    Matrix4&    invertGeneral();                        // inverse of generic matrix
+    constexpr Matrix4T();                               // init with identity
+    constexpr Matrix4T(const T src[16]);
+    template <typename U>
+    constexpr explicit Matrix4T(const Matrix4T<U>& rhs) : m{} { for (int i = 0; i < 16; i++) m[i] = (T)rhs[i]; }
+    constexpr Matrix4T(T m00, T m01, T m02, T m03,      // 1st column
+                       T m04, T m05, T m06, T m07,      // 2nd column
+                       T m08, T m09, T m10, T m11,      // 3rd column
+                       T m12, T m13, T m14, T m15);     // 4th column
+
+    constexpr void set(const T src[16]);
+    constexpr void set(T m00, T m01, T m02, T m03,      // 1st column
+                       T m04, T m05, T m06, T m07,      // 2nd column
+                       T m08, T m09, T m10, T m11,      // 3rd column
+                       T m12, T m13, T m14, T m15);     // 4th column
+    constexpr void setRow(int index, const T row[4]);
+    constexpr void setRow(int index, const Vector4T<T>& v);
+    constexpr void setRow(int index, const Vector3T<T>& v);
+    constexpr void setColumn(int index, const T col[4]);
+    constexpr void setColumn(int index, const Vector4T<T>& v);
+    constexpr void setColumn(int index, const Vector3T<T>& v);
+
+    constexpr const T* get() const;
+    const T* getTranspose();                            // return transposed matrix
+    constexpr T getDeterminant() const;
+    Matrix3T<T> getRotationMatrix() const;              // return 3x3 rotation part
+    Vector3T<T> getAngle() const;                       // return (pitch, yaw, roll)
+
+    constexpr Matrix4T& identity();
+    constexpr Matrix4T& transpose();                    // transpose itself and return reference
+    Matrix4T&   invert();                               // check best inverse method before inverse
+    constexpr Matrix4T& invertEuclidean();              // inverse of Euclidean transform matrix
+    Matrix4T&   invertAffine();                         // inverse of affine transform matrix
+    Matrix4T&   invertProjective();                     // inverse of projective matrix using partitioning
+    Matrix4T&   invertGeneral();                        // inverse of generic matrix
 
     // transform matrix
-    Matrix4&    translate(float x, float y, float z);   // translation by (x,y,z)
-    Matrix4&    translate(const Vector3& v);            //
-    Matrix4&    rotate(float angle, const Vector3& axis); // rotate angle(degree) along the given axix
-    Matrix4&    rotate(float angle, float x, float y, float z);
-    Matrix4&    rotateX(float angle);                   // rotate on X-axis with degree
-    Matrix4&    rotateY(float angle);                   // rotate on Y-axis with degree
-    Matrix4&    rotateZ(float angle);                   // rotate on Z-axis with degree
-    Matrix4&    scale(float scale);                     // uniform scale
-    Matrix4&    scale(float sx, float sy, float sz);    // scale by (sx, sy, sz) on each axis
-    Matrix4&    lookAt(float tx, float ty, float tz);   // face object to the target direction
-    Matrix4&    lookAt(float tx, float ty, float tz, float ux, float uy, float uz);
-    Matrix4&    lookAt(const Vector3& target);
-    Matrix4&    lookAt(const Vector3& target, const Vector3& up);
+    constexpr Matrix4T& translate(T x, T y, T z);       // translation by (x,y,z)
+    constexpr Matrix4T& translate(const Vector3T<T>& v); //
+    Matrix4T&   rotate(T angle, const Vector3T<T>& axis); // rotate angle(degree) along the given axix
+    Matrix4T&   rotate(T angle, T x, T y, T z);
+    Matrix4T&   rotateX(T angle);                       // rotate on X-axis with degree
+    Matrix4T&   rotateY(T angle);                       // rotate on Y-axis with degree
+    Matrix4T&   rotateZ(T angle);                       // rotate on Z-axis with degree
+    constexpr Matrix4T& scale(T scale);                 // uniform scale
+    constexpr Matrix4T& scale(T sx, T sy, T sz);        // scale by (sx, sy, sz) on each axis
+    Matrix4T&   lookAt(T tx, T ty, T tz);               // face object to the target direction
+    Matrix4T&   lookAt(T tx, T ty, T tz, T ux, T uy, T uz);
+    Matrix4T&   lookAt(const Vector3T<T>& target);
+    Matrix4T&   lookAt(const Vector3T<T>& target, const Vector3T<T>& up);
     //@@Matrix4&    skew(float angle, const Vector3& axis); //
 
     // operators
-    Matrix4     operator+(const Matrix4& rhs) const;    // add rhs
-    Matrix4     operator-(const Matrix4& rhs) const;    // subtract rhs
-    Matrix4&    operator+=(const Matrix4& rhs);         // add rhs and update this object
-    Matrix4&    operator-=(const Matrix4& rhs);         // subtract rhs and update this object
-    Vector4     operator*(const Vector4& rhs) const;    // multiplication: v' = M * v
-    Vector3     operator*(const Vector3& rhs) const;    // multiplication: v' = M * v
-    Matrix4     operator*(const Matrix4& rhs) const;    // multiplication: M3 = M1 * M2
-    Matrix4&    operator*=(const Matrix4& rhs);         // multiplication: M1' = M1 * M2
-    bool        operator==(const Matrix4& rhs) const;   // exact compare, no epsilon
-    bool        operator!=(const Matrix4& rhs) const;   // exact compare, no epsilon
-    float       operator[](int index) const;            // subscript operator v[0], v[1]
-    float&      operator[](int index);                  // subscript operator v[0], v[1]
+    constexpr Matrix4T operator+(const Matrix4T& rhs) const; // add rhs
+    constexpr Matrix4T operator-(const Matrix4T& rhs) const; // subtract rhs
+    constexpr Matrix4T& operator+=(const Matrix4T& rhs); // add rhs and update this object
+    constexpr Matrix4T& operator-=(const Matrix4T& rhs); // subtract rhs and update this object
+    YUP_SIMD_CONSTEXPR Vector4T<T> operator*(const Vector4T<T>& rhs) const; // multiplication: v' = M * v
+    constexpr Vector3T<T> operator*(const Vector3T<T>& rhs) const; // multiplication: v' = M * v
+    YUP_SIMD_CONSTEXPR Matrix4T operator*(const Matrix4T& rhs) const; // multiplication: M3 = M1 * M2
+    YUP_SIMD_CONSTEXPR Matrix4T& operator*=(const Matrix4T& rhs); // multiplication: M1' = M1 * M2
+    constexpr bool operator==(const Matrix4T& rhs) const; // exact compare, no epsilon
+    constexpr bool operator!=(const Matrix4T& rhs) const; // exact compare, no epsilon
+    constexpr T operator[](int index) const;            // subscript operator v[0], v[1]
+    constexpr T& operator[](int index);                 // subscript operator v[0], v[1]
 
     // friends functions
-    friend Matrix4 operator-(const Matrix4& m);                     // unary operator (-)
-    friend Matrix4 operator*(float scalar, const Matrix4& m);       // pre-multiplication
-    friend Vector3 operator*(const Vector3& vec, const Matrix4& m); // pre-multiplication
-    friend Vector4 operator*(const Vector4& vec, const Matrix4& m); // pre-multiplication
-    friend std::ostream& operator<<(std::ostream& os, const Matrix4& m);
+    // unary operator (-)
+    friend constexpr Matrix4T operator-(const Matrix4T& rhs)
+    {
+        return Matrix4T(-rhs[0], -rhs[1], -rhs[2], -rhs[3], -rhs[4], -rhs[5], -rhs[6], -rhs[7], -rhs[8], -rhs[9], -rhs[10], -rhs[11], -rhs[12], -rhs[13], -rhs[14], -rhs[15]);
+    }
+    // pre-multiplication
+    friend constexpr Matrix4T operator*(T s, const Matrix4T& rhs)
+    {
+        return Matrix4T(s*rhs[0], s*rhs[1], s*rhs[2], s*rhs[3], s*rhs[4], s*rhs[5], s*rhs[6], s*rhs[7], s*rhs[8], s*rhs[9], s*rhs[10], s*rhs[11], s*rhs[12], s*rhs[13], s*rhs[14], s*rhs[15]);
+    }
+    // pre-multiplication
+    friend constexpr Vector3T<T> operator*(const Vector3T<T>& v, const Matrix4T& m)
+    {
+        return Vector3T<T>(v.x*m[0] + v.y*m[1] + v.z*m[2],  v.x*m[4] + v.y*m[5] + v.z*m[6],  v.x*m[8] + v.y*m[9] + v.z*m[10]);
+    }
+    // pre-multiplication
+    friend constexpr Vector4T<T> operator*(const Vector4T<T>& v, const Matrix4T& m)
+    {
+        return Vector4T<T>(v.x*m[0] + v.y*m[1] + v.z*m[2] + v.w*m[3],  v.x*m[4] + v.y*m[5] + v.z*m[6] + v.w*m[7],  v.x*m[8] + v.y*m[9] + v.z*m[10] + v.w*m[11], v.x*m[12] + v.y*m[13] + v.z*m[14] + v.w*m[15]);
+    }
+    friend std::ostream& operator<<(std::ostream& os, const Matrix4T& m)
+    {
+        os << std::fixed << std::setprecision(5);
+        os << "[" << std::setw(10) << m[0] << " " << std::setw(10) << m[4] << " " << std::setw(10) << m[8]  <<  " " << std::setw(10) << m[12] << "]\n"
+           << "[" << std::setw(10) << m[1] << " " << std::setw(10) << m[5] << " " << std::setw(10) << m[9]  <<  " " << std::setw(10) << m[13] << "]\n"
+           << "[" << std::setw(10) << m[2] << " " << std::setw(10) << m[6] << " " << std::setw(10) << m[10] <<  " " << std::setw(10) << m[14] << "]\n"
+           << "[" << std::setw(10) << m[3] << " " << std::setw(10) << m[7] << " " << std::setw(10) << m[11] <<  " " << std::setw(10) << m[15] << "]\n";
+        os << std::resetiosflags(std::ios_base::fixed | std::ios_base::floatfield);
+        return os;
+    }
 
 	// yhc added
-	Matrix4& perspective(float fov, float aspect, float zNear, float zFar); // Set the matrix as a projection matrix
+	Matrix4T& perspective(T fov, T aspect, T zNear, T zFar); // Set the matrix as a projection matrix
 
 protected:
 
 private:
-    float       getCofactor(float m0, float m1, float m2,
-                            float m3, float m4, float m5,
-                            float m6, float m7, float m8) const;
+    // leaves m unset, for the SIMD products that write all of it
+    struct Uninitialized {};
+    explicit Matrix4T(Uninitialized) {}
+
+    constexpr T getCofactor(T m0, T m1, T m2,
+                            T m3, T m4, T m5,
+                            T m6, T m7, T m8) const;
 
-    float m[16];
-    float tm[16];                                       // transpose m
+    T m[16];                                            // set by every constexpr constructor
+
+    // transpose of m, written by getTranspose() only. The initialised byte
+    // satisfies the constexpr constructors without a run time fill of tm.
+    union
+    {
+        T tm[16];
+        char mTransposeUnset = 0;
+    };
 
 };
 
 
 
+typedef Matrix2T<float>     Matrix2;
+typedef Matrix3T<float>     Matrix3;
+typedef Matrix4T<float>     Matrix4;
+typedef Matrix2T<double>    Matrix2d;
+typedef Matrix3T<double>    Matrix3d;
+typedef Matrix4T<double>    Matrix4d;
+
+
+
 // ========================================================================== //
 //  inline functions for Matrix2
 // ========================================================================== //
-inline Matrix2::Matrix2()
+template <typename T>
+constexpr Matrix2T<T>::Matrix2T()
 {
     // initially identity matrix
     identity();
@@ -245,70 +344,80 @@ inline Matrix2::Matrix2()
 
 
 
-inline Matrix2::Matrix2(const float src[4])
+template <typename T>
+constexpr Matrix2T<T>::Matrix2T(const T src[4])
 {
     set(src);
 }
 
 
 
-inline Matrix2::Matrix2(float m0, float m1, float m2, float m3)
+template <typename T>
+constexpr Matrix2T<T>::Matrix2T(T m0, T m1, T m2, T m3)
 {
     set(m0, m1, m2, m3);
 }
 
 
 
-inline void Matrix2::set(const float src[4])
+template <typename T>
+constexpr void Matrix2T<T>::set(const T src[4])
 {
     m[0] = src[0];  m[1] = src[1];  m[2] = src[2];  m[3] = src[3];
 }
 
 
 
-inline void Matrix2::set(float m0, float m1, float m2, float m3)
+template <typename T>
+constexpr void Matrix2T<T>::set(T m0, T m1, T m2, T m3)
 {
     m[0]= m0;  m[1] = m1;  m[2] = m2;  m[3]= m3;
 }
 
 
 
-inline void Matrix2::setRow(int index, const float row[2])
+template <typename T>
+constexpr void Matrix2T<T>::setRow(int index, const T row[2])
 {
     m[index] = row[0];  m[index + 2] = row[1];
 }
 
 
 
-inline void Matrix2::setRow(int index, const Vector2& v)
+template <typename T>
+constexpr void Matrix2T<T>::setRow(int index, const Vector2T<T>& v)
 {
     m[index] = v.x;  m[index + 2] = v.y;
 }
 
 
 
-inline void Matrix2::setColumn(int index, const float col[2])
+template <typename T>
+constexpr void Matrix2T<T>::setColumn(int index, const T col[2])
 {
     m[index*2] = col[0];  m[index*2 + 1] = col[1];
 }
 
 
 
-inline void Matrix2::setColumn(int index, const Vector2& v)
+template <typename T>
+constexpr void Matrix2T<T>::setColumn(int index, const Vector2T<T>& v)
 {
     m[index*2] = v.x;  m[index*2 + 1] = v.y;
 }
 
 
 
-inline const float* Matrix2::get() const
+template <typename T>
+constexpr const T* Matrix2T<T>::get() const
 {
     return m;
 }
 
 
 
-inline Matrix2& Matrix2::identity()
+template <typename T>
+constexpr Matrix2T<T>& Matrix2T<T>::identity()
 {
     m[0] = m[3] = 1.0f;
     m[1] = m[2] = 0.0f;
@@ -317,21 +426,43 @@ inline Matrix2& Matrix2::identity()
 
 
 
-inline Matrix2 Matrix2::operator+(const Matrix2& rhs) const
+// transpose 2x2 matrix
+template <typename T>
+constexpr Matrix2T<T>& Matrix2T<T>::transpose()
 {
-    return Matrix2(m[0]+rhs[0], m[1]+rhs[1], m[2]+rhs[2], m[3]+rhs[3]);
+    T tmp = m[1];  m[1] = m[2];  m[2] = tmp;
+    return *this;
 }
 
 
 
-inline Matrix2 Matrix2::operator-(const Matrix2& rhs) const
+// return the determinant of 2x2 matrix
+template <typename T>
+constexpr T Matrix2T<T>::getDeterminant() const
 {
-    return Matrix2(m[0]-rhs[0], m[1]-rhs[1], m[2]-rhs[2], m[3]-rhs[3]);
+    return m[0] * m[3] - m[1] * m[2];
 }
 
 
 
-inline Matrix2& Matrix2::operator+=(const Matrix2& rhs)
+template <typename T>
+constexpr Matrix2T<T> Matrix2T<T>::operator+(const Matrix2T<T>& rhs) const
+{
+    return Matrix2T<T>(m[0]+rhs[0], m[1]+rhs[1], m[2]+rhs[2], m[3]+rhs[3]);
+}
+
+
+
+template <typename T>
+constexpr Matrix2T<T> Matrix2T<T>::operator-(const Matrix2T<T>& rhs) const
+{
+    return Matrix2T<T>(m[0]-rhs[0], m[1]-rhs[1], m[2]-rhs[2], m[3]-rhs[3]);
+}
+
+
+
+template <typename T>
+constexpr Matrix2T<T>& Matrix2T<T>::operator+=(const Matrix2T<T>& rhs)
 {
     m[0] += rhs[0];  m[1] += rhs[1];  m[2] += rhs[2];  m[3] += rhs[3];
     return *this;
@@ -339,7 +470,8 @@ inline Matrix2& Matrix2::operator+=(const Matrix2& rhs)
 
 
 
-inline Matrix2& Matrix2::operator-=(const Matrix2& rhs)
+template <typename T>
+constexpr Matrix2T<T>& Matrix2T<T>::operator-=(const Matrix2T<T>& rhs)
 {
     m[0] -= rhs[0];  m[1] -= rhs[1];  m[2] -= rhs[2];  m[3] -= rhs[3];
     return *this;
@@ -347,22 +479,25 @@ inline Matrix2& Matrix2::operator-=(const Matrix2& rhs)
 
 
 
-inline Vector2 Matrix2::operator*(const Vector2& rhs) const
+template <typename T>
+constexpr Vector2T<T> Matrix2T<T>::operator*(const Vector2T<T>& rhs) const
 {
-    return Vector2(m[0]*rhs.x + m[2]*rhs.y,  m[1]*rhs.x + m[3]*rhs.y);
+    return Vector2T<T>(m[0]*rhs.x + m[2]*rhs.y,  m[1]*rhs.x + m[3]*rhs.y);
 }
 
 
 
-inline Matrix2 Matrix2::operator*(const Matrix2& rhs) const
+template <typename T>
+constexpr Matrix2T<T> Matrix2T<T>::operator*(const Matrix2T<T>& rhs) const
 {
-    return Matrix2(m[0]*rhs[0] + m[2]*rhs[1],  m[1]*rhs[0] + m[3]*rhs[1],
-                   m[0]*rhs[2] + m[2]*rhs[3],  m[1]*rhs[2] + m[3]*rhs[3]);
+    return Matrix2T<T>(m[0]*rhs[0] + m[2]*rhs[1],  m[1]*rhs[0] + m[3]*rhs[1],
+                       m[0]*rhs[2] + m[2]*rhs[3],  m[1]*rhs[2] + m[3]*rhs[3]);
 }
 
 
 
-inline Matrix2& Matrix2::operator*=(const Matrix2& rhs)
+template <typename T>
+constexpr Matrix2T<T>& Matrix2T<T>::operator*=(const Matrix2T<T>& rhs)
 {
     *this = *this * rhs;
     return *this;
@@ -370,63 +505,44 @@ inline Matrix2& Matrix2::operator*=(const Matrix2& rhs)
 
 
 
-inline bool Matrix2::operator==(const Matrix2& rhs) const
+template <typename T>
+constexpr bool Matrix2T<T>::operator==(const Matrix2T<T>& rhs) const
 {
     return (m[0] == rhs[0]) && (m[1] == rhs[1]) && (m[2] == rhs[2]) && (m[3] == rhs[3]);
 }
 
 
 
-inline bool Matrix2::operator!=(const Matrix2& rhs) const
+template <typename T>
+constexpr bool Matrix2T<T>::operator!=(const Matrix2T<T>& rhs) const
 {
     return (m[0] != rhs[0]) || (m[1] != rhs[1]) || (m[2] != rhs[2]) || (m[3] != rhs[3]);
 }
 
 
 
-inline float Matrix2::operator[](int index) const
+template <typename T>
+constexpr T Matrix2T<T>::operator[](int index) const
 {
     return m[index];
 }
 
 
 
-inline float& Matrix2::operator[](int index)
+template <typename T>
+constexpr T& Matrix2T<T>::operator[](int index)
 {
     return m[index];
 }
 
 
 
-inline Matrix2 operator-(const Matrix2& rhs)
-{
-    return Matrix2(-rhs[0], -rhs[1], -rhs[2], -rhs[3]);
-}
 
 
 
-inline Matrix2 operator*(float s, const Matrix2& rhs)
-{
-    return Matrix2(s*rhs[0], s*rhs[1], s*rhs[2], s*rhs[3]);
-}
-
 
 
-inline Vector2 operator*(const Vector2& v, const Matrix2& rhs)
-{
-    return Vector2(v.x*rhs[0] + v.y*rhs[1],  v.x*rhs[2] + v.y*rhs[3]);
-}
 
-
-
-inline std::ostream& operator<<(std::ostream& os, const Matrix2& m)
-{
-    os << std::fixed << std::setprecision(5);
-    os << "[" << std::setw(10) << m[0] << " " << std::setw(10) << m[2] << "]\n"
-       << "[" << std::setw(10) << m[1] << " " << std::setw(10) << m[3] << "]\n";
-    os << std::resetiosflags(std::ios_base::fixed | std::ios_base::floatfield);
-    return os;
-}
 // END OF MATRIX2 INLINE //////////////////////////////////////////////////////
 
 
@@ -435,7 +551,8 @@ inline std::ostream& operator<<(std::ostream& os, const Matrix2& m)
 // ========================================================================== //
 //  inline functions for Matrix3
 // ========================================================================== //
-inline Matrix3::Matrix3()
+template <typename T>
+constexpr Matrix3T<T>::Matrix3T()
 {
     // initially identity matrix
     identity();
@@ -443,23 +560,26 @@ inline Matrix3::Matrix3()
 
 
 
-inline Matrix3::Matrix3(const float src[9])
+template <typename T>
+constexpr Matrix3T<T>::Matrix3T(const T src[9])
 {
     set(src);
 }
 
 
 
-inline Matrix3::Matrix3(float m0, float m1, float m2,
-                        float m3, float m4, float m5,
-                        float m6, float m7, float m8)
+template <typename T>
+constexpr Matrix3T<T>::Matrix3T(T m0, T m1, T m2,
+                                T m3, T m4, T m5,
+                                T m6, T m7, T m8)
 {
     set(m0, m1, m2,  m3, m4, m5,  m6, m7, m8);
 }
 
 
 
-inline void Matrix3::set(const float src[9])
+template <typename T>
+constexpr void Matrix3T<T>::set(const T src[9])
 {
     m[0] = src[0];  m[1] = src[1];  m[2] = src[2];
     m[3] = src[3];  m[4] = src[4];  m[5] = src[5];
@@ -468,9 +588,10 @@ inline void Matrix3::set(const float src[9])
 
 
 
-inline void Matrix3::set(float m0, float m1, float m2,
-                         float m3, float m4, float m5,
-                         float m6, float m7, float m8)
+template <typename T>
+constexpr void Matrix3T<T>::set(T m0, T m1, T m2,
+                                T m3, T m4, T m5,
+                                T m6, T m7, T m8)
 {
     m[0] = m0;  m[1] = m1;  m[2] = m2;
     m[3] = m3;  m[4] = m4;  m[5] = m5;
@@ -479,42 +600,48 @@ inline void Matrix3::set(float m0, float m1, float m2,
 
 
 
-inline void Matrix3::setRow(int index, const float row[3])
+template <typename T>
+constexpr void Matrix3T<T>::setRow(int index, const T row[3])
 {
     m[index] = row[0];  m[index + 3] = row[1];  m[index + 6] = row[2];
 }
 
 
 
-inline void Matrix3::setRow(int index, const Vector3& v)
+template <typename T>
+constexpr void Matrix3T<T>::setRow(int index, const Vector3T<T>& v)
 {
     m[index] = v.x;  m[index + 3] = v.y;  m[index + 6] = v.z;
 }
 
 
 
-inline void Matrix3::setColumn(int index, const float col[3])
+template <typename T>
+constexpr void Matrix3T<T>::setColumn(int index, const T col[3])
 {
     m[index*3] = col[0];  m[index*3 + 1] = col[1];  m[index*3 + 2] = col[2];
 }
 
 
 
-inline void Matrix3::setColumn(int index, const Vector3& v)
+template <typename T>
+constexpr void Matrix3T<T>::setColumn(int index, const Vector3T<T>& v)
 {
     m[index*3] = v.x;  m[index*3 + 1] = v.y;  m[index*3 + 2] = v.z;
 }
 
 
 
-inline const float* Matrix3::get() const
+template <typename T>
+constexpr const T* Matrix3T<T>::get() const
 {
     return m;
 }
 
 
 
-inline Matrix3& Matrix3::identity()
+template <typename T>
+constexpr Matrix3T<T>& Matrix3T<T>::identity()
 {
     m[0] = m[4] = m[8] = 1.0f;
     m[1] = m[2] = m[3] = m[5] = m[6] = m[7] = 0.0f;
@@ -523,25 +650,53 @@ inline Matrix3& Matrix3::identity()
 
 
 
-inline Matrix3 Matrix3::operator+(const Matrix3& rhs) const
+// transpose 3x3 matrix
+template <typename T>
+constexpr Matrix3T<T>& Matrix3T<T>::transpose()
+{
+    T tmp = 0.0f;
+    tmp = m[1];  m[1] = m[3];  m[3] = tmp;
+    tmp = m[2];  m[2] = m[6];  m[6] = tmp;
+    tmp = m[5];  m[5] = m[7];  m[7] = tmp;
+
+    return *this;
+}
+
+
+
+// return determinant of 3x3 matrix
+template <typename T>
+constexpr T Matrix3T<T>::getDeterminant() const
 {
-    return Matrix3(m[0]+rhs[0], m[1]+rhs[1], m[2]+rhs[2],
-                   m[3]+rhs[3], m[4]+rhs[4], m[5]+rhs[5],
-                   m[6]+rhs[6], m[7]+rhs[7], m[8]+rhs[8]);
+    return m[0] * (m[4] * m[8] - m[5] * m[7]) -
+           m[1] * (m[3] * m[8] - m[5] * m[6]) +
+           m[2] * (m[3] * m[7] - m[4] * m[6]);
 }
 
 
 
-inline Matrix3 Matrix3::operator-(const Matrix3& rhs) const
+template <typename T>
+constexpr Matrix3T<T> Matrix3T<T>::operator+(const Matrix3T<T>& rhs) const
 {
-    return Matrix3(m[0]-rhs[0], m[1]-rhs[1], m[2]-rhs[2],
-                   m[3]-rhs[3], m[4]-rhs[4], m[5]-rhs[5],
-                   m[6]-rhs[6], m[7]-rhs[7], m[8]-rhs[8]);
+    return Matrix3T<T>(m[0]+rhs[0], m[1]+rhs[1], m[2]+rhs[2],
+                       m[3]+rhs[3], m[4]+rhs[4], m[5]+rhs[5],
+                       m[6]+rhs[6], m[7]+rhs[7], m[8]+rhs[8]);
 }
 
 
 
-inline Matrix3& Matrix3::operator+=(const Matrix3& rhs)
+template <typename T>
+constexpr Matrix3T<T> Matrix3T<T>::operator-(const Matrix3T<T>& rhs) const
+{
+    return Matrix3T<T>(m[0]-rhs[0], m[1]-rhs[1], m[2]-rhs[2],
+                       m[3]-rhs[3], m[4]-rhs[4], m[5]-rhs[5],
+                       m[6]-rhs[6], m[7]-rhs[7], m[8]-rhs[8]);
+}
+
+
+
+template <typename T>
+constexpr Matrix3T<T>& Matrix3T<T>::operator+=(const Matrix3T<T>& rhs)
 {
     m[0] += rhs[0];  m[1] += rhs[1];  m[2] += rhs[2];
     m[3] += rhs[3];  m[4] += rhs[4];  m[5] += rhs[5];
@@ -551,7 +706,8 @@ inline Matrix3& Matrix3::operator+=(const Matrix3& rhs)
 
 
 
-inline Matrix3& Matrix3::operator-=(const Matrix3& rhs)
+template <typename T>
+constexpr Matrix3T<T>& Matrix3T<T>::operator-=(const Matrix3T<T>& rhs)
 {
     m[0] -= rhs[0];  m[1] -= rhs[1];  m[2] -= rhs[2];
     m[3] -= rhs[3];  m[4] -= rhs[4];  m[5] -= rhs[5];
@@ -561,25 +717,28 @@ inline Matrix3& Matrix3::operator-=(const Matrix3& rhs)
 
 
 
-inline Vector3 Matrix3::operator*(const Vector3& rhs) const
+template <typename T>
+constexpr Vector3T<T> Matrix3T<T>::operator*(const Vector3T<T>& rhs) const
 {
-    return Vector3(m[0]*rhs.x + m[3]*rhs.y + m[6]*rhs.z,
-                   m[1]*rhs.x + m[4]*rhs.y + m[7]*rhs.z,
-                   m[2]*rhs.x + m[5]*rhs.y + m[8]*rhs.z);
+    return Vector3T<T>(m[0]*rhs.x + m[3]*rhs.y + m[6]*rhs.z,
+                       m[1]*rhs.x + m[4]*rhs.y + m[7]*rhs.z,
+                       m[2]*rhs.x + m[5]*rhs.y + m[8]*rhs.z);
 }
 
 
 
-inline Matrix3 Matrix3::operator*(const Matrix3& rhs) const
+template <typename T>
+constexpr Matrix3T<T> Matrix3T<T>::operator*(const Matrix3T<T>& rhs) const
 {
-    return Matrix3(m[0]*rhs[0] + m[3]*rhs[1] + m[6]*rhs[2],  m[1]*rhs[0] + m[4]*rhs[1] + m[7]*rhs[2],  m[2]*rhs[0] + m[5]*rhs[1] + m[8]*rhs[2],
-                   m[0]*rhs[3] + m[3]*rhs[4] + m[6]*rhs[5],  m[1]*rhs[3] + m[4]*rhs[4] + m[7]*rhs[5],  m[2]*rhs[3] + m[5]*rhs[4] + m[8]*rhs[5],
-                   m[0]*rhs[6] + m[3]*rhs[7] + m[6]*rhs[8],  m[1]*rhs[6] + m[4]*rhs[7] + m[7]*rhs[8],  m[2]*rhs[6] + m[5]*rhs[7] + m[8]*rhs[8]);
+    return Matrix3T<T>(m[0]*rhs[0] + m[3]*rhs[1] + m[6]*rhs[2],  m[1]*rhs[0] + m[4]*rhs[1] + m[7]*rhs[2],  m[2]*rhs[0] + m[5]*rhs[1] + m[8]*rhs[2],
+                       m[0]*rhs[3] + m[3]*rhs[4] + m[6]*rhs[5],  m[1]*rhs[3] + m[4]*rhs[4] + m[7]*rhs[5],  m[2]*rhs[3] + m[5]*rhs[4] + m[8]*rhs[5],
+                       m[0]*rhs[6] + m[3]*rhs[7] + m[6]*rhs[8],  m[1]*rhs[6] + m[4]*rhs[7] + m[7]*rhs[8],  m[2]*rhs[6] + m[5]*rhs[7] + m[8]*rhs[8]);
 }
 
 
 
-inline Matrix3& Matrix3::operator*=(const Matrix3& rhs)
+template <typename T>
+constexpr Matrix3T<T>& Matrix3T<T>::operator*=(const Matrix3T<T>& rhs)
 {
     *this = *this * rhs;
     return *this;
@@ -587,7 +746,8 @@ inline Matrix3& Matrix3::operator*=(const Matrix3& rhs)
 
 
 
-inline bool Matrix3::operator==(const Matrix3& rhs) const
+template <typename T>
+constexpr bool Matrix3T<T>::operator==(const Matrix3T<T>& rhs) const
 {
     return (m[0] == rhs[0]) && (m[1] == rhs[1]) && (m[2] == rhs[2]) &&
            (m[3] == rhs[3]) && (m[4] == rhs[4]) && (m[5] == rhs[5]) &&
@@ -596,7 +756,8 @@ inline bool Matrix3::operator==(const Matrix3& rhs) const
 
 
 
-inline bool Matrix3::operator!=(const Matrix3& rhs) const
+template <typename T>
+constexpr bool Matrix3T<T>::operator!=(const Matrix3T<T>& rhs) const
 {
     return (m[0] != rhs[0]) || (m[1] != rhs[1]) || (m[2] != rhs[2]) ||
            (m[3] != rhs[3]) || (m[4] != rhs[4]) || (m[5] != rhs[5]) ||
@@ -605,50 +766,28 @@ inline bool Matrix3::operator!=(const Matrix3& rhs) const
 
 
 
-inline float Matrix3::operator[](int index) const
+template <typename T>
+constexpr T Matrix3T<T>::operator[](int index) const
 {
     return m[index];
 }
 
 
 
-inline float& Matrix3::operator[](int index)
+template <typename T>
+constexpr T& Matrix3T<T>::operator[](int index)
 {
     return m[index];
 }
 
 
 
-inline Matrix3 operator-(const Matrix3& rhs)
-{
-    return Matrix3(-rhs[0], -rhs[1], -rhs[2], -rhs[3], -rhs[4], -rhs[5], -rhs[6], -rhs[7], -rhs[8]);
-}
-
-
-
-inline Matrix3 operator*(float s, const Matrix3& rhs)
-{
-    return Matrix3(s*rhs[0], s*rhs[1], s*rhs[2], s*rhs[3], s*rhs[4], s*rhs[5], s*rhs[6], s*rhs[7], s*rhs[8]);
-}
 
 
 
-inline Vector3 operator*(const Vector3& v, const Matrix3& m)
-{
-    return Vector3(v.x*m[0] + v.y*m[1] + v.z*m[2],  v.x*m[3] + v.y*m[4] + v.z*m[5],  v.x*m[6] + v.y*m[7] + v.z*m[8]);
-}
 
 
 
-inline std::ostream& operator<<(std::ostream& os, const Matrix3& m)
-{
-    os << std::fixed << std::setprecision(5);
-    os << "[" << std::setw(10) << m[0] << " " << std::setw(10) << m[3] << " " << std::setw(10) << m[6] << "]\n"
-       << "[" << std::setw(10) << m[1] << " " << std::setw(10) << m[4] << " " << std::setw(10) << m[7] << "]\n"
-       << "[" << std::setw(10) << m[2] << " " << std::setw(10) << m[5] << " " << std::setw(10) << m[8] << "]\n";
-    os << std::resetiosflags(std::ios_base::fixed | std::ios_base::floatfield);
-    return os;
-}
 // END OF MATRIX3 INLINE //////////////////////////////////////////////////////
 
 
@@ -657,32 +796,37 @@ inline std::ostream& operator<<(std::ostream& os, const Matrix3& m)
 // ========================================================================== //
 //  inline functions for Matrix4
 // ========================================================================== //
-inline Matrix4::Matrix4()
+template <typename T>
+constexpr Matrix4T<T>::Matrix4T()
+: m{ 1, 0, 0, 0,  0, 1, 0, 0,  0, 0, 1, 0,  0, 0, 0, 1 }
 {
     // initially identity matrix
-    identity();
 }
 
 
 
-inline Matrix4::Matrix4(const float src[16])
+template <typename T>
+constexpr Matrix4T<T>::Matrix4T(const T src[16])
+: m{ src[0], src[1], src[2],  src[3],  src[4],  src[5],  src[6],  src[7],
+     src[8], src[9], src[10], src[11], src[12], src[13], src[14], src[15] }
 {
-    set(src);
 }
 
 
 
-inline Matrix4::Matrix4(float m00, float m01, float m02, float m03,
-                        float m04, float m05, float m06, float m07,
-                        float m08, float m09, float m10, float m11,
-                        float m12, float m13, float m14, float m15)
+template <typename T>
+constexpr Matrix4T<T>::Matrix4T(T m00, T m01, T m02, T m03,
+                                T m04, T m05, T m06, T m07,
+                                T m08, T m09, T m10, T m11,
+                                T m12, T m13, T m14, T m15)
+: m{ m00, m01, m02, m03,  m04, m05, m06, m07,  m08, m09, m10, m11,  m12, m13, m14, m15 }
 {
-    set(m00, m01, m02, m03,  m04, m05, m06, m07,  m08, m09, m10, m11,  m12, m13, m14, m15);
 }
 
 
 
-inline void Matrix4::set(const float src[16])
+template <typename T>
+constexpr void Matrix4T<T>::set(const T src[16])
 {
     m[0] = src[0];  m[1] = src[1];  m[2] = src[2];  m[3] = src[3];
     m[4] = src[4];  m[5] = src[5];  m[6] = src[6];  m[7] = src[7];
@@ -692,10 +836,11 @@ inline void Matrix4::set(const float src[16])
 
 
 
-inline void Matrix4::set(float m00, float m01, float m02, float m03,
-                         float m04, float m05, float m06, float m07,
-                         float m08, float m09, float m10, float m11,
-                         float m12, float m13, float m14, float m15)
+template <typename T>
+constexpr void Matrix4T<T>::set(T m00, T m01, T m02, T m03,
+                                T m04, T m05, T m06, T m07,
+                                T m08, T m09, T m10, T m11,
+                                T m12, T m13, T m14, T m15)
 {
     m[0] = m00;  m[1] = m01;  m[2] = m02;  m[3] = m03;
     m[4] = m04;  m[5] = m05;  m[6] = m06;  m[7] = m07;
@@ -705,56 +850,64 @@ inline void Matrix4::set(float m00, float m01, float m02, float m03,
 
 
 
-inline void Matrix4::setRow(int index, const float row[4])
+template <typename T>
+constexpr void Matrix4T<T>::setRow(int index, const T row[4])
 {
     m[index] = row[0];  m[index + 4] = row[1];  m[index + 8] = row[2];  m[index + 12] = row[3];
 }
 
 
 
-inline void Matrix4::setRow(int index, const Vector4& v)
+template <typename T>
+constexpr void Matrix4T<T>::setRow(int index, const Vector4T<T>& v)
 {
     m[index] = v.x;  m[index + 4] = v.y;  m[index + 8] = v.z;  m[index + 12] = v.w;
 }
 
 
 
-inline void Matrix4::setRow(int index, const Vector3& v)
+template <typename T>
+constexpr void Matrix4T<T>::setRow(int index, const Vector3T<T>& v)
 {
     m[index] = v.x;  m[index + 4] = v.y;  m[index + 8] = v.z;
 }
 
 
 
-inline void Matrix4::setColumn(int index, const float col[4])
+template <typename T>
+constexpr void Matrix4T<T>::setColumn(int index, const T col[4])
 {
     m[index*4] = col[0];  m[index*4 + 1] = col[1];  m[index*4 + 2] = col[2];  m[index*4 + 3] = col[3];
 }
 
 
 
-inline void Matrix4::setColumn(int index, const Vector4& v)
+template <typename T>
+constexpr void Matrix4T<T>::setColumn(int index, const Vector4T<T>& v)
 {
     m[index*4] = v.x;  m[index*4 + 1] = v.y;  m[index*4 + 2] = v.z;  m[index*4 + 3] = v.w;
 }
 
 
 
-inline void Matrix4::setColumn(int index, const Vector3& v)
+template <typename T>
+constexpr void Matrix4T<T>::setColumn(int index, const Vector3T<T>& v)
 {
     m[index*4] = v.x;  m[index*4 + 1] = v.y;  m[index*4 + 2] = v.z;
 }
 
 
 
-inline const float* Matrix4::get() const
+template <typename T>
+constexpr const T* Matrix4T<T>::get() const
 {
     return m;
 }
 
 
 
-inline const float* Matrix4::getTranspose()
+template <typename T>
+inline const T* Matrix4T<T>::getTranspose()
 {
     tm[0] = m[0];   tm[1] = m[4];   tm[2] = m[8];   tm[3] = m[12];
     tm[4] = m[1];   tm[5] = m[5];   tm[6] = m[9];   tm[7] = m[13];
@@ -765,7 +918,8 @@ inline const float* Matrix4::getTranspose()
 
 
 
-inline Matrix4& Matrix4::identity()
+template <typename T>
+constexpr Matrix4T<T>& Matrix4T<T>::identity()
 {
     m[0] = m[5] = m[10] = m[15] = 1.0f;
     m[1] = m[2] = m[3] = m[4] = m[6] = m[7] = m[8] = m[9] = m[11] = m[12] = m[13] = m[14] = 0.0f;
@@ -774,78 +928,273 @@ inline Matrix4& Matrix4::identity()
 
 
 
-inline Matrix4 Matrix4::operator+(const Matrix4& rhs) const
+// transpose 4x4 matrix
+template <typename T>
+constexpr Matrix4T<T>& Matrix4T<T>::transpose()
 {
-    return Matrix4(m[0]+rhs[0],   m[1]+rhs[1],   m[2]+rhs[2],   m[3]+rhs[3],
-                   m[4]+rhs[4],   m[5]+rhs[5],   m[6]+rhs[6],   m[7]+rhs[7],
-                   m[8]+rhs[8],   m[9]+rhs[9],   m[10]+rhs[10], m[11]+rhs[11],
-                   m[12]+rhs[12], m[13]+rhs[13], m[14]+rhs[14], m[15]+rhs[15]);
+    T tmp = 0.0f;
+    tmp = m[1];  m[1] = m[4];  m[4] = tmp;
+    tmp = m[2];  m[2] = m[8];  m[8] = tmp;
+    tmp = m[3];  m[3] = m[12];  m[12] = tmp;
+    tmp = m[6];  m[6] = m[9];  m[9] = tmp;
+    tmp = m[7];  m[7] = m[13];  m[13] = tmp;
+    tmp = m[11];  m[11] = m[14];  m[14] = tmp;
+
+    return *this;
 }
 
 
 
-inline Matrix4 Matrix4::operator-(const Matrix4& rhs) const
+// compute the inverse of 4x4 Euclidean transformation matrix
+//
+// Euclidean transformation is translation, rotation, and reflection.
+// With Euclidean transform, only the position and orientation of the object
+// will be changed. Euclidean transform does not change the shape of an object
+// (no scaling). Length and angle are reserved.
+//
+// Use inverseAffine() if the matrix has scale and shear transformation.
+//
+// M = [ R | T ]
+//     [ --+-- ]    (R denotes 3x3 rotation/reflection matrix)
+//     [ 0 | 1 ]    (T denotes 1x3 translation matrix)
+//
+// y = M*x  ->  y = R*x + T  ->  x = R^-1*(y - T)  ->  x = R^T*y - R^T*T
+// (R is orthogonal,  R^-1 = R^T)
+//
+//  [ R | T ]-1    [ R^T | -R^T * T ]    (R denotes 3x3 rotation matrix)
+//  [ --+-- ]   =  [ ----+--------- ]    (T denotes 1x3 translation)
+//  [ 0 | 1 ]      [  0  |     1    ]    (R^T denotes R-transpose)
+template <typename T>
+constexpr Matrix4T<T>& Matrix4T<T>::invertEuclidean()
+{
+    // transpose 3x3 rotation matrix part
+    // | R^T | 0 |
+    // | ----+-- |
+    // |  0  | 1 |
+    T tmp = 0.0f;
+    tmp = m[1];  m[1] = m[4];  m[4] = tmp;
+    tmp = m[2];  m[2] = m[8];  m[8] = tmp;
+    tmp = m[6];  m[6] = m[9];  m[9] = tmp;
+
+    // compute translation part -R^T * T
+    // | 0 | -R^T x |
+    // | --+------- |
+    // | 0 |   0    |
+    T x = m[12];
+    T y = m[13];
+    T z = m[14];
+    m[12] = -(m[0] * x + m[4] * y + m[8] * z);
+    m[13] = -(m[1] * x + m[5] * y + m[9] * z);
+    m[14] = -(m[2] * x + m[6] * y + m[10]* z);
+
+    // last row should be unchanged (0,0,0,1)
+
+    return *this;
+}
+
+
+
+// return determinant of 4x4 matrix
+template <typename T>
+constexpr T Matrix4T<T>::getDeterminant() const
 {
-    return Matrix4(m[0]-rhs[0],   m[1]-rhs[1],   m[2]-rhs[2],   m[3]-rhs[3],
-                   m[4]-rhs[4],   m[5]-rhs[5],   m[6]-rhs[6],   m[7]-rhs[7],
-                   m[8]-rhs[8],   m[9]-rhs[9],   m[10]-rhs[10], m[11]-rhs[11],
-                   m[12]-rhs[12], m[13]-rhs[13], m[14]-rhs[14], m[15]-rhs[15]);
+    return m[0] * getCofactor(m[5],m[6],m[7], m[9],m[10],m[11], m[13],m[14],m[15]) -
+           m[1] * getCofactor(m[4],m[6],m[7], m[8],m[10],m[11], m[12],m[14],m[15]) +
+           m[2] * getCofactor(m[4],m[5],m[7], m[8],m[9], m[11], m[12],m[13],m[15]) -
+           m[3] * getCofactor(m[4],m[5],m[6], m[8],m[9], m[10], m[12],m[13],m[14]);
 }
 
 
 
-inline Matrix4& Matrix4::operator+=(const Matrix4& rhs)
+// compute cofactor of 3x3 minor matrix without sign
+// input params are 9 elements of the minor matrix
+// NOTE: The caller must know its sign.
+template <typename T>
+constexpr T Matrix4T<T>::getCofactor(T m0, T m1, T m2,
+                                     T m3, T m4, T m5,
+                                     T m6, T m7, T m8) const
 {
-    m[0] += rhs[0];   m[1] += rhs[1];   m[2] += rhs[2];   m[3] += rhs[3];
-    m[4] += rhs[4];   m[5] += rhs[5];   m[6] += rhs[6];   m[7] += rhs[7];
-    m[8] += rhs[8];   m[9] += rhs[9];   m[10]+= rhs[10];  m[11]+= rhs[11];
-    m[12]+= rhs[12];  m[13]+= rhs[13];  m[14]+= rhs[14];  m[15]+= rhs[15];
+    return m0 * (m4 * m8 - m5 * m7) -
+           m1 * (m3 * m8 - m5 * m6) +
+           m2 * (m3 * m7 - m4 * m6);
+}
+
+
+
+// translate this matrix by (x, y, z)
+template <typename T>
+constexpr Matrix4T<T>& Matrix4T<T>::translate(const Vector3T<T>& v)
+{
+    return translate(v.x, v.y, v.z);
+}
+
+template <typename T>
+constexpr Matrix4T<T>& Matrix4T<T>::translate(T x, T y, T z)
+{
+    m[0] += m[3] * x;   m[4] += m[7] * x;   m[8] += m[11]* x;   m[12]+= m[15]* x;
+    m[1] += m[3] * y;   m[5] += m[7] * y;   m[9] += m[11]* y;   m[13]+= m[15]* y;
+    m[2] += m[3] * z;   m[6] += m[7] * z;   m[10]+= m[11]* z;   m[14]+= m[15]* z;
+
     return *this;
 }
 
 
 
-inline Matrix4& Matrix4::operator-=(const Matrix4& rhs)
+// uniform scale
+template <typename T>
+constexpr Matrix4T<T>& Matrix4T<T>::scale(T s)
 {
-    m[0] -= rhs[0];   m[1] -= rhs[1];   m[2] -= rhs[2];   m[3] -= rhs[3];
-    m[4] -= rhs[4];   m[5] -= rhs[5];   m[6] -= rhs[6];   m[7] -= rhs[7];
-    m[8] -= rhs[8];   m[9] -= rhs[9];   m[10]-= rhs[10];  m[11]-= rhs[11];
-    m[12]-= rhs[12];  m[13]-= rhs[13];  m[14]-= rhs[14];  m[15]-= rhs[15];
+    return scale(s, s, s);
+}
+
+template <typename T>
+constexpr Matrix4T<T>& Matrix4T<T>::scale(T x, T y, T z)
+{
+    m[0] *= x;   m[4] *= x;   m[8] *= x;   m[12] *= x;
+    m[1] *= y;   m[5] *= y;   m[9] *= y;   m[13] *= y;
+    m[2] *= z;   m[6] *= z;   m[10]*= z;   m[14] *= z;
     return *this;
 }
 
 
 
-inline Vector4 Matrix4::operator*(const Vector4& rhs) const
+template <typename T>
+constexpr Matrix4T<T> Matrix4T<T>::operator+(const Matrix4T<T>& rhs) const
 {
-    return Vector4(m[0]*rhs.x + m[4]*rhs.y + m[8]*rhs.z  + m[12]*rhs.w,
-                   m[1]*rhs.x + m[5]*rhs.y + m[9]*rhs.z  + m[13]*rhs.w,
-                   m[2]*rhs.x + m[6]*rhs.y + m[10]*rhs.z + m[14]*rhs.w,
-                   m[3]*rhs.x + m[7]*rhs.y + m[11]*rhs.z + m[15]*rhs.w);
+    return Matrix4T<T>(m[0]+rhs[0],   m[1]+rhs[1],   m[2]+rhs[2],   m[3]+rhs[3],
+                       m[4]+rhs[4],   m[5]+rhs[5],   m[6]+rhs[6],   m[7]+rhs[7],
+                       m[8]+rhs[8],   m[9]+rhs[9],   m[10]+rhs[10], m[11]+rhs[11],
+                       m[12]+rhs[12], m[13]+rhs[13], m[14]+rhs[14], m[15]+rhs[15]);
 }
 
 
 
-inline Vector3 Matrix4::operator*(const Vector3& rhs) const
+template <typename T>
+constexpr Matrix4T<T> Matrix4T<T>::operator-(const Matrix4T<T>& rhs) const
 {
-    return Vector3(m[0]*rhs.x + m[4]*rhs.y + m[8]*rhs.z + m[12],
-                   m[1]*rhs.x + m[5]*rhs.y + m[9]*rhs.z + m[13],
-                   m[2]*rhs.x + m[6]*rhs.y + m[10]*rhs.z+ m[14]);
+    return Matrix4T<T>(m[0]-rhs[0],   m[1]-rhs[1],   m[2]-rhs[2],   m[3]-rhs[3],
+                       m[4]-rhs[4],   m[5]-rhs[5],   m[6]-rhs[6],   m[7]-rhs[7],
+                       m[8]-rhs[8],   m[9]-rhs[9],   m[10]-rhs[10], m[11]-rhs[11],
+                       m[12]-rhs[12], m[13]-rhs[13], m[14]-rhs[14], m[15]-rhs[15]);
 }
 
 
 
-inline Matrix4 Matrix4::operator*(const Matrix4& n) const
+template <typename T>
+constexpr Matrix4T<T>& Matrix4T<T>::operator+=(const Matrix4T<T>& rhs)
 {
-    return Matrix4(m[0]*n[0]  + m[4]*n[1]  + m[8]*n[2]  + m[12]*n[3],   m[1]*n[0]  + m[5]*n[1]  + m[9]*n[2]  + m[13]*n[3],   m[2]*n[0]  + m[6]*n[1]  + m[10]*n[2]  + m[14]*n[3],   m[3]*n[0]  + m[7]*n[1]  + m[11]*n[2]  + m[15]*n[3],
-                   m[0]*n[4]  + m[4]*n[5]  + m[8]*n[6]  + m[12]*n[7],   m[1]*n[4]  + m[5]*n[5]  + m[9]*n[6]  + m[13]*n[7],   m[2]*n[4]  + m[6]*n[5]  + m[10]*n[6]  + m[14]*n[7],   m[3]*n[4]  + m[7]*n[5]  + m[11]*n[6]  + m[15]*n[7],
-                   m[0]*n[8]  + m[4]*n[9]  + m[8]*n[10] + m[12]*n[11],  m[1]*n[8]  + m[5]*n[9]  + m[9]*n[10] + m[13]*n[11],  m[2]*n[8]  + m[6]*n[9]  + m[10]*n[10] + m[14]*n[11],  m[3]*n[8]  + m[7]*n[9]  + m[11]*n[10] + m[15]*n[11],
-                   m[0]*n[12] + m[4]*n[13] + m[8]*n[14] + m[12]*n[15],  m[1]*n[12] + m[5]*n[13] + m[9]*n[14] + m[13]*n[15],  m[2]*n[12] + m[6]*n[13] + m[10]*n[14] + m[14]*n[15],  m[3]*n[12] + m[7]*n[13] + m[11]*n[14] + m[15]*n[15]);
+    m[0] += rhs[0];   m[1] += rhs[1];   m[2] += rhs[2];   m[3] += rhs[3];
+    m[4] += rhs[4];   m[5] += rhs[5];   m[6] += rhs[6];   m[7] += rhs[7];
+    m[8] += rhs[8];   m[9] += rhs[9];   m[10]+= rhs[10];  m[11]+= rhs[11];
+    m[12]+= rhs[12];  m[13]+= rhs[13];  m[14]+= rhs[14];  m[15]+= rhs[15];
+    return *this;
 }
 
 
 
-inline Matrix4& Matrix4::operator*=(const Matrix4& rhs)
+template <typename T>
+constexpr Matrix4T<T>& Matrix4T<T>::operator-=(const Matrix4T<T>& rhs)
+{
+    m[0] -= rhs[0];   m[1] -= rhs[1];   m[2] -= rhs[2];   m[3] -= rhs[3];
+    m[4] -= rhs[4];   m[5] -= rhs[5];   m[6] -= rhs[6];   m[7] -= rhs[7];
+    m[8] -= rhs[8];   m[9] -= rhs[9];   m[10]-= rhs[10];  m[11]-= rhs[11];
+    m[12]-= rhs[12];  m[13]-= rhs[13];  m[14]-= rhs[14];  m[15]-= rhs[15];
+    return *this;
+}
+
+
+
+template <typename T>
+YUP_SIMD_CONSTEXPR Vector4T<T> Matrix4T<T>::operator*(const Vector4T<T>& rhs) const
+{
+#ifdef YUP_SIMD_SSE2
+    if constexpr (std::is_same<T, float>::value)
+    if (!YUP_IS_CONSTANT_EVALUATED())
+    {
+        // same operation order as the scalar code, so the results are identical
+        __m128 r = _mm_mul_ps(_mm_loadu_ps(&m[0]), _mm_set1_ps(rhs.x));
+        r = _mm_add_ps(r, _mm_mul_ps(_mm_loadu_ps(&m[4]),  _mm_set1_ps(rhs.y)));
+        r = _mm_add_ps(r, _mm_mul_ps(_mm_loadu_ps(&m[8]),  _mm_set1_ps(rhs.z)));
+        r = _mm_add_ps(r, _mm_mul_ps(_mm_loadu_ps(&m[12]), _mm_set1_ps(rhs.w)));
+
+        Vector4T<T> v;
+        _mm_storeu_ps(&v.x, r);
+        return v;
+    }
+#endif
+    return Vector4T<T>(m[0]*rhs.x + m[4]*rhs.y + m[8]*rhs.z  + m[12]*rhs.w,
+                       m[1]*rhs.x + m[5]*rhs.y + m[9]*rhs.z  + m[13]*rhs.w,
+                       m[2]*rhs.x + m[6]*rhs.y + m[10]*rhs.z + m[14]*rhs.w,
+                       m[3]*rhs.x + m[7]*rhs.y + m[11]*rhs.z + m[15]*rhs.w);
+}
+
+
+
+template <typename T>
+constexpr Vector3T<T> Matrix4T<T>::operator*(const Vector3T<T>& rhs) const
+{
+    return Vector3T<T>(m[0]*rhs.x + m[4]*rhs.y + m[8]*rhs.z + m[12],
+                       m[1]*rhs.x + m[5]*rhs.y + m[9]*rhs.z + m[13],
+                       m[2]*rhs.x + m[6]*rhs.y + m[10]*rhs.z+ m[14]);
+}
+
+
+
+template <typename T>
+YUP_SIMD_CONSTEXPR Matrix4T<T> Matrix4T<T>::operator*(const Matrix4T<T>& n) const
+{
+#if defined(YUP_SIMD_AVX)
+    if constexpr (std::is_same<T, float>::value)
+    if (!YUP_IS_CONSTANT_EVALUATED())
+    {
+        // two result columns per iteration, same operation order as the scalar code
+        Matrix4T<T> r{ Uninitialized() };
+        const __m256 c0 = _mm256_broadcast_ps((const __m128 *)&m[0]);
+        const __m256 c1 = _mm256_broadcast_ps((const __m128 *)&m[4]);
+        const __m256 c2 = _mm256_broadcast_ps((const __m128 *)&m[8]);
+        const __m256 c3 = _mm256_broadcast_ps((const __m128 *)&m[12]);
+        for (int i = 0; i < 16; i += 8)
+        {
+            const __m256 b = _mm256_loadu_ps(&n.m[i]);
+            __m256 t = _mm256_mul_ps(c0, _mm256_permute_ps(b, 0x00));
+            t = _mm256_add_ps(t, _mm256_mul_ps(c1, _mm256_permute_ps(b, 0x55)));
+            t = _mm256_add_ps(t, _mm256_mul_ps(c2, _mm256_permute_ps(b, 0xAA)));
+            t = _mm256_add_ps(t, _mm256_mul_ps(c3, _mm256_permute_ps(b, 0xFF)));
+            _mm256_storeu_ps(&r.m[i], t);
+        }
+        return r;
+    }
+#elif defined(YUP_SIMD_SSE2)
+    if constexpr (std::is_same<T, float>::value)
+    if (!YUP_IS_CONSTANT_EVALUATED())
+    {
+        // one result column per iteration, same operation order as the scalar code
+        Matrix4T<T> r{ Uninitialized() };
+        const __m128 c0 = _mm_loadu_ps(&m[0]);
+        const __m128 c1 = _mm_loadu_ps(&m[4]);
+        const __m128 c2 = _mm_loadu_ps(&m[8]);
+        const __m128 c3 = _mm_loadu_ps(&m[12]);
+        for (int i = 0; i < 16; i += 4)
+        {
+            __m128 t = _mm_mul_ps(c0, _mm_set1_ps(n.m[i]));
+            t = _mm_add_ps(t, _mm_mul_ps(c1, _mm_set1_ps(n.m[i + 1])));
+            t = _mm_add_ps(t, _mm_mul_ps(c2, _mm_set1_ps(n.m[i + 2])));
+            t = _mm_add_ps(t, _mm_mul_ps(c3, _mm_set1_ps(n.m[i + 3])));
+            _mm_storeu_ps(&r.m[i], t);
+        }
+        return r;
+    }
+#endif
+    return Matrix4T<T>(m[0]*n[0]  + m[4]*n[1]  + m[8]*n[2]  + m[12]*n[3],   m[1]*n[0]  + m[5]*n[1]  + m[9]*n[2]  + m[13]*n[3],   m[2]*n[0]  + m[6]*n[1]  + m[10]*n[2]  + m[14]*n[3],   m[3]*n[0]  + m[7]*n[1]  + m[11]*n[2]  + m[15]*n[3],
+                       m[0]*n[4]  + m[4]*n[5]  + m[8]*n[6]  + m[12]*n[7],   m[1]*n[4]  + m[5]*n[5]  + m[9]*n[6]  + m[13]*n[7],   m[2]*n[4]  + m[6]*n[5]  + m[10]*n[6]  + m[14]*n[7],   m[3]*n[4]  + m[7]*n[5]  + m[11]*n[6]  + m[15]*n[7],
+                       m[0]*n[8]  + m[4]*n[9]  + m[8]*n[10] + m[12]*n[11],  m[1]*n[8]  + m[5]*n[9]  + m[9]*n[10] + m[13]*n[11],  m[2]*n[8]  + m[6]*n[9]  + m[10]*n[10] + m[14]*n[11],  m[3]*n[8]  + m[7]*n[9]  + m[11]*n[10] + m[15]*n[11],
+                       m[0]*n[12] + m[4]*n[13] + m[8]*n[14] + m[12]*n[15],  m[1]*n[12] + m[5]*n[13] + m[9]*n[14] + m[13]*n[15],  m[2]*n[12] + m[6]*n[13] + m[10]*n[14] + m[14]*n[15],  m[3]*n[12] + m[7]*n[13] + m[11]*n[14] + m[15]*n[15]);
+}
+
+
+
+template <typename T>
+YUP_SIMD_CONSTEXPR Matrix4T<T>& Matrix4T<T>::operator*=(const Matrix4T<T>& rhs)
 {
     *this = *this * rhs;
     return *this;
@@ -853,7 +1202,8 @@ inline Matrix4& Matrix4::operator*=(const Matrix4& rhs)
 
 
 
-inline bool Matrix4::operator==(const Matrix4& n) const
+template <typename T>
+constexpr bool Matrix4T<T>::operator==(const Matrix4T<T>& n) const
 {
     return (m[0] == n[0])  && (m[1] == n[1])  && (m[2] == n[2])  && (m[3] == n[3])  &&
            (m[4] == n[4])  && (m[5] == n[5])  && (m[6] == n[6])  && (m[7] == n[7])  &&
@@ -863,7 +1213,8 @@ inline bool Matrix4::operator==(const Matrix4& n) const
 
 
 
-inline bool Matrix4::operator!=(const Matrix4& n) const
+template <typename T>
+constexpr bool Matrix4T<T>::operator!=(const Matrix4T<T>& n) const
 {
     return (m[0] != n[0])  || (m[1] != n[1])  || (m[2] != n[2])  || (m[3] != n[3])  ||
            (m[4] != n[4])  || (m[5] != n[5])  || (m[6] != n[6])  || (m[7] != n[7])  ||
@@ -873,58 +1224,29 @@ inline bool Matrix4::operator!=(const Matrix4& n) const
 
 
 
-inline float Matrix4::operator[](int index) const
+template <typename T>
+constexpr T Matrix4T<T>::operator[](int index) const
 {
     return m[index];
 }
 
 
 
-inline float& Matrix4::operator[](int index)
+template <typename T>
+constexpr T& Matrix4T<T>::operator[](int index)
 {
     return m[index];
 }
 
 
 
-inline Matrix4 operator-(const Matrix4& rhs)
-{
-    return Matrix4(-rhs[0], -rhs[1], -rhs[2], -rhs[3], -rhs[4], -rhs[5], -rhs[6], -rhs[7], -rhs[8], -rhs[9], -rhs[10], -rhs[11], -rhs[12], -rhs[13], -rhs[14], -rhs[15]);
-}
-
-
-
-inline Matrix4 operator*(float s, const Matrix4& rhs)
-{
-    return Matrix4(s*rhs[0], s*rhs[1], s*rhs[2], s*rhs[3], s*rhs[4], s*rhs[5], s*rhs[6], s*rhs[7], s*rhs[8], s*rhs[9], s*rhs[10], s*rhs[11], s*rhs[12], s*rhs[13], s*rhs[14], s*rhs[15]);
-}
-
 
 
-inline Vector4 operator*(const Vector4& v, const Matrix4& m)
-{
-    return Vector4(v.x*m[0] + v.y*m[1] + v.z*m[2] + v.w*m[3],  v.x*m[4] + v.y*m[5] + v.z*m[6] + v.w*m[7],  v.x*m[8] + v.y*m[9] + v.z*m[10] + v.w*m[11], v.x*m[12] + v.y*m[13] + v.z*m[14] + v.w*m[15]);
-}
-
 
 
-inline Vector3 operator*(const Vector3& v, const Matrix4& m)
-{
-    return Vector3(v.x*m[0] + v.y*m[1] + v.z*m[2],  v.x*m[4] + v.y*m[5] + v.z*m[6],  v.x*m[8] + v.y*m[9] + v.z*m[10]);
-}
 
 
 
-inline std::ostream& operator<<(std::ostream& os, const Matrix4& m)
-{
-    os << std::fixed << std::setprecision(5);
-    os << "[" << std::setw(10) << m[0] << " " << std::setw(10) << m[4] << " " << std::setw(10) << m[8]  <<  " " << std::setw(10) << m[12] << "]\n"
-       << "[" << std::setw(10) << m[1] << " " << std::setw(10) << m[5] << " " << std::setw(10) << m[9]  <<  " " << std::setw(10) << m[13] << "]\n"
-       << "[" << std::setw(10) << m[2] << " " << std::setw(10) << m[6] << " " << std::setw(10) << m[10] <<  " " << std::setw(10) << m[14] << "]\n"
-       << "[" << std::setw(10) << m[3] << " " << std::setw(10) << m[7] << " " << std::setw(10) << m[11] <<  " " << std::setw(10) << m[15] << "]\n";
-    os << std::resetiosflags(std::ios_base::fixed | std::ios_base::floatfield);
-    return os;
-}
 
 
 
@@ -932,14 +1254,15 @@ inline std::ostream& operator<<(std::ostream& os, const Matrix4& m)
 
 // * Fill in the values of a perspective projection matrix
 // * FOV is vertical
-inline Matrix4& Matrix4::perspective(float fov, float aspect, float zNear, float zFar)
+template <typename T>
+inline Matrix4T<T>& Matrix4T<T>::perspective(T fov, T aspect, T zNear, T zFar)
 {
 	//const float n_over_d = 1.0f / tan(fov * (float)M_PI / 360.0f);
 	//const float n_over_h = sqrt(aspect*aspect + 1) * n_over_d;
 	//const float neg_depth = zNear - zFar;
 
-	const float n_over_h = 1.0f / tan(fov * (float)M_PI / 360.0f);
-	const float neg_depth = zNear - zFar;
+	const T n_over_h = 1.0f / tan(fov * (T)M_PI / 360.0f);
+	const T neg_depth = zNear - zFar;
 
 	m[0] = n_over_h / aspect;
 	m[1] = 0;
@@ -965,4 +1288,48 @@ inline Matrix4& Matrix4::perspective(float fov, float aspect, float zNear, float
 }
 // END OF MATRIX4 INLINE //////////////////////////////////////////////////////
 
+
+
+// instantiated once in Matrices.cpp
+extern template class Matrix2T<float>;
+extern template class Matrix3T<float>;
+extern template class Matrix4T<float>;
+
+
+
+// ========================================================================== //
+//  4x4 matrices of a known kind
+//  The type tells invert() which method to use, so no check is done at run
+//  time. Constructing one from a Matrix4 is a promise of the caller, and the
+//  product of two matrices of the same kind keeps the kind.
+// ========================================================================== //
+class AffineMatrix4 : public Matrix4
+{
+public:
+    constexpr AffineMatrix4() : Matrix4() {};
+    constexpr explicit AffineMatrix4(const Matrix4& m) : Matrix4(m) {};
+
+    AffineMatrix4& invert()                             { invertAffine(); return *this; }
+
+    using Matrix4::operator*;
+    YUP_SIMD_CONSTEXPR AffineMatrix4 operator*(const AffineMatrix4& rhs) const { return AffineMatrix4(Matrix4::operator*(rhs)); }
+    YUP_SIMD_CONSTEXPR AffineMatrix4& operator*=(const AffineMatrix4& rhs) { return *this = *this * rhs; }
+};
+
+
+
+// rotation and translation only
+class RigidMatrix4 : public AffineMatrix4
+{
+public:
+    constexpr RigidMatrix4() : AffineMatrix4() {};
+    constexpr explicit RigidMatrix4(const Matrix4& m) : AffineMatrix4(m) {};
+
+    constexpr RigidMatrix4& invert()                    { invertEuclidean(); return *this; }
+
+    using AffineMatrix4::operator*;
+    YUP_SIMD_CONSTEXPR RigidMatrix4 operator*(const RigidMatrix4& rhs) const { return RigidMatrix4(Matrix4::operator*(rhs)); }
+    YUP_SIMD_CONSTEXPR RigidMatrix4& operator*=(const RigidMatrix4& rhs) { return *this = *this * rhs; }
+};
+
 END_NAMESPACE_YUP
\ No newline at end of file
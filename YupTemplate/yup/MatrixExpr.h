@@ -0,0 +1,246 @@
+// ========================================================================== //
+//
+//  MatrixExpr.h
+//  ---
+//  Lazy evaluation of Matrix4 product chains
+//
+//  Wrapping the first operand with Lazy() turns a chain like
+//      Matrix4 mvp = Lazy(proj) * eye * pose;
+//  into an expression that is evaluated once, from right to left. Operands
+//  whose 4th row is [0,0,0,1] are detected, and while everything to the
+//  right is affine too the product skips the 4th row (12 instead of 16 column
+//  multiply-adds); the others use the SIMD Matrix4 operator*. Multiplying
+//  the expression with a Vector4/Vector3 only does matrix-vector products.
+//
+//  The expression keeps references to its operands, so evaluate it within
+//  the same statement (assign to Matrix4, not to auto).
+//  The products are associated right to left, which may round differently
+//  from the eager left to right Matrix4 operator* in the last bit.
+//
+//  Created: 2016-08-24
+//  Updated: 2016-08-24
+//
+//  (C) 2016 Yu-hsien Chang
+//
+// ========================================================================== //
+
+#pragma once
+
+#include "yup.h"
+#include "Vectors.h"
+#include "Matrices.h"
+
+BEGIN_NAMESPACE_YUP
+
+// true if the 4th row is [0,0,0,1] (no projective part)
+constexpr bool IsAffine(const Matrix4& m)
+{
+    return m[3] == 0.0f && m[7] == 0.0f && m[11] == 0.0f && m[15] == 1.0f;
+}
+
+
+
+// a * b for affine a and b, the 4th row of the result is [0,0,0,1] too
+Matrix4 MultiplyAffine(const Matrix4& a, const Matrix4& b);
+
+
+
+class Matrix4Ref;
+
+// ========================================================================== //
+//  Expression base, E provides apply(), isAffine(), collect() and Count, the
+//  number of operands
+// ========================================================================== //
+template <typename E>
+class Matrix4Expr
+{
+public:
+    const E& self() const { return static_cast<const E&>(*this); }
+
+    Vector4 apply(const Vector4& v) const       { return self().apply(v); }
+    bool    isAffine() const                    { return self().isAffine(); }
+
+    Matrix4 eval() const;
+    operator Matrix4() const                    { return eval(); }
+};
+
+
+
+// ========================================================================== //
+//  Leaf, refers to a Matrix4
+// ========================================================================== //
+class Matrix4Ref : public Matrix4Expr<Matrix4Ref>
+{
+public:
+    static const int Count = 1;
+
+    explicit Matrix4Ref(const Matrix4& m) : mMat(m), mAffine(IsAffine(m)) {}
+
+    Vector4 apply(const Vector4& v) const;
+    bool    isAffine() const                    { return mAffine; }
+
+    const Matrix4& matrix() const               { return mMat; }
+    void    collect(const Matrix4Ref** operands, int& n) const { operands[n++] = this; }
+
+private:
+    const Matrix4&  mMat;
+    bool            mAffine;
+};
+
+
+
+// ========================================================================== //
+//  Product of two expressions
+// ========================================================================== //
+template <typename L, typename R>
+class Matrix4Product : public Matrix4Expr<Matrix4Product<L, R> >
+{
+public:
+    static const int Count = L::Count + R::Count;
+
+    Matrix4Product(const L& lhs, const R& rhs) : mLhs(lhs), mRhs(rhs) {}
+
+    Vector4 apply(const Vector4& v) const       { return mLhs.apply(mRhs.apply(v)); }
+    bool    isAffine() const                    { return mLhs.isAffine() && mRhs.isAffine(); }
+
+    void    collect(const Matrix4Ref** operands, int& n) const { mLhs.collect(operands, n); mRhs.collect(operands, n); }
+
+private:
+    // leaves and products are a few words, hold them by value
+    L mLhs;
+    R mRhs;
+};
+
+
+
+// ========================================================================== //
+//  inline functions
+// ========================================================================== //
+inline Matrix4Ref Lazy(const Matrix4& m)
+{
+    return Matrix4Ref(m);
+}
+
+
+
+inline Matrix4 MultiplyAffine(const Matrix4& a, const Matrix4& b)
+{
+    const float* m = a.get();
+    const float* n = b.get();
+    float r[16];
+
+#ifdef YUP_SIMD_SSE2
+    // the operation order of Matrix4 operator*, without the terms of the 4th row of b
+    const __m128 c0 = _mm_loadu_ps(&m[0]);
+    const __m128 c1 = _mm_loadu_ps(&m[4]);
+    const __m128 c2 = _mm_loadu_ps(&m[8]);
+    const __m128 c3 = _mm_loadu_ps(&m[12]);
+    for (int i = 0; i < 12; i += 4)
+    {
+        __m128 t = _mm_mul_ps(c0, _mm_set1_ps(n[i]));
+        t = _mm_add_ps(t, _mm_mul_ps(c1, _mm_set1_ps(n[i + 1])));
+        t = _mm_add_ps(t, _mm_mul_ps(c2, _mm_set1_ps(n[i + 2])));
+        _mm_storeu_ps(&r[i], t);
+    }
+
+    __m128 t = _mm_mul_ps(c0, _mm_set1_ps(n[12]));
+    t = _mm_add_ps(t, _mm_mul_ps(c1, _mm_set1_ps(n[13])));
+    t = _mm_add_ps(t, _mm_mul_ps(c2, _mm_set1_ps(n[14])));
+    _mm_storeu_ps(&r[12], _mm_add_ps(t, c3));
+#else
+    for (int i = 0; i < 12; i += 4)
+    {
+        r[i]     = m[0]*n[i] + m[4]*n[i+1] + m[8]*n[i+2];
+        r[i + 1] = m[1]*n[i] + m[5]*n[i+1] + m[9]*n[i+2];
+        r[i + 2] = m[2]*n[i] + m[6]*n[i+1] + m[10]*n[i+2];
+        r[i + 3] = 0.0f;
+    }
+
+    r[12] = m[0]*n[12] + m[4]*n[13] + m[8]*n[14]  + m[12];
+    r[13] = m[1]*n[12] + m[5]*n[13] + m[9]*n[14]  + m[13];
+    r[14] = m[2]*n[12] + m[6]*n[13] + m[10]*n[14] + m[14];
+    r[15] = 1.0f;
+#endif
+
+    return Matrix4(r);
+}
+
+
+
+template <typename E>
+inline Matrix4 Matrix4Expr<E>::eval() const
+{
+    const Matrix4Ref* operands[E::Count];
+    int n = 0;
+    self().collect(operands, n);
+
+    // right to left, so an affine tail is multiplied with MultiplyAffine()
+    Matrix4 r = operands[E::Count - 1]->matrix();
+    bool affine = operands[E::Count - 1]->isAffine();
+    for (int i = E::Count - 2; i >= 0; i--)
+    {
+        affine = affine && operands[i]->isAffine();
+        r = affine ? MultiplyAffine(operands[i]->matrix(), r) : operands[i]->matrix() * r;
+    }
+
+    return r;
+}
+
+
+
+inline Vector4 Matrix4Ref::apply(const Vector4& v) const
+{
+    if (!mAffine)
+        return mMat * v;
+
+    // the 4th row yields v.w, and a direction (w = 0) skips the translation
+    const float* m = mMat.get();
+    if (v.w == 0.0f)
+        return Vector4(m[0]*v.x + m[4]*v.y + m[8]*v.z,
+                       m[1]*v.x + m[5]*v.y + m[9]*v.z,
+                       m[2]*v.x + m[6]*v.y + m[10]*v.z,
+                       0.0f);
+
+    return Vector4(m[0]*v.x + m[4]*v.y + m[8]*v.z  + m[12]*v.w,
+                   m[1]*v.x + m[5]*v.y + m[9]*v.z  + m[13]*v.w,
+                   m[2]*v.x + m[6]*v.y + m[10]*v.z + m[14]*v.w,
+                   v.w);
+}
+
+
+
+template <typename L, typename R>
+inline Matrix4Product<L, R> operator*(const Matrix4Expr<L>& lhs, const Matrix4Expr<R>& rhs)
+{
+    return Matrix4Product<L, R>(lhs.self(), rhs.self());
+}
+
+template <typename L>
+inline Matrix4Product<L, Matrix4Ref> operator*(const Matrix4Expr<L>& lhs, const Matrix4& rhs)
+{
+    return Matrix4Product<L, Matrix4Ref>(lhs.self(), Matrix4Ref(rhs));
+}
+
+template <typename R>
+inline Matrix4Product<Matrix4Ref, R> operator*(const Matrix4& lhs, const Matrix4Expr<R>& rhs)
+{
+    return Matrix4Product<Matrix4Ref, R>(Matrix4Ref(lhs), rhs.self());
+}
+
+
+
+template <typename E>
+inline Vector4 operator*(const Matrix4Expr<E>& lhs, const Vector4& rhs)
+{
+    return lhs.apply(rhs);
+}
+
+// same as Matrix4 * Vector3, the transformed w is dropped
+template <typename E>
+inline Vector3 operator*(const Matrix4Expr<E>& lhs, const Vector3& rhs)
+{
+    Vector4 v = lhs.apply(Vector4(rhs.x, rhs.y, rhs.z, 1.0f));
+    return Vector3(v.x, v.y, v.z);
+}
+
+END_NAMESPACE_YUP
@@ -0,0 +1,160 @@
+// ========================================================================== //
+//
+//  Parallel.cpp
+//  ---
+//
+//  Created: 2016-08-24
+//  Updated: 2016-08-24
+//
+//  (C) 2016 Yu-hsien Chang
+//
+// ========================================================================== //
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Parallel.h"
+
+BEGIN_NAMESPACE_YUP
+
+static std::atomic<int> sParallelThreads(0);
+
+void SetParallelThreads(int threads)
+{
+	sParallelThreads = threads;
+}
+
+
+
+// -------------------------------------------------------------------------- //
+//  WorkerPool
+// -------------------------------------------------------------------------- //
+// One call of ParallelRows(), its bands are handed out one at a time
+struct ParallelJob
+{
+	const std::function<void(int, int)> *body;
+	int rows;
+	int band;
+	int count;					// bands
+	int next = 0;				// first band not handed out
+	int done = 0;				// bands finished
+};
+
+// Threads that wait for bands of queued jobs. Callers work on their own job
+// too, so a job finishes even when all workers are busy, and nested calls
+// from inside a band do not deadlock.
+class WorkerPool
+{
+private:
+	std::mutex mMutex;
+	std::condition_variable mWork;
+	std::condition_variable mDone;
+	std::deque<ParallelJob *> mJobs;			// jobs with bands not handed out
+	std::vector<std::thread> mWorkers;
+
+	WorkerPool() {}
+
+public:
+	// never destroyed, the workers live as long as the process
+	static WorkerPool & Instance() {
+		static WorkerPool * instance = new WorkerPool();
+
+		return *instance;
+	}
+
+	void run(ParallelJob &job, int workers)
+	{
+		std::unique_lock<std::mutex> lock(mMutex);
+
+		// grows to the largest count asked for, extra workers just stay idle
+		while ((int)mWorkers.size() < workers)
+			mWorkers.emplace_back(&WorkerPool::workerFunc, this);
+
+		mJobs.push_back(&job);
+		mWork.notify_all();
+
+		int band;
+		while ((band = take(job)) >= 0)
+		{
+			lock.unlock();
+			runBand(job, band);
+			lock.lock();
+			job.done++;
+		}
+
+		mDone.wait(lock, [&job] { return job.done == job.count; });
+	}
+
+private:
+	// next band of job, -1 once all are handed out, with mMutex held
+	int take(ParallelJob &job)
+	{
+		if (job.next == job.count)
+			return -1;
+
+		int band = job.next++;
+		if (job.next == job.count)
+			mJobs.erase(std::find(mJobs.begin(), mJobs.end(), &job));
+		return band;
+	}
+
+	static void runBand(const ParallelJob &job, int band)
+	{
+		const int begin = band * job.band;
+		(*job.body)(begin, std::min(begin + job.band, job.rows));
+	}
+
+	void workerFunc()
+	{
+		std::unique_lock<std::mutex> lock(mMutex);
+
+		for (;;)
+		{
+			mWork.wait(lock, [this] { return !mJobs.empty(); });
+
+			ParallelJob &job = *mJobs.front();
+			int band = take(job);
+
+			lock.unlock();
+			runBand(job, band);
+			lock.lock();
+
+			if (++job.done == job.count)
+				mDone.notify_all();
+		}
+	}
+};
+
+
+
+void ParallelRows(int rows, int step, const std::function<void(int, int)> &body, int minBandRows)
+{
+	int threads = sParallelThreads;
+	if (threads <= 0)
+		threads = (int)std::thread::hardware_concurrency();
+	threads = std::max(1, std::min(threads, rows / std::max(minBandRows, 1)));
+
+	int band = (rows + threads - 1) / threads;
+	band = (band + step - 1) / step * step;
+
+	if (threads == 1 || band >= rows)
+	{
+		body(0, rows);
+		return;
+	}
+
+	ParallelJob job;
+	job.body = &body;
+	job.rows = rows;
+	job.band = band;
+	job.count = (rows + band - 1) / band;
+
+	WorkerPool::Instance().run(job, threads - 1);
+}
+
+END_NAMESPACE_YUP
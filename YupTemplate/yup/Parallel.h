@@ -0,0 +1,32 @@
+// ========================================================================== //
+//
+//  Parallel.h
+//  ---
+//  Splitting row loops over threads
+//
+//  Created: 2016-08-24
+//  Updated: 2016-08-24
+//
+//  (C) 2016 Yu-hsien Chang
+//
+// ========================================================================== //
+
+#pragma once
+
+#include <functional>
+
+#include "yup.h"
+
+BEGIN_NAMESPACE_YUP
+
+// Run body(begin, end) over bands of rows on several threads, the calling
+// thread works on bands too. Each band starts on a multiple of step and
+// has at least minBandRows rows, so small jobs stay on one thread. The
+// other threads come from a pool that is started on first use and kept.
+void ParallelRows(int rows, int step, const std::function<void(int, int)> &body, int minBandRows = 64);
+
+// number of threads for ParallelRows(), 0 for one per core (the default),
+// the pool grows to the largest count used
+void SetParallelThreads(int threads);
+
+END_NAMESPACE_YUP
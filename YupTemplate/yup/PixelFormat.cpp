@@ -0,0 +1,662 @@
+// ========================================================================== //
+//
+//  PixelFormat.cpp
+//  ---
+//  The YUV to RGB kernels work on 16 pixels at a time in 32 bit fixed point
+//  with the same integer steps as the scalar code, so both give the same
+//  bytes. RGB to YUV is scalar, it is not on the display path.
+//
+//  Created: 2016-08-24
+//  Updated: 2016-08-24
+//
+//  (C) 2016 Yu-hsien Chang
+//
+// ========================================================================== //
+
+#include <algorithm>
+#include <utility>
+
+#include "Parallel.h"
+#include "PixelFormat.h"
+#include "PixelPack.h"
+#include "Simd.h"
+
+BEGIN_NAMESPACE_YUP
+
+void SetConvertThreads(int threads)
+{
+	SetParallelThreads(threads);
+}
+
+
+
+// -------------------------------------------------------------------------- //
+//  scalar
+// -------------------------------------------------------------------------- //
+static inline uint8_t Clamp8(int v)
+{
+	return (uint8_t)(v < 0 ? 0 : (v > 255 ? 255 : v));
+}
+
+// BT.601 limited range, 8 bit fraction
+template <bool Swap>
+static inline void YuvToRgb(int y, int u, int v, uint8_t *dst)
+{
+	const int c = 298 * (y - 16) + 128, d = u - 128, e = v - 128;
+	dst[Swap ? 2 : 0] = Clamp8((c + 409 * e) >> 8);
+	dst[1] = Clamp8((c - 100 * d - 208 * e) >> 8);
+	dst[Swap ? 0 : 2] = Clamp8((c + 516 * d) >> 8);
+}
+
+static inline uint8_t RgbToY(int r, int g, int b)
+{
+	return (uint8_t)(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+}
+
+static inline uint8_t RgbToU(int r, int g, int b)
+{
+	return (uint8_t)(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+}
+
+static inline uint8_t RgbToV(int r, int g, int b)
+{
+	return (uint8_t)(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+}
+
+
+
+// -------------------------------------------------------------------------- //
+//  SIMD building blocks
+// -------------------------------------------------------------------------- //
+#if defined(YUP_SIMD_SSE2)
+// lo, hi as the 16 bit halves of each 32 bit lane, for _mm_madd_epi16
+static inline __m128i Pair(int lo, int hi)
+{
+	return _mm_set1_epi32((int)(((uint32_t)(uint16_t)hi << 16) | (uint16_t)lo));
+}
+
+// 16 Y and 8 U, V samples (in the low half) of the source format
+template <PixelFormat Format>
+static inline void LoadYuv16(const uint8_t *y, const uint8_t *u, const uint8_t *v, int i, __m128i &yy, __m128i &uu, __m128i &vv)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i low = _mm_set1_epi16(0x00FF);
+
+	if (Format == PIXELFORMAT_I420)
+	{
+		yy = _mm_loadu_si128((const __m128i *)(y + i));
+		uu = _mm_loadl_epi64((const __m128i *)(u + i / 2));
+		vv = _mm_loadl_epi64((const __m128i *)(v + i / 2));
+	}
+	else if (Format == PIXELFORMAT_NV12)
+	{
+		yy = _mm_loadu_si128((const __m128i *)(y + i));
+		__m128i uv = _mm_loadu_si128((const __m128i *)(u + i));
+		uu = _mm_packus_epi16(_mm_and_si128(uv, low), zero);
+		vv = _mm_packus_epi16(_mm_srli_epi16(uv, 8), zero);
+	}
+	else
+	{
+		__m128i a = _mm_loadu_si128((const __m128i *)(y + i * 2));
+		__m128i b = _mm_loadu_si128((const __m128i *)(y + i * 2 + 16));
+		yy = _mm_packus_epi16(_mm_and_si128(a, low), _mm_and_si128(b, low));
+		__m128i uv = _mm_packus_epi16(_mm_srli_epi16(a, 8), _mm_srli_epi16(b, 8));
+		uu = _mm_packus_epi16(_mm_and_si128(uv, low), zero);
+		vv = _mm_packus_epi16(_mm_srli_epi16(uv, 8), zero);
+	}
+}
+
+// YuvToRgb() on 8 pixels of 16 bit c = y - 16, d = u - 128, e = v - 128
+static inline void YuvToRgb8(__m128i c, __m128i d, __m128i e, __m128i &r, __m128i &g, __m128i &b)
+{
+	const __m128i one = _mm_set1_epi16(1);
+	__m128i rr[2], gg[2], bb[2];
+
+	for (int k = 0; k < 2; k++)
+	{
+		__m128i c1 = k ? _mm_unpackhi_epi16(c, one) : _mm_unpacklo_epi16(c, one);
+		__m128i de = k ? _mm_unpackhi_epi16(d, e) : _mm_unpacklo_epi16(d, e);
+		__m128i yy = _mm_madd_epi16(c1, Pair(298, 128));
+
+		rr[k] = _mm_srai_epi32(_mm_add_epi32(yy, _mm_madd_epi16(de, Pair(0, 409))), 8);
+		gg[k] = _mm_srai_epi32(_mm_add_epi32(yy, _mm_madd_epi16(de, Pair(-100, -208))), 8);
+		bb[k] = _mm_srai_epi32(_mm_add_epi32(yy, _mm_madd_epi16(de, Pair(516, 0))), 8);
+	}
+
+	r = _mm_packs_epi32(rr[0], rr[1]);
+	g = _mm_packs_epi32(gg[0], gg[1]);
+	b = _mm_packs_epi32(bb[0], bb[1]);
+}
+
+// 16 pixels to 4 registers of RGBA (BGRA if Swap)
+template <bool Swap>
+static inline void YuvToRgba16(__m128i y, __m128i u, __m128i v, __m128i p[4])
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i u16 = _mm_unpacklo_epi8(u, u);                // each chroma sample covers 2 pixels
+	const __m128i v16 = _mm_unpacklo_epi8(v, v);
+
+	__m128i r[2], g[2], b[2];
+	for (int h = 0; h < 2; h++)
+	{
+		__m128i c = h ? _mm_unpackhi_epi8(y, zero) : _mm_unpacklo_epi8(y, zero);
+		__m128i d = h ? _mm_unpackhi_epi8(u16, zero) : _mm_unpacklo_epi8(u16, zero);
+		__m128i e = h ? _mm_unpackhi_epi8(v16, zero) : _mm_unpacklo_epi8(v16, zero);
+		YuvToRgb8(_mm_sub_epi16(c, _mm_set1_epi16(16)), _mm_sub_epi16(d, _mm_set1_epi16(128)), _mm_sub_epi16(e, _mm_set1_epi16(128)), r[h], g[h], b[h]);
+	}
+
+	__m128i r8 = _mm_packus_epi16(r[0], r[1]);
+	__m128i g8 = _mm_packus_epi16(g[0], g[1]);
+	__m128i b8 = _mm_packus_epi16(b[0], b[1]);
+	if (Swap)
+		std::swap(r8, b8);
+
+	const __m128i alpha = _mm_set1_epi8((char)0xFF);
+	__m128i rgLo = _mm_unpacklo_epi8(r8, g8), rgHi = _mm_unpackhi_epi8(r8, g8);
+	__m128i baLo = _mm_unpacklo_epi8(b8, alpha), baHi = _mm_unpackhi_epi8(b8, alpha);
+	p[0] = _mm_unpacklo_epi16(rgLo, baLo);
+	p[1] = _mm_unpackhi_epi16(rgLo, baLo);
+	p[2] = _mm_unpacklo_epi16(rgHi, baHi);
+	p[3] = _mm_unpackhi_epi16(rgHi, baHi);
+}
+
+// Store 16 4 byte pixels as 3 byte pixels, dropping the 4th byte and
+// swapping the 1st and 3rd if asked
+static inline void StoreRgb16(const __m128i p[4], uint8_t *dst, bool swap)
+{
+#if defined(YUP_SIMD_SSSE3)
+	const __m128i mask = swap ? _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1)
+							  : _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+	__m128i q0 = _mm_shuffle_epi8(p[0], mask);
+	__m128i q1 = _mm_shuffle_epi8(p[1], mask);
+	__m128i q2 = _mm_shuffle_epi8(p[2], mask);
+	__m128i q3 = _mm_shuffle_epi8(p[3], mask);
+
+	__m128i* out = (__m128i *)dst;
+	_mm_storeu_si128(out,     _mm_or_si128(q0, _mm_slli_si128(q1, 12)));
+	_mm_storeu_si128(out + 1, _mm_or_si128(_mm_srli_si128(q1, 4), _mm_slli_si128(q2, 8)));
+	_mm_storeu_si128(out + 2, _mm_or_si128(_mm_srli_si128(q2, 8), _mm_slli_si128(q3, 4)));
+#else
+	alignas(16) uint8_t tmp[64];
+	for (int k = 0; k < 4; k++)
+		_mm_store_si128((__m128i *)tmp + k, p[k]);
+
+	const int r = swap ? 2 : 0, b = swap ? 0 : 2;
+	for (int k = 0; k < 16; k++)
+	{
+		dst[k * 3] = tmp[k * 4 + r];
+		dst[k * 3 + 1] = tmp[k * 4 + 1];
+		dst[k * 3 + 2] = tmp[k * 4 + b];
+	}
+#endif
+}
+#endif
+
+
+
+// -------------------------------------------------------------------------- //
+//  YUV to RGB(A), Swap for BGR(A), Depth 3 or 4 bytes out
+// -------------------------------------------------------------------------- //
+// One row of width pixels. y is the packed row for YUY2, u the interleaved
+// U, V row for NV12.
+template <PixelFormat Format, bool Swap, int Depth>
+static void DecodeRow(const uint8_t *y, const uint8_t *u, const uint8_t *v, uint8_t *dst, int width)
+{
+	int i = 0;
+
+#if defined(YUP_SIMD_SSE2)
+	for (; i + 16 <= width; i += 16)
+	{
+		__m128i yy, uu, vv, p[4];
+		LoadYuv16<Format>(y, u, v, i, yy, uu, vv);
+		YuvToRgba16<Swap>(yy, uu, vv, p);
+
+		if (Depth == 4)
+		{
+			for (int k = 0; k < 4; k++)
+				_mm_storeu_si128((__m128i *)(dst + i * 4) + k, p[k]);
+		}
+		else
+			StoreRgb16(p, dst + i * 3, false);
+	}
+#endif
+
+	for (; i < width; i += 2)
+	{
+		int y0, y1, cu, cv;
+		if (Format == PIXELFORMAT_I420)
+		{
+			y0 = y[i];
+			y1 = y[i + 1];
+			cu = u[i / 2];
+			cv = v[i / 2];
+		}
+		else if (Format == PIXELFORMAT_NV12)
+		{
+			y0 = y[i];
+			y1 = y[i + 1];
+			cu = u[i];
+			cv = u[i + 1];
+		}
+		else
+		{
+			y0 = y[i * 2];
+			cu = y[i * 2 + 1];
+			y1 = y[i * 2 + 2];
+			cv = y[i * 2 + 3];
+		}
+
+		uint8_t *out = dst + i * Depth;
+		YuvToRgb<Swap>(y0, cu, cv, out);
+		YuvToRgb<Swap>(y1, cu, cv, out + Depth);
+		if (Depth == 4)
+			out[3] = out[7] = 0xFF;
+	}
+}
+
+template <PixelFormat Format, bool Swap, int Depth>
+static void DecodeRows(const FrameView &src, uint8_t *dst, int height, int begin, int end)
+{
+	const int width = src.width();
+	const int chromaStride = src.stride() / 2;
+
+	for (int y = begin; y < end; y++)
+	{
+		const uint8_t *u = nullptr;
+		const uint8_t *v = nullptr;
+		if (Format == PIXELFORMAT_NV12)
+			u = src.row(height + y / 2);
+		else if (Format == PIXELFORMAT_I420)
+		{
+			u = src.row(height) + (size_t)(y / 2) * chromaStride;
+			v = src.row(height) + (size_t)(height / 2 + y / 2) * chromaStride;
+		}
+
+		DecodeRow<Format, Swap, Depth>(src.row(y), u, v, dst + (size_t)y * width * Depth, width);
+	}
+}
+
+
+
+// -------------------------------------------------------------------------- //
+//  RGB(A) to YUV, chroma is the average of the 2 or 4 pixels it covers
+// -------------------------------------------------------------------------- //
+template <bool Swap>
+static inline void ReadRgb(const uint8_t *p, int &r, int &g, int &b)
+{
+	r = p[Swap ? 2 : 0];
+	g = p[1];
+	b = p[Swap ? 0 : 2];
+}
+
+template <PixelFormat Format, bool Swap, int Depth>
+static void EncodeRows(const FrameView &src, uint8_t *dst, int height, int begin, int end)
+{
+	const int width = src.width();
+
+	if (Format == PIXELFORMAT_YUY2)
+	{
+		for (int y = begin; y < end; y++)
+		{
+			const uint8_t *in = src.row(y);
+			uint8_t *out = dst + (size_t)y * width * 2;
+			for (int x = 0; x < width; x += 2)
+			{
+				int r0, g0, b0, r1, g1, b1;
+				ReadRgb<Swap>(in + x * Depth, r0, g0, b0);
+				ReadRgb<Swap>(in + x * Depth + Depth, r1, g1, b1);
+
+				int r = (r0 + r1 + 1) >> 1, g = (g0 + g1 + 1) >> 1, b = (b0 + b1 + 1) >> 1;
+				out[x * 2] = RgbToY(r0, g0, b0);
+				out[x * 2 + 1] = RgbToU(r, g, b);
+				out[x * 2 + 2] = RgbToY(r1, g1, b1);
+				out[x * 2 + 3] = RgbToV(r, g, b);
+			}
+		}
+		return;
+	}
+
+	// rows in pairs, begin is even
+	uint8_t *chroma = dst + (size_t)height * width;
+	for (int y = begin; y < end; y += 2)
+	{
+		const uint8_t *in0 = src.row(y);
+		const uint8_t *in1 = src.row(y + 1);
+		uint8_t *out0 = dst + (size_t)y * width;
+		uint8_t *out1 = out0 + width;
+
+		uint8_t *u = nullptr;
+		uint8_t *v = nullptr;
+		if (Format == PIXELFORMAT_NV12)
+			u = chroma + (size_t)(y / 2) * width;
+		else
+		{
+			u = chroma + (size_t)(y / 2) * (width / 2);
+			v = chroma + (size_t)(height / 2 + y / 2) * (width / 2);
+		}
+
+		for (int x = 0; x < width; x += 2)
+		{
+			int r = 0, g = 0, b = 0;
+			for (int k = 0; k < 4; k++)
+			{
+				const uint8_t *p = (k < 2 ? in0 : in1) + (x + (k & 1)) * Depth;
+				int pr, pg, pb;
+				ReadRgb<Swap>(p, pr, pg, pb);
+				(k < 2 ? out0 : out1)[x + (k & 1)] = RgbToY(pr, pg, pb);
+				r += pr;
+				g += pg;
+				b += pb;
+			}
+
+			r = (r + 2) >> 2;
+			g = (g + 2) >> 2;
+			b = (b + 2) >> 2;
+			if (Format == PIXELFORMAT_NV12)
+			{
+				u[x] = RgbToU(r, g, b);
+				u[x + 1] = RgbToV(r, g, b);
+			}
+			else
+			{
+				u[x / 2] = RgbToU(r, g, b);
+				v[x / 2] = RgbToV(r, g, b);
+			}
+		}
+	}
+}
+
+
+
+// -------------------------------------------------------------------------- //
+//  between the RGB orders
+// -------------------------------------------------------------------------- //
+// swap R and B of 3 byte pixels
+static void SwapRB3(const uint8_t *src, uint8_t *dst, int n)
+{
+	int i = 0;
+
+#if defined(YUP_SIMD_SSSE3)
+	// 4 pixels per step, the last 4 bytes of each store are written again by
+	// the next step, so the loads stay within 2 pixels of the end
+	const __m128i mask = _mm_setr_epi8(2, 1, 0, 5, 4, 3, 8, 7, 6, 11, 10, 9, 12, 13, 14, 15);
+	for (; i + 6 <= n; i += 4)
+		_mm_storeu_si128((__m128i *)(dst + i * 3), _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(src + i * 3)), mask));
+#endif
+
+	for (; i < n; ++i)
+	{
+		uint8_t r = src[i * 3];
+		dst[i * 3] = src[i * 3 + 2];
+		dst[i * 3 + 1] = src[i * 3 + 1];
+		dst[i * 3 + 2] = r;
+	}
+}
+
+// swap R and B of 4 byte pixels
+static void SwapRB4(const uint8_t *src, uint8_t *dst, int n)
+{
+	int i = 0;
+
+#if defined(YUP_SIMD_SSE2)
+	const __m128i gaMask = _mm_set1_epi32((int)0xFF00FF00u);
+	for (; i + 4 <= n; i += 4)
+	{
+		__m128i p = _mm_loadu_si128((const __m128i *)(src + i * 4));
+		__m128i rb = _mm_andnot_si128(gaMask, p);
+		rb = _mm_or_si128(_mm_slli_epi32(rb, 16), _mm_srli_epi32(rb, 16));
+		_mm_storeu_si128((__m128i *)(dst + i * 4), _mm_or_si128(_mm_and_si128(p, gaMask), rb));
+	}
+#endif
+
+	for (; i < n; ++i)
+	{
+		const uint8_t *p = src + i * 4;
+		uint8_t *q = dst + i * 4;
+		uint8_t r = p[0];
+		q[0] = p[2];
+		q[1] = p[1];
+		q[2] = r;
+		q[3] = p[3];
+	}
+}
+
+// drop the alpha channel, swapping R and B if asked
+template <bool Swap>
+static void RgbaToRgb(const uint8_t *src, uint8_t *dst, int n)
+{
+	int i = 0;
+
+#if defined(YUP_SIMD_SSE2)
+	for (; i + 16 <= n; i += 16)
+	{
+		const __m128i* in = (const __m128i *)(src + i * 4);
+		__m128i p[4] = { _mm_loadu_si128(in), _mm_loadu_si128(in + 1), _mm_loadu_si128(in + 2), _mm_loadu_si128(in + 3) };
+		StoreRgb16(p, dst + i * 3, Swap);
+	}
+#endif
+
+	for (; i < n; ++i)
+	{
+		dst[i * 3] = src[i * 4 + (Swap ? 2 : 0)];
+		dst[i * 3 + 1] = src[i * 4 + 1];
+		dst[i * 3 + 2] = src[i * 4 + (Swap ? 0 : 2)];
+	}
+}
+
+template <int SrcDepth, int DstDepth, bool Swap>
+static void SwizzleRows(const FrameView &src, uint8_t *dst, int /*height*/, int begin, int end)
+{
+	const int width = src.width();
+
+	for (int y = begin; y < end; y++)
+	{
+		const uint8_t *in = src.row(y);
+		uint8_t *out = dst + (size_t)y * width * DstDepth;
+
+		if (SrcDepth == 3 && DstDepth == 4)
+			Swap ? PackBGRToRGBA(in, out, width) : PackRGBToRGBA(in, out, width);
+		else if (SrcDepth == 4 && DstDepth == 3)
+			RgbaToRgb<Swap>(in, out, width);
+		else if (SrcDepth == 3)
+			SwapRB3(in, out, width);
+		else
+			SwapRB4(in, out, width);
+	}
+}
+
+
+
+// -------------------------------------------------------------------------- //
+//  dispatch
+// -------------------------------------------------------------------------- //
+typedef void (*ConvertRowsFunc)(const FrameView &src, uint8_t *dst, int height, int begin, int end);
+
+static bool IsYuv(PixelFormat format)
+{
+	return format == PIXELFORMAT_NV12 || format == PIXELFORMAT_I420 || format == PIXELFORMAT_YUY2;
+}
+
+static bool IsPlanar(PixelFormat format)
+{
+	return format == PIXELFORMAT_NV12 || format == PIXELFORMAT_I420;
+}
+
+static bool IsSwapped(PixelFormat format)
+{
+	return format == PIXELFORMAT_BGR || format == PIXELFORMAT_BGRA;
+}
+
+int PixelFormatDepth(PixelFormat format)
+{
+	switch (format)
+	{
+	case PIXELFORMAT_RGB:
+	case PIXELFORMAT_BGR:
+		return 3;
+	case PIXELFORMAT_RGBA:
+	case PIXELFORMAT_BGRA:
+		return 4;
+	case PIXELFORMAT_YUY2:
+		return 2;
+	default:
+		return 1;
+	}
+}
+
+// the conversion of one YUV format to or from all the RGB formats
+template <template <PixelFormat, bool, int> class Conv, PixelFormat Format>
+static ConvertRowsFunc SelectRgb(PixelFormat rgbFormat)
+{
+	switch (rgbFormat)
+	{
+	case PIXELFORMAT_RGB:  return Conv<Format, false, 3>::Rows;
+	case PIXELFORMAT_BGR:  return Conv<Format, true, 3>::Rows;
+	case PIXELFORMAT_RGBA: return Conv<Format, false, 4>::Rows;
+	case PIXELFORMAT_BGRA: return Conv<Format, true, 4>::Rows;
+	default:               return nullptr;
+	}
+}
+
+template <PixelFormat Format, bool Swap, int Depth>
+struct Decode { static void Rows(const FrameView &src, uint8_t *dst, int height, int begin, int end) { DecodeRows<Format, Swap, Depth>(src, dst, height, begin, end); } };
+
+template <PixelFormat Format, bool Swap, int Depth>
+struct Encode { static void Rows(const FrameView &src, uint8_t *dst, int height, int begin, int end) { EncodeRows<Format, Swap, Depth>(src, dst, height, begin, end); } };
+
+template <template <PixelFormat, bool, int> class Conv>
+static ConvertRowsFunc SelectYuv(PixelFormat yuvFormat, PixelFormat rgbFormat)
+{
+	switch (yuvFormat)
+	{
+	case PIXELFORMAT_NV12: return SelectRgb<Conv, PIXELFORMAT_NV12>(rgbFormat);
+	case PIXELFORMAT_I420: return SelectRgb<Conv, PIXELFORMAT_I420>(rgbFormat);
+	case PIXELFORMAT_YUY2: return SelectRgb<Conv, PIXELFORMAT_YUY2>(rgbFormat);
+	default:               return nullptr;
+	}
+}
+
+static ConvertRowsFunc SelectSwizzle(PixelFormat srcFormat, PixelFormat dstFormat)
+{
+	const bool swap = IsSwapped(srcFormat) != IsSwapped(dstFormat);
+	const int srcDepth = PixelFormatDepth(srcFormat), dstDepth = PixelFormatDepth(dstFormat);
+
+	if (srcDepth == 3 && dstDepth == 4)
+		return swap ? SwizzleRows<3, 4, true> : SwizzleRows<3, 4, false>;
+	if (srcDepth == 4 && dstDepth == 3)
+		return swap ? SwizzleRows<4, 3, true> : SwizzleRows<4, 3, false>;
+	if (swap)
+		return srcDepth == 3 ? SwizzleRows<3, 3, true> : SwizzleRows<4, 4, true>;
+	return nullptr;
+}
+
+
+
+bool ConvertPixels(const FrameView &src, PixelFormat srcFormat, FrameBuffer &dst, PixelFormat dstFormat)
+{
+	if (src.empty() || src.colorDepth() != PixelFormatDepth(srcFormat))
+		return false;
+
+	// a plain copy, unless the I420 chroma planes have a stride of their own
+	if (srcFormat == dstFormat && (srcFormat != PIXELFORMAT_I420 || src.isContinuous()))
+	{
+		dst.setData(src);
+		return true;
+	}
+
+	ConvertRowsFunc func = nullptr;
+	if (IsYuv(srcFormat))
+		func = SelectYuv<Decode>(srcFormat, dstFormat);
+	else if (IsYuv(dstFormat))
+		func = SelectYuv<Encode>(dstFormat, srcFormat);
+	else
+		func = SelectSwizzle(srcFormat, dstFormat);
+
+	if (!func)
+		return false;
+
+	const int width = src.width();
+	const int height = IsPlanar(srcFormat) ? src.height() / 3 * 2 : src.height();
+
+	if (IsYuv(srcFormat) || IsYuv(dstFormat))
+	{
+		if (width % 2 != 0)
+			return false;
+		if (IsPlanar(srcFormat) && src.height() % 3 != 0)
+			return false;
+		if (IsPlanar(dstFormat) && height % 2 != 0)
+			return false;
+	}
+
+	if (!dst.resize(width, IsPlanar(dstFormat) ? height / 2 * 3 : height, PixelFormatDepth(dstFormat)))
+		return false;
+
+	uint8_t *out = dst.data();
+	ParallelRows(height, IsPlanar(srcFormat) || IsPlanar(dstFormat) ? 2 : 1, [&](int begin, int end) {
+		func(src, out, height, begin, end);
+	});
+
+	return true;
+}
+
+
+
+// -------------------------------------------------------------------------- //
+//  depth
+// -------------------------------------------------------------------------- //
+// scale is 255 / range in 16 bit fixed point, rounded up so range maps to 255
+static void Depth16To8Row(const uint16_t *src, uint8_t *dst, int n, uint16_t minDepth, uint32_t range, uint32_t scale)
+{
+	int i = 0;
+
+#if defined(YUP_SIMD_SSE2)
+	// scale only fits 16 bits for ranges of 256 and up
+	if (scale <= 0xFFFF)
+	{
+		const __m128i vMin = _mm_set1_epi16((short)minDepth);
+		const __m128i vRange = _mm_set1_epi16((short)range);
+		const __m128i vScale = _mm_set1_epi16((short)scale);
+		for (; i + 16 <= n; i += 16)
+		{
+			__m128i d[2];
+			for (int k = 0; k < 2; k++)
+			{
+				__m128i x = _mm_subs_epu16(_mm_loadu_si128((const __m128i *)(src + i) + k), vMin);
+				x = _mm_sub_epi16(x, _mm_subs_epu16(x, vRange));     // min(x, range)
+				d[k] = _mm_mulhi_epu16(x, vScale);
+			}
+			_mm_storeu_si128((__m128i *)(dst + i), _mm_packus_epi16(d[0], d[1]));
+		}
+	}
+#endif
+
+	for (; i < n; ++i)
+	{
+		uint32_t x = src[i] > minDepth ? src[i] - minDepth : 0;
+		x = std::min(x, range);
+		dst[i] = (uint8_t)((x * scale) >> 16);
+	}
+}
+
+bool ConvertDepth16To8(const FrameView &src, FrameBuffer &dst, uint16_t minDepth, uint16_t maxDepth)
+{
+	if (src.empty() || src.colorDepth() != 2 || maxDepth <= minDepth)
+		return false;
+
+	const int width = src.width();
+	const uint32_t range = maxDepth - minDepth;
+	const uint32_t scale = (255u * 65536 + range - 1) / range;
+
+	if (!dst.resize(width, src.height(), 1))
+		return false;
+
+	uint8_t *out = dst.data();
+	ParallelRows(src.height(), 1, [&](int begin, int end) {
+		for (int y = begin; y < end; y++)
+			Depth16To8Row((const uint16_t *)src.row(y), out + (size_t)y * width, width, minDepth, range, scale);
+	});
+
+	return true;
+}
+
+END_NAMESPACE_YUP
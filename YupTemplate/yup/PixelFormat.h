@@ -0,0 +1,67 @@
+// ========================================================================== //
+//
+//  PixelFormat.h
+//  ---
+//  Conversions between camera pixel formats
+//
+//  Images are passed as a FrameView of the raw buffer and written to a
+//  FrameBuffer, which is resized to fit. The buffer geometry of each format:
+//
+//    RGB, BGR      width x height, 3 bytes per pixel
+//    RGBA, BGRA    width x height, 4 bytes per pixel
+//    NV12          width x height * 3 / 2, 1 byte: the Y plane, then
+//                  height / 2 rows of interleaved U, V
+//    I420          width x height * 3 / 2, 1 byte: the Y plane, then the U
+//                  and the V plane at half the width and height (and half
+//                  the row stride)
+//    YUY2          width x height, 2 bytes: Y0 U Y1 V per 2 pixels
+//
+//  The YUV formats need an even width, NV12 and I420 an even height too.
+//  YUV is BT.601 limited range, like the YUV shader in ShaderSource.h.
+//  Large images are converted in bands of rows on several threads.
+//
+//  Created: 2016-08-24
+//  Updated: 2016-08-24
+//
+//  (C) 2016 Yu-hsien Chang
+//
+// ========================================================================== //
+
+#pragma once
+
+#include <cstdint>
+
+#include "yup.h"
+#include "FrameBuffer.h"
+#include "FrameView.h"
+
+BEGIN_NAMESPACE_YUP
+
+enum PixelFormat
+{
+	PIXELFORMAT_RGB,
+	PIXELFORMAT_BGR,
+	PIXELFORMAT_RGBA,
+	PIXELFORMAT_BGRA,
+	PIXELFORMAT_NV12,
+	PIXELFORMAT_I420,
+	PIXELFORMAT_YUY2
+};
+
+// bytes per pixel of the buffer of format
+int PixelFormatDepth(PixelFormat format);
+
+// Convert src to dstFormat. Supports YUV to RGB(A), RGB(A) to YUV and the
+// RGB orders among each other, returns false for anything else or if src
+// does not match srcFormat.
+bool ConvertPixels(const FrameView &src, PixelFormat srcFormat, FrameBuffer &dst, PixelFormat dstFormat);
+
+// Map 16 bit depth to 8 bit: minDepth and below to 0, maxDepth and above
+// to 255, linear in between
+bool ConvertDepth16To8(const FrameView &src, FrameBuffer &dst, uint16_t minDepth = 0, uint16_t maxDepth = 0xFFFF);
+
+// number of threads for the conversions, 0 for one per core (the default),
+// the same as SetParallelThreads()
+void SetConvertThreads(int threads);
+
+END_NAMESPACE_YUP
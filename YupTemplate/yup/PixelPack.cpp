@@ -0,0 +1,197 @@
+// ========================================================================== //
+//
+//  PixelPack.cpp
+//  ---
+//  The SIMD paths spread 3 byte pixels to 4 bytes with byte shuffles and
+//  merge the alpha bytes in with an OR, without any per pixel branch.
+//
+//  Created: 2016-08-24
+//  Updated: 2016-08-24
+//
+//  (C) 2016 Yu-hsien Chang
+//
+// ========================================================================== //
+
+#include "PixelPack.h"
+#include "Simd.h"
+
+BEGIN_NAMESPACE_YUP
+
+#if defined(YUP_SIMD_SSSE3)
+// Shuffle of 4 packed 3 byte pixels starting at byte offset into 4 byte
+// pixels with a zero alpha, swapping R and B if asked
+static inline __m128i ColorShuffle(bool swap, int offset)
+{
+    const int r = swap ? 2 : 0, b = swap ? 0 : 2;
+    return _mm_setr_epi8((char)(offset + r),     (char)(offset + 1),  (char)(offset + b),     -1,
+                         (char)(offset + 3 + r), (char)(offset + 4),  (char)(offset + 3 + b), -1,
+                         (char)(offset + 6 + r), (char)(offset + 7),  (char)(offset + 6 + b), -1,
+                         (char)(offset + 9 + r), (char)(offset + 10), (char)(offset + 9 + b), -1);
+}
+
+// Shuffle of 4 bytes starting at first into the alpha channel of 4 pixels
+static inline __m128i AlphaShuffle(int first)
+{
+    return _mm_setr_epi8(-1, -1, -1, (char)first,       -1, -1, -1, (char)(first + 1),
+                         -1, -1, -1, (char)(first + 2), -1, -1, -1, (char)(first + 3));
+}
+#endif
+
+
+
+// -------------------------------------------------------------------------- //
+//  colour (+ depth) to RGBA, Swap for BGR input, Depth for the alpha stream
+// -------------------------------------------------------------------------- //
+template <bool Swap, bool Depth>
+static void PackColor(const uint8_t* color, const uint8_t* depth, uint8_t* rgba, size_t n)
+{
+    size_t i = 0;
+
+#if defined(YUP_SIMD_AVX2)
+    // 8 pixels per register, the upper lane is loaded 8 bytes in so that its
+    // 4 pixels start at byte 4 and the loads stay inside the 24 bytes
+    const __m256i wideColorMask = _mm256_setr_m128i(ColorShuffle(Swap, 0), ColorShuffle(Swap, 4));
+    const __m256i wideAlphaMask = _mm256_setr_m128i(AlphaShuffle(0), AlphaShuffle(4));
+    const __m256i wideOpaque = _mm256_set1_epi32((int)0xFF000000u);
+    for (; i + 32 <= n; i += 32)
+    {
+        const uint8_t* src = color + i * 3;
+        for (int g = 0; g < 4; g++)
+        {
+            __m256i c = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i *)(src + g * 24))),
+                                                _mm_loadu_si128((const __m128i *)(src + g * 24 + 8)), 1);
+            c = _mm256_shuffle_epi8(c, wideColorMask);
+
+            // the 8 depth bytes in both lanes
+            __m256i a = wideOpaque;
+            if (Depth)
+                a = _mm256_shuffle_epi8(_mm256_broadcastq_epi64(_mm_loadl_epi64((const __m128i *)(depth + i + g * 8))), wideAlphaMask);
+
+            _mm256_storeu_si256((__m256i *)(rgba + (i + g * 8) * 4), _mm256_or_si256(c, a));
+        }
+    }
+#endif
+
+#if defined(YUP_SIMD_SSSE3)
+    // 16 pixels from 3 registers of colour
+    const __m128i colorMask0 = ColorShuffle(Swap, 0);
+    const __m128i colorMask4 = ColorShuffle(Swap, 4);
+    const __m128i alphaMask[4] = { AlphaShuffle(0), AlphaShuffle(4), AlphaShuffle(8), AlphaShuffle(12) };
+    const __m128i opaque = _mm_set1_epi32((int)0xFF000000u);
+    for (; i + 16 <= n; i += 16)
+    {
+        const __m128i* src = (const __m128i *)(color + i * 3);
+        __m128i v0 = _mm_loadu_si128(src);
+        __m128i v1 = _mm_loadu_si128(src + 1);
+        __m128i v2 = _mm_loadu_si128(src + 2);
+
+        // pixels 4k..4k+3 are bytes 12k..12k+11
+        __m128i c[4];
+        c[0] = _mm_shuffle_epi8(v0, colorMask0);
+        c[1] = _mm_shuffle_epi8(_mm_alignr_epi8(v1, v0, 12), colorMask0);
+        c[2] = _mm_shuffle_epi8(_mm_alignr_epi8(v2, v1, 8), colorMask0);
+        c[3] = _mm_shuffle_epi8(v2, colorMask4);
+
+        __m128i d = Depth ? _mm_loadu_si128((const __m128i *)(depth + i)) : _mm_setzero_si128();
+        __m128i* dst = (__m128i *)(rgba + i * 4);
+        for (int k = 0; k < 4; k++)
+        {
+            __m128i a = Depth ? _mm_shuffle_epi8(d, alphaMask[k]) : opaque;
+            _mm_storeu_si128(dst + k, _mm_or_si128(c[k], a));
+        }
+    }
+#endif
+
+    const int r = Swap ? 2 : 0, b = Swap ? 0 : 2;
+    for (; i < n; ++i)
+    {
+        const uint8_t* src = color + i * 3;
+        uint8_t* dst = rgba + i * 4;
+        dst[0] = src[r];
+        dst[1] = src[1];
+        dst[2] = src[b];
+        dst[3] = Depth ? depth[i] : 0xFF;
+    }
+}
+
+
+
+void PackRGBDToRGBA(const uint8_t* rgb, const uint8_t* depth, uint8_t* rgba, size_t n)
+{
+    PackColor<false, true>(rgb, depth, rgba, n);
+}
+
+void PackBGRDToRGBA(const uint8_t* bgr, const uint8_t* depth, uint8_t* rgba, size_t n)
+{
+    PackColor<true, true>(bgr, depth, rgba, n);
+}
+
+void PackRGBToRGBA(const uint8_t* rgb, uint8_t* rgba, size_t n)
+{
+    PackColor<false, false>(rgb, nullptr, rgba, n);
+}
+
+void PackBGRToRGBA(const uint8_t* bgr, uint8_t* rgba, size_t n)
+{
+    PackColor<true, false>(bgr, nullptr, rgba, n);
+}
+
+
+
+// -------------------------------------------------------------------------- //
+//  depth only, SSE2 is enough for these
+// -------------------------------------------------------------------------- //
+void PackDepthToAlpha(const uint8_t* depth, uint8_t* rgba, size_t n)
+{
+    size_t i = 0;
+
+#if defined(YUP_SIMD_SSE2)
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i colorMask = _mm_set1_epi32(0x00FFFFFF);
+    for (; i + 16 <= n; i += 16)
+    {
+        __m128i d = _mm_loadu_si128((const __m128i *)(depth + i));
+        __m128i lo = _mm_unpacklo_epi8(zero, d);                    // depth in the high byte of each word
+        __m128i hi = _mm_unpackhi_epi8(zero, d);
+        __m128i a[4] = { _mm_unpacklo_epi16(zero, lo), _mm_unpackhi_epi16(zero, lo),
+                         _mm_unpacklo_epi16(zero, hi), _mm_unpackhi_epi16(zero, hi) };
+
+        __m128i* dst = (__m128i *)(rgba + i * 4);
+        for (int k = 0; k < 4; k++)
+            _mm_storeu_si128(dst + k, _mm_or_si128(_mm_and_si128(_mm_loadu_si128(dst + k), colorMask), a[k]));
+    }
+#endif
+
+    for (; i < n; ++i)
+        rgba[i * 4 + 3] = depth[i];
+}
+
+
+
+void PackDepthToRGBA(const uint8_t* depth, uint8_t* rgba, size_t n)
+{
+    size_t i = 0;
+
+#if defined(YUP_SIMD_SSE2)
+    for (; i + 16 <= n; i += 16)
+    {
+        __m128i d = _mm_loadu_si128((const __m128i *)(depth + i));
+        __m128i lo = _mm_unpacklo_epi8(d, d);
+        __m128i hi = _mm_unpackhi_epi8(d, d);
+
+        __m128i* dst = (__m128i *)(rgba + i * 4);
+        _mm_storeu_si128(dst,     _mm_unpacklo_epi16(lo, lo));
+        _mm_storeu_si128(dst + 1, _mm_unpackhi_epi16(lo, lo));
+        _mm_storeu_si128(dst + 2, _mm_unpacklo_epi16(hi, hi));
+        _mm_storeu_si128(dst + 3, _mm_unpackhi_epi16(hi, hi));
+    }
+#endif
+
+    for (; i < n; ++i)
+    {
+        uint8_t* dst = rgba + i * 4;
+        dst[0] = dst[1] = dst[2] = dst[3] = depth[i];
+    }
+}
+
+END_NAMESPACE_YUP
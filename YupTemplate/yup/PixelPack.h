@@ -0,0 +1,41 @@
+// ========================================================================== //
+//
+//  PixelPack.h
+//  ---
+//  Packing of 8 bit colour and depth streams into RGBA pixels
+//
+//  Colour is 3 bytes per pixel, RGB or BGR, depth is 1 byte per pixel and
+//  goes to the alpha channel. The output is always R, G, B, A in memory.
+//  All functions work on n pixels, the buffers must not overlap.
+//
+//  Created: 2016-08-24
+//  Updated: 2016-08-24
+//
+//  (C) 2016 Yu-hsien Chang
+//
+// ========================================================================== //
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "yup.h"
+
+BEGIN_NAMESPACE_YUP
+
+// colour + depth, alpha = depth
+void PackRGBDToRGBA(const uint8_t* rgb, const uint8_t* depth, uint8_t* rgba, size_t n);
+void PackBGRDToRGBA(const uint8_t* bgr, const uint8_t* depth, uint8_t* rgba, size_t n);
+
+// colour only, alpha = 0xFF
+void PackRGBToRGBA(const uint8_t* rgb, uint8_t* rgba, size_t n);
+void PackBGRToRGBA(const uint8_t* bgr, uint8_t* rgba, size_t n);
+
+// depth only, the colour channels of rgba are kept
+void PackDepthToAlpha(const uint8_t* depth, uint8_t* rgba, size_t n);
+
+// depth only, all four channels = depth (grey visualisation)
+void PackDepthToRGBA(const uint8_t* depth, uint8_t* rgba, size_t n);
+
+END_NAMESPACE_YUP
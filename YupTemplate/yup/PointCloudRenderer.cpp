@@ -23,6 +23,9 @@ BEGIN_NAMESPACE_YUP_GL
 
 void PointCloudRenderer::onRenderEye(vr::Hmd_Eye nEye, Matrix4 & vpMat)
 {
+	if (!mVisible)
+		return;
+
 	switch (mRenderMode)
 	{
 	case Pos:
@@ -68,6 +71,9 @@ void PointCloudRenderer::onRenderEye(vr::Hmd_Eye nEye, Matrix4 & vpMat)
 
 void RgbPointCloudRenderer::onRenderEye(vr::Hmd_Eye nEye, Matrix4 & vpMat)
 {
+	if (!mVisible)
+		return;
+
 	Shader.VColor.use();
 	{
 		Shader.VColor.MvpMatrix = vpMat;
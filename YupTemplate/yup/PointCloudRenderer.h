@@ -38,6 +38,7 @@ public:
 private:
 	RenderMode mRenderMode = RenderMode::Solid;
 	Vector4 mColor;
+	bool mVisible = true;
 
 public:
 	PointCloudRenderer() : mColor(0, 1, 0, 1) {}
@@ -52,12 +53,16 @@ public:
 	virtual void onRender(Matrix4 &vpMat, int width, int height) override { onRenderEye(vr::Hmd_Eye::Eye_Left, vpMat); }
 	virtual void onRenderEye(vr::Hmd_Eye nEye, Matrix4 &vpMat) override;
 	virtual void onUpdate(const Matrix4 &headPose) override { VertexArray::update(); }
+	virtual void onCull(const Frustum &frustum) override { mVisible = frustum.intersects(drawBounds()); }
 	virtual void onShutdown() override { VertexArray::shutdown(); }
 };
 
 
 class RgbPointCloudRenderer : public Renderable, public RgbVertexArray
 {
+private:
+	bool mVisible = true;
+
 public:
 	RgbPointCloudRenderer() {}
 	~RgbPointCloudRenderer() {}
@@ -67,6 +72,7 @@ public:
 	virtual void onRender(Matrix4 &vpMat, int width, int height) override { onRenderEye(vr::Hmd_Eye::Eye_Left, vpMat); }
 	virtual void onRenderEye(vr::Hmd_Eye nEye, Matrix4 &vpMat) override;
 	virtual void onUpdate(const Matrix4 &headPose) override { VertexArray::update(); }
+	virtual void onCull(const Frustum &frustum) override { mVisible = frustum.intersects(drawBounds()); }
 	virtual void onShutdown() override { VertexArray::shutdown(); }
 };
 
@@ -0,0 +1,228 @@
+// ========================================================================== //
+//
+//  Pose.h
+//  ---
+//  Rigid transformations (rotation + translation)
+//
+//  Pose stores a unit quaternion and a position in 28 bytes, where a Matrix4
+//  takes 128. DualQuaternion is the same transformation in a form that can
+//  be blended linearly (screw motion), e.g. for several poses at once.
+//
+//  Created: 2016-08-24
+//  Updated: 2016-08-24
+//
+//  (C) 2016 Yu-hsien Chang
+//
+// ========================================================================== //
+
+#pragma once
+
+#ifdef YUP_INCLUDE_OPENVR
+#include <openvr.h>
+#endif
+
+#include <iostream>
+
+#include "yup.h"
+#include "Vectors.h"
+#include "Matrices.h"
+#include "Quaternion.h"
+
+BEGIN_NAMESPACE_YUP
+
+// ========================================================================== //
+//  Pose, p' = rotation * p + position
+// ========================================================================== //
+struct Pose
+{
+    Quaternion rotation;
+    Vector3 position;
+
+    // ctors, default is identity
+    constexpr Pose() {};
+    constexpr Pose(const Quaternion& rotation, const Vector3& position) : rotation(rotation), position(position) {};
+    explicit Pose(const Matrix4& m);                    // m must be rigid (no scale/shear)
+
+    // utils functions
+    constexpr Pose inverse() const;                     // the rotation must be normalized
+    Matrix4     getMatrix() const;                      //
+
+    // operators
+    constexpr Pose operator*(const Pose& rhs) const;    // apply rhs, then this
+    constexpr Pose& operator*=(const Pose& rhs);        // multiply rhs and update this object
+    constexpr Vector3 operator*(const Vector3& p) const; // transform point
+    constexpr bool operator==(const Pose& rhs) const;   // exact compare, no epsilon
+    constexpr bool operator!=(const Pose& rhs) const;   // exact compare, no epsilon
+
+    friend std::ostream& operator<<(std::ostream& os, const Pose& pose);
+};
+
+
+
+// ========================================================================== //
+//  Dual quaternion, real + dual * e with e^2 = 0
+// ========================================================================== //
+struct DualQuaternion
+{
+    Quaternion real;                                    // rotation
+    Quaternion dual;                                    // 0.5 * translation * rotation
+
+    // ctors
+    constexpr DualQuaternion() : real(), dual(0, 0, 0, 0) {};
+    constexpr DualQuaternion(const Quaternion& real, const Quaternion& dual) : real(real), dual(dual) {};
+    constexpr explicit DualQuaternion(const Pose& pose);
+
+    // utils functions
+    DualQuaternion& normalize();                        //
+    constexpr DualQuaternion conjugate() const;         // inverse of a unit dual quaternion
+    constexpr Pose getPose() const;                     // must be normalized
+
+    // operators
+    constexpr DualQuaternion operator+(const DualQuaternion& rhs) const;
+    constexpr DualQuaternion operator*(const float scale) const;
+    constexpr DualQuaternion operator*(const DualQuaternion& rhs) const; // apply rhs, then this
+    constexpr Vector3 operator*(const Vector3& p) const; // transform point, must be normalized
+};
+
+
+
+// ========================================================================== //
+//  inline functions for Pose
+// ========================================================================== //
+inline Pose::Pose(const Matrix4& m)
+    : rotation(m), position(m[12], m[13], m[14])
+{
+}
+
+constexpr Pose Pose::inverse() const {
+    Quaternion r = rotation.conjugate();
+    return Pose(r, -(r * position));
+}
+
+inline Matrix4 Pose::getMatrix() const {
+    Matrix4 m = rotation.getMatrix();
+    m.setColumn(3, position);
+    return m;
+}
+
+constexpr Pose Pose::operator*(const Pose& rhs) const {
+    return Pose(rotation * rhs.rotation, rotation * rhs.position + position);
+}
+
+constexpr Pose& Pose::operator*=(const Pose& rhs) {
+    *this = *this * rhs; return *this;
+}
+
+constexpr Vector3 Pose::operator*(const Vector3& p) const {
+    return rotation * p + position;
+}
+
+constexpr bool Pose::operator==(const Pose& rhs) const {
+    return rotation == rhs.rotation && position == rhs.position;
+}
+
+constexpr bool Pose::operator!=(const Pose& rhs) const {
+    return rotation != rhs.rotation || position != rhs.position;
+}
+
+inline std::ostream& operator<<(std::ostream& os, const Pose& pose) {
+    os << "[" << pose.rotation << ", " << pose.position << "]";
+    return os;
+}
+
+
+
+// ========================================================================== //
+//  inline functions for DualQuaternion
+// ========================================================================== //
+constexpr DualQuaternion::DualQuaternion(const Pose& pose)
+    : real(pose.rotation)
+    , dual(Quaternion(pose.position.x, pose.position.y, pose.position.z, 0.0f) * pose.rotation * 0.5f)
+{
+}
+
+inline DualQuaternion& DualQuaternion::normalize() {
+    float invLength = 1.0f / real.length();
+    real = real * invLength;
+    dual = dual * invLength;
+    return *this;
+}
+
+constexpr DualQuaternion DualQuaternion::conjugate() const {
+    return DualQuaternion(real.conjugate(), dual.conjugate());
+}
+
+constexpr Pose DualQuaternion::getPose() const {
+    Quaternion t = dual * real.conjugate();
+    return Pose(real, Vector3(2.0f * t.x, 2.0f * t.y, 2.0f * t.z));
+}
+
+constexpr DualQuaternion DualQuaternion::operator+(const DualQuaternion& rhs) const {
+    return DualQuaternion(real + rhs.real, dual + rhs.dual);
+}
+
+constexpr DualQuaternion DualQuaternion::operator*(const float a) const {
+    return DualQuaternion(real * a, dual * a);
+}
+
+constexpr DualQuaternion DualQuaternion::operator*(const DualQuaternion& rhs) const {
+    return DualQuaternion(real * rhs.real, real * rhs.dual + dual * rhs.real);
+}
+
+constexpr Vector3 DualQuaternion::operator*(const Vector3& p) const {
+    return getPose() * p;
+}
+
+
+
+// ========================================================================== //
+//  interpolation, t in [0, 1]
+// ========================================================================== //
+
+// rotation by nlerp, position linearly
+inline Pose Nlerp(const Pose& a, const Pose& b, float t)
+{
+    return Pose(Nlerp(a.rotation, b.rotation, t), a.position + (b.position - a.position) * t);
+}
+
+// rotation by slerp, position linearly
+inline Pose Slerp(const Pose& a, const Pose& b, float t)
+{
+    return Pose(Slerp(a.rotation, b.rotation, t), a.position + (b.position - a.position) * t);
+}
+
+// dual quaternion linear blending, approximates the screw motion from a to b
+inline DualQuaternion Nlerp(const DualQuaternion& a, const DualQuaternion& b, float t)
+{
+    // blend along the shorter arc
+    float wb = a.real.dot(b.real) < 0.0f ? -t : t;
+    DualQuaternion r = a * (1.0f - t) + b * wb;
+    return r.normalize();
+}
+
+
+
+#ifdef YUP_INCLUDE_OPENVR
+// ========================================================================== //
+//  OpenVR conversions, HmdMatrix34_t is row major [R | T]
+// ========================================================================== //
+inline Pose ToPose(const vr::HmdMatrix34_t& mat)
+{
+    return Pose(QuaternionFromRotation(mat.m[0][0], mat.m[0][1], mat.m[0][2],
+                                       mat.m[1][0], mat.m[1][1], mat.m[1][2],
+                                       mat.m[2][0], mat.m[2][1], mat.m[2][2]),
+                Vector3(mat.m[0][3], mat.m[1][3], mat.m[2][3]));
+}
+
+inline vr::HmdMatrix34_t ToHmdMatrix34(const Pose& pose)
+{
+    Matrix4 m = pose.getMatrix();
+    vr::HmdMatrix34_t mat;
+    for (int row = 0; row < 3; row++)
+        for (int col = 0; col < 4; col++)
+            mat.m[row][col] = m[col*4 + row];
+    return mat;
+}
+#endif // YUP_INCLUDE_OPENVR
+
+END_NAMESPACE_YUP
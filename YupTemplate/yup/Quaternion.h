@@ -0,0 +1,284 @@
+// ========================================================================== //
+//
+//  Quaternion.h
+//  ---
+//  Rotation quaternion q = w + xi + yj + zk
+//  The members are laid out as x, y, z, w like Vector4, so a quaternion can
+//  be loaded into one SSE register. Angles are in degree like Matrix4.
+//
+//  Created: 2016-08-24
+//  Updated: 2016-08-24
+//
+//  (C) 2016 Yu-hsien Chang
+//
+// ========================================================================== //
+
+#pragma once
+
+#include <cmath>
+#include <iostream>
+
+#include "yup.h"
+#include "Simd.h"
+#include "Vectors.h"
+#include "Matrices.h"
+
+BEGIN_NAMESPACE_YUP
+
+// ========================================================================== //
+//  Quaternion
+// ========================================================================== //
+struct Quaternion
+{
+    float x;
+    float y;
+    float z;
+    float w;
+
+    // ctors, default is identity rotation
+    constexpr Quaternion() : x(0), y(0), z(0), w(1) {};
+    constexpr Quaternion(float x, float y, float z, float w) : x(x), y(y), z(z), w(w) {};
+    Quaternion(const Vector3& axis, float angle);       // rotate angle(degree) along the axis
+    explicit Quaternion(const Matrix4& m);              // rotation part of a rigid matrix
+
+    // utils functions
+    constexpr void set(float x, float y, float z, float w);
+    float       length() const;                         //
+    Quaternion& normalize();                            //
+    constexpr float dot(const Quaternion& q) const;     // dot product
+    constexpr Quaternion conjugate() const;             // inverse of a unit quaternion
+    Quaternion  inverse() const;                        // inverse of any non-zero quaternion
+    Matrix4     getMatrix() const;                      // rotation matrix of a unit quaternion
+    void        getAxisAngle(Vector3& axis, float& angle) const; // angle in degree
+
+    // operators
+    constexpr Quaternion operator-() const;             // unary operator (negate)
+    constexpr Quaternion operator+(const Quaternion& rhs) const; // add rhs
+    constexpr Quaternion operator-(const Quaternion& rhs) const; // subtract rhs
+    constexpr Quaternion operator*(const float scale) const; // scale
+    constexpr Quaternion operator*(const Quaternion& rhs) const; // rotate by rhs, then by this
+    constexpr Quaternion& operator*=(const Quaternion& rhs); // multiply rhs and update this object
+    constexpr Vector3 operator*(const Vector3& v) const; // rotate v
+    constexpr bool operator==(const Quaternion& rhs) const; // exact compare, no epsilon
+    constexpr bool operator!=(const Quaternion& rhs) const; // exact compare, no epsilon
+
+    friend constexpr Quaternion operator*(const float a, const Quaternion& q);
+    friend std::ostream& operator<<(std::ostream& os, const Quaternion& q);
+};
+
+
+
+// Unit quaternion from the 3x3 rotation part of a matrix, mRC is row R column C
+inline Quaternion QuaternionFromRotation(float m00, float m01, float m02,
+                                         float m10, float m11, float m12,
+                                         float m20, float m21, float m22)
+{
+    // pick the largest of w, x, y, z to divide by
+    float trace = m00 + m11 + m22;
+    if (trace > 0.0f)
+    {
+        float s = 0.5f / sqrtf(trace + 1.0f);
+        return Quaternion((m21 - m12) * s, (m02 - m20) * s, (m10 - m01) * s, 0.25f / s);
+    }
+    else if (m00 > m11 && m00 > m22)
+    {
+        float s = 2.0f * sqrtf(1.0f + m00 - m11 - m22);
+        return Quaternion(0.25f * s, (m01 + m10) / s, (m02 + m20) / s, (m21 - m12) / s);
+    }
+    else if (m11 > m22)
+    {
+        float s = 2.0f * sqrtf(1.0f + m11 - m00 - m22);
+        return Quaternion((m01 + m10) / s, 0.25f * s, (m12 + m21) / s, (m02 - m20) / s);
+    }
+    else
+    {
+        float s = 2.0f * sqrtf(1.0f + m22 - m00 - m11);
+        return Quaternion((m02 + m20) / s, (m12 + m21) / s, 0.25f * s, (m10 - m01) / s);
+    }
+}
+
+
+
+// ========================================================================== //
+//  inline functions for Quaternion
+// ========================================================================== //
+inline Quaternion::Quaternion(const Vector3& axis, float angle)
+{
+    const float DEG2RAD = 3.141593f / 180.0f;
+    float half = 0.5f * angle * DEG2RAD;
+    float s = sinf(half) / axis.length();
+    set(axis.x * s, axis.y * s, axis.z * s, cosf(half));
+}
+
+inline Quaternion::Quaternion(const Matrix4& m) {
+    *this = QuaternionFromRotation(m[0], m[4], m[8],
+                                   m[1], m[5], m[9],
+                                   m[2], m[6], m[10]);
+}
+
+constexpr void Quaternion::set(float x, float y, float z, float w) {
+    this->x = x; this->y = y; this->z = z; this->w = w;
+}
+
+inline float Quaternion::length() const {
+    return sqrtf(dot(*this));
+}
+
+inline Quaternion& Quaternion::normalize() {
+    float invLength = 1.0f / length();
+    x *= invLength; y *= invLength; z *= invLength; w *= invLength;
+    return *this;
+}
+
+// summed pairwise like the SSE code in Nlerp()
+constexpr float Quaternion::dot(const Quaternion& q) const {
+    return (x*q.x + y*q.y) + (z*q.z + w*q.w);
+}
+
+constexpr Quaternion Quaternion::conjugate() const {
+    return Quaternion(-x, -y, -z, w);
+}
+
+inline Quaternion Quaternion::inverse() const {
+    return conjugate() * (1.0f / dot(*this));
+}
+
+inline Matrix4 Quaternion::getMatrix() const {
+    float xx = x*x, yy = y*y, zz = z*z;
+    float xy = x*y, xz = x*z, yz = y*z;
+    float wx = w*x, wy = w*y, wz = w*z;
+    return Matrix4(1.0f - 2.0f*(yy + zz), 2.0f*(xy + wz),        2.0f*(xz - wy),        0.0f,
+                   2.0f*(xy - wz),        1.0f - 2.0f*(xx + zz), 2.0f*(yz + wx),        0.0f,
+                   2.0f*(xz + wy),        2.0f*(yz - wx),        1.0f - 2.0f*(xx + yy), 0.0f,
+                   0.0f,                  0.0f,                  0.0f,                  1.0f);
+}
+
+inline void Quaternion::getAxisAngle(Vector3& axis, float& angle) const {
+    const float RAD2DEG = 180.0f / 3.141593f;
+    float s = sqrtf(x*x + y*y + z*z);
+    if (s < 0.000001f)
+    {
+        // no rotation, any axis will do
+        axis.set(1.0f, 0.0f, 0.0f);
+        angle = 0.0f;
+        return;
+    }
+    axis.set(x / s, y / s, z / s);
+    angle = 2.0f * atan2f(s, w) * RAD2DEG;
+}
+
+constexpr Quaternion Quaternion::operator-() const {
+    return Quaternion(-x, -y, -z, -w);
+}
+
+constexpr Quaternion Quaternion::operator+(const Quaternion& rhs) const {
+    return Quaternion(x+rhs.x, y+rhs.y, z+rhs.z, w+rhs.w);
+}
+
+constexpr Quaternion Quaternion::operator-(const Quaternion& rhs) const {
+    return Quaternion(x-rhs.x, y-rhs.y, z-rhs.z, w-rhs.w);
+}
+
+constexpr Quaternion Quaternion::operator*(const float a) const {
+    return Quaternion(x*a, y*a, z*a, w*a);
+}
+
+constexpr Quaternion Quaternion::operator*(const Quaternion& q) const {
+    return Quaternion(w*q.x + x*q.w + y*q.z - z*q.y,
+                      w*q.y - x*q.z + y*q.w + z*q.x,
+                      w*q.z + x*q.y - y*q.x + z*q.w,
+                      w*q.w - x*q.x - y*q.y - z*q.z);
+}
+
+constexpr Quaternion& Quaternion::operator*=(const Quaternion& rhs) {
+    *this = *this * rhs; return *this;
+}
+
+// v' = v + w*t + u x t, with t = 2 * u x v and u = (x, y, z)
+constexpr Vector3 Quaternion::operator*(const Vector3& v) const {
+    float tx = 2.0f * (y*v.z - z*v.y);
+    float ty = 2.0f * (z*v.x - x*v.z);
+    float tz = 2.0f * (x*v.y - y*v.x);
+    return Vector3(v.x + w*tx + (y*tz - z*ty),
+                   v.y + w*ty + (z*tx - x*tz),
+                   v.z + w*tz + (x*ty - y*tx));
+}
+
+constexpr bool Quaternion::operator==(const Quaternion& rhs) const {
+    return (x == rhs.x) && (y == rhs.y) && (z == rhs.z) && (w == rhs.w);
+}
+
+constexpr bool Quaternion::operator!=(const Quaternion& rhs) const {
+    return (x != rhs.x) || (y != rhs.y) || (z != rhs.z) || (w != rhs.w);
+}
+
+constexpr Quaternion operator*(const float a, const Quaternion& q) {
+    return Quaternion(a*q.x, a*q.y, a*q.z, a*q.w);
+}
+
+inline std::ostream& operator<<(std::ostream& os, const Quaternion& q) {
+    os << "(" << q.x << ", " << q.y << ", " << q.z << ", " << q.w << ")";
+    return os;
+}
+
+
+
+// ========================================================================== //
+//  interpolation, t in [0, 1], both along the shorter arc
+// ========================================================================== //
+
+// normalized linear interpolation, cheap but not constant speed
+inline Quaternion Nlerp(const Quaternion& a, const Quaternion& b, float t)
+{
+#ifdef YUP_SIMD_SSE2
+    const __m128 qa = _mm_loadu_ps(&a.x);
+    __m128 qb = _mm_loadu_ps(&b.x);
+
+    // dot product as (x + y) + (z + w), broadcast to all lanes
+    __m128 m = _mm_mul_ps(qa, qb);
+    __m128 s = _mm_add_ps(m, _mm_shuffle_ps(m, m, _MM_SHUFFLE(2, 3, 0, 1)));
+    __m128 d = _mm_add_ps(s, _mm_shuffle_ps(s, s, _MM_SHUFFLE(1, 0, 3, 2)));
+
+    // flip b into the same hemisphere by the sign of the dot product
+    qb = _mm_xor_ps(qb, _mm_and_ps(d, _mm_set1_ps(-0.0f)));
+
+    __m128 r = _mm_add_ps(qa, _mm_mul_ps(_mm_sub_ps(qb, qa), _mm_set1_ps(t)));
+
+    m = _mm_mul_ps(r, r);
+    s = _mm_add_ps(m, _mm_shuffle_ps(m, m, _MM_SHUFFLE(2, 3, 0, 1)));
+    d = _mm_add_ps(s, _mm_shuffle_ps(s, s, _MM_SHUFFLE(1, 0, 3, 2)));
+    r = _mm_mul_ps(r, _mm_div_ps(_mm_set1_ps(1.0f), _mm_sqrt_ps(d)));
+
+    Quaternion q;
+    _mm_storeu_ps(&q.x, r);
+    return q;
+#else
+    Quaternion c = a.dot(b) < 0.0f ? -b : b;
+    Quaternion r = a + (c - a) * t;
+    return r.normalize();
+#endif
+}
+
+
+
+// spherical linear interpolation, constant angular speed
+inline Quaternion Slerp(const Quaternion& a, const Quaternion& b, float t)
+{
+    float d = a.dot(b);
+    Quaternion c = b;
+    if (d < 0.0f)
+    {
+        d = -d;
+        c = -b;
+    }
+
+    // nearly parallel, sin(theta) is too small to divide by
+    if (d > 0.9995f)
+        return Nlerp(a, c, t);
+
+    float theta = acosf(d);
+    float invSin = 1.0f / sinf(theta);
+    return a * (sinf((1.0f - t) * theta) * invSin) + c * (sinf(t * theta) * invSin);
+}
+
+END_NAMESPACE_YUP
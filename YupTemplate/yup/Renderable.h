@@ -20,6 +20,7 @@
 #include "yup.h"
 #include "inc_sdl.h"
 #include "Matrices.h"
+#include "Frustum.h"
 
 BEGIN_NAMESPACE_YUP_GL
 
@@ -39,6 +40,10 @@ public:
 	
 	// Called by the parent once per frame
 	virtual void onUpdate(const Matrix4 &headPose) {}
+
+	// Called before rendering a view (the flat display, or both eyes at once)
+	// with a frustum that contains everything visible in it
+	virtual void onCull(const Frustum &frustum) {}
 	
 	// Stop all tasks and clean up
 	virtual void onShutdown() {}
@@ -23,6 +23,7 @@
 #include "ShaderSource.h"
 #include "GlUtil.h"
 #include "Matrices.h"
+#include "DepthMap.h"				// DEPTHMODE_*
 
 #define TEXTURE_RGB			GL_TEXTURE0
 #define TEXTURE_YUV_Y		GL_TEXTURE0
@@ -40,11 +41,6 @@
 #define COLORMODE_RGB				0
 #define COLORMODE_YUV				1
 
-#define DEPTHMODE_NONE				0
-#define DEPTHMODE_LINEAR			1
-#define DEPTHMODE_REVERSED_LINEAR	2
-#define DEPTHMODE_INVERSE			3
-
 BEGIN_NAMESPACE_YUP_GL
 
 //============================================================================//
@@ -0,0 +1,77 @@
+// ========================================================================== //
+//
+//  Simd.h
+//  ---
+//  Compile time selection of the SIMD instruction sets used by the kernels.
+//  Define YUP_NO_SIMD to force the scalar code paths everywhere.
+//
+//  There is no run time dispatch: yup.props builds with /arch:AVX2, so the
+//  SSE2, SSSE3, AVX, AVX2 and F16C paths are in and the minimum CPU is one
+//  with AVX2 and F16C (Intel Haswell, AMD Excavator / Zen). The AVX-512
+//  paths need /arch:AVX512 (VS 2019) and are left out of that build.
+//
+//  Created: 2016-08-24
+//  Updated: 2016-08-24
+//
+//  (C) 2016 Yu-hsien Chang
+//
+// ========================================================================== //
+
+#pragma once
+
+#include "yup.h"
+
+#ifndef YUP_NO_SIMD
+
+// SSE/SSE2 are always present on x64, /arch:SSE2 on x86
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define YUP_SIMD_SSE2
+#include <emmintrin.h>
+#endif
+
+// MSVC has no switch for SSSE3 alone; /arch:AVX implies it
+#if defined(__SSSE3__) || (defined(_MSC_VER) && defined(__AVX__))
+#define YUP_SIMD_SSSE3
+#include <tmmintrin.h>
+#endif
+
+#if defined(__AVX__)
+#define YUP_SIMD_AVX
+#include <immintrin.h>
+#endif
+
+#if defined(__AVX2__)
+#define YUP_SIMD_AVX2
+#endif
+
+// F16C (float <-> half) comes with every AVX2 CPU; MSVC has no switch for it
+#if defined(__F16C__) || (defined(_MSC_VER) && defined(__AVX2__))
+#define YUP_SIMD_F16C
+#endif
+
+#if defined(__AVX512F__)
+#define YUP_SIMD_AVX512
+#endif
+
+#endif // YUP_NO_SIMD
+
+// Lets constexpr functions fall back to their scalar code during constant
+// evaluation and use the intrinsics at run time. Needs VS 2019 16.5
+// (_MSC_VER 1925), the v141 toolset of the project predates it, so there
+// the SIMD products (Matrix4 * Matrix4 ...) are inline but not constexpr.
+#if (defined(__clang__) && __clang_major__ >= 9) || \
+    (defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 9) || \
+    (defined(_MSC_VER) && _MSC_VER >= 1925)
+#define YUP_HAS_IS_CONSTANT_EVALUATED
+#define YUP_IS_CONSTANT_EVALUATED() __builtin_is_constant_evaluated()
+#else
+#define YUP_IS_CONSTANT_EVALUATED() false
+#endif
+
+// For functions with a SIMD body: constexpr whenever the scalar path can be
+// selected at compile time, plain inline otherwise.
+#if !defined(YUP_SIMD_SSE2) || defined(YUP_HAS_IS_CONSTANT_EVALUATED)
+#define YUP_SIMD_CONSTEXPR constexpr
+#else
+#define YUP_SIMD_CONSTEXPR inline
+#endif
@@ -0,0 +1,358 @@
+// ========================================================================== //
+//
+//  Transform.cpp
+//  ---
+//  The SIMD paths keep the operation order of Matrix4 * Vector3, so every
+//  path gives the same result as the scalar loop.
+//
+//  Created: 2016-08-24
+//  Updated: 2016-08-24
+//
+//  (C) 2016 Yu-hsien Chang
+//
+// ========================================================================== //
+
+#include "Transform.h"
+#include "Simd.h"
+
+BEGIN_NAMESPACE_YUP
+
+// -------------------------------------------------------------------------- //
+//  scalar, also used for the remainder of the SIMD loops
+// -------------------------------------------------------------------------- //
+static inline void TransformPoint(const float* m, float x, float y, float z, float& ox, float& oy, float& oz)
+{
+    ox = m[0]*x + m[4]*y + m[8]*z  + m[12];
+    oy = m[1]*x + m[5]*y + m[9]*z  + m[13];
+    oz = m[2]*x + m[6]*y + m[10]*z + m[14];
+}
+
+static inline void TransformPointProjective(const float* m, float x, float y, float z, float& ox, float& oy, float& oz)
+{
+    float w = m[3]*x + m[7]*y + m[11]*z + m[15];
+    TransformPoint(m, x, y, z, ox, oy, oz);
+    ox /= w;  oy /= w;  oz /= w;
+}
+
+
+
+#if defined(YUP_SIMD_SSE2)
+// -------------------------------------------------------------------------- //
+//  4 points per iteration
+// -------------------------------------------------------------------------- //
+struct Matrix4x4
+{
+    __m128 m[16];
+    Matrix4x4(const float* src) { for(int i = 0; i < 16; ++i) m[i] = _mm_set1_ps(src[i]); }
+};
+
+static inline void Transform4(const Matrix4x4& M, __m128& x, __m128& y, __m128& z, bool projective)
+{
+    const __m128* m = M.m;
+    __m128 ox = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(m[0], x), _mm_mul_ps(m[4], y)), _mm_mul_ps(m[8], z)),  m[12]);
+    __m128 oy = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(m[1], x), _mm_mul_ps(m[5], y)), _mm_mul_ps(m[9], z)),  m[13]);
+    __m128 oz = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(m[2], x), _mm_mul_ps(m[6], y)), _mm_mul_ps(m[10], z)), m[14]);
+    if(projective)
+    {
+        __m128 w = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(m[3], x), _mm_mul_ps(m[7], y)), _mm_mul_ps(m[11], z)), m[15]);
+        ox = _mm_div_ps(ox, w);
+        oy = _mm_div_ps(oy, w);
+        oz = _mm_div_ps(oz, w);
+    }
+    x = ox;  y = oy;  z = oz;
+}
+
+// x0 y0 z0 x1 | y1 z1 x2 y2 | z2 x3 y3 z3  ->  x0..x3, y0..y3, z0..z3
+static inline void Deinterleave4(const float* p, __m128& x, __m128& y, __m128& z)
+{
+    __m128 a = _mm_loadu_ps(p);
+    __m128 b = _mm_loadu_ps(p + 4);
+    __m128 c = _mm_loadu_ps(p + 8);
+    __m128 xy = _mm_shuffle_ps(b, c, _MM_SHUFFLE(2,1,3,2));     // x2 y2 x3 y3
+    __m128 yz = _mm_shuffle_ps(a, b, _MM_SHUFFLE(1,0,2,1));     // y0 z0 y1 z1
+    x = _mm_shuffle_ps(a, xy, _MM_SHUFFLE(2,0,3,0));
+    y = _mm_shuffle_ps(yz, xy, _MM_SHUFFLE(3,1,2,0));
+    z = _mm_shuffle_ps(yz, c, _MM_SHUFFLE(3,0,3,1));
+}
+
+static inline void Interleave4(float* p, __m128 x, __m128 y, __m128 z)
+{
+    __m128 xy = _mm_shuffle_ps(x, y, _MM_SHUFFLE(2,0,2,0));     // x0 x2 y0 y2
+    __m128 yz = _mm_shuffle_ps(y, z, _MM_SHUFFLE(3,1,3,1));     // y1 y3 z1 z3
+    __m128 zx = _mm_shuffle_ps(z, x, _MM_SHUFFLE(3,1,2,0));     // z0 z2 x1 x3
+    _mm_storeu_ps(p,     _mm_shuffle_ps(xy, zx, _MM_SHUFFLE(2,0,2,0)));
+    _mm_storeu_ps(p + 4, _mm_shuffle_ps(yz, xy, _MM_SHUFFLE(3,1,2,0)));
+    _mm_storeu_ps(p + 8, _mm_shuffle_ps(zx, yz, _MM_SHUFFLE(3,1,3,1)));
+}
+#endif // YUP_SIMD_SSE2
+
+
+
+#if defined(YUP_SIMD_AVX)
+// -------------------------------------------------------------------------- //
+//  8 points per iteration
+// -------------------------------------------------------------------------- //
+struct Matrix8x4
+{
+    __m256 m[16];
+    Matrix8x4(const float* src) { for(int i = 0; i < 16; ++i) m[i] = _mm256_set1_ps(src[i]); }
+};
+
+static inline void Transform8(const Matrix8x4& M, __m256& x, __m256& y, __m256& z, bool projective)
+{
+    const __m256* m = M.m;
+    __m256 ox = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m[0], x), _mm256_mul_ps(m[4], y)), _mm256_mul_ps(m[8], z)),  m[12]);
+    __m256 oy = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m[1], x), _mm256_mul_ps(m[5], y)), _mm256_mul_ps(m[9], z)),  m[13]);
+    __m256 oz = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m[2], x), _mm256_mul_ps(m[6], y)), _mm256_mul_ps(m[10], z)), m[14]);
+    if(projective)
+    {
+        __m256 w = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m[3], x), _mm256_mul_ps(m[7], y)), _mm256_mul_ps(m[11], z)), m[15]);
+        ox = _mm256_div_ps(ox, w);
+        oy = _mm256_div_ps(oy, w);
+        oz = _mm256_div_ps(oz, w);
+    }
+    x = ox;  y = oy;  z = oz;
+}
+
+// same shuffles as Deinterleave4, with points 0-3 in the low lane and 4-7 in the high lane
+static inline void Deinterleave8(const float* p, __m256& x, __m256& y, __m256& z)
+{
+    __m256 a = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(p)),     _mm_loadu_ps(p + 12), 1);
+    __m256 b = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(p + 4)), _mm_loadu_ps(p + 16), 1);
+    __m256 c = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(p + 8)), _mm_loadu_ps(p + 20), 1);
+    __m256 xy = _mm256_shuffle_ps(b, c, _MM_SHUFFLE(2,1,3,2));
+    __m256 yz = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(1,0,2,1));
+    x = _mm256_shuffle_ps(a, xy, _MM_SHUFFLE(2,0,3,0));
+    y = _mm256_shuffle_ps(yz, xy, _MM_SHUFFLE(3,1,2,0));
+    z = _mm256_shuffle_ps(yz, c, _MM_SHUFFLE(3,0,3,1));
+}
+
+static inline void Interleave8(float* p, __m256 x, __m256 y, __m256 z)
+{
+    __m256 xy = _mm256_shuffle_ps(x, y, _MM_SHUFFLE(2,0,2,0));
+    __m256 yz = _mm256_shuffle_ps(y, z, _MM_SHUFFLE(3,1,3,1));
+    __m256 zx = _mm256_shuffle_ps(z, x, _MM_SHUFFLE(3,1,2,0));
+    __m256 a = _mm256_shuffle_ps(xy, zx, _MM_SHUFFLE(2,0,2,0));
+    __m256 b = _mm256_shuffle_ps(yz, xy, _MM_SHUFFLE(3,1,2,0));
+    __m256 c = _mm256_shuffle_ps(zx, yz, _MM_SHUFFLE(3,1,3,1));
+    _mm_storeu_ps(p,      _mm256_castps256_ps128(a));
+    _mm_storeu_ps(p + 4,  _mm256_castps256_ps128(b));
+    _mm_storeu_ps(p + 8,  _mm256_castps256_ps128(c));
+    _mm_storeu_ps(p + 12, _mm256_extractf128_ps(a, 1));
+    _mm_storeu_ps(p + 16, _mm256_extractf128_ps(b, 1));
+    _mm_storeu_ps(p + 20, _mm256_extractf128_ps(c, 1));
+}
+#endif // YUP_SIMD_AVX
+
+
+
+#if defined(YUP_SIMD_AVX512)
+// -------------------------------------------------------------------------- //
+//  16 points per iteration, SoA only
+// -------------------------------------------------------------------------- //
+struct Matrix16x4
+{
+    __m512 m[16];
+    Matrix16x4(const float* src) { for(int i = 0; i < 16; ++i) m[i] = _mm512_set1_ps(src[i]); }
+};
+
+static inline void Transform16(const Matrix16x4& M, __m512& x, __m512& y, __m512& z, bool projective)
+{
+    const __m512* m = M.m;
+    __m512 ox = _mm512_add_ps(_mm512_add_ps(_mm512_add_ps(_mm512_mul_ps(m[0], x), _mm512_mul_ps(m[4], y)), _mm512_mul_ps(m[8], z)),  m[12]);
+    __m512 oy = _mm512_add_ps(_mm512_add_ps(_mm512_add_ps(_mm512_mul_ps(m[1], x), _mm512_mul_ps(m[5], y)), _mm512_mul_ps(m[9], z)),  m[13]);
+    __m512 oz = _mm512_add_ps(_mm512_add_ps(_mm512_add_ps(_mm512_mul_ps(m[2], x), _mm512_mul_ps(m[6], y)), _mm512_mul_ps(m[10], z)), m[14]);
+    if(projective)
+    {
+        __m512 w = _mm512_add_ps(_mm512_add_ps(_mm512_add_ps(_mm512_mul_ps(m[3], x), _mm512_mul_ps(m[7], y)), _mm512_mul_ps(m[11], z)), m[15]);
+        ox = _mm512_div_ps(ox, w);
+        oy = _mm512_div_ps(oy, w);
+        oz = _mm512_div_ps(oz, w);
+    }
+    x = ox;  y = oy;  z = oz;
+}
+#endif // YUP_SIMD_AVX512
+
+
+
+// -------------------------------------------------------------------------- //
+//  AoS
+// -------------------------------------------------------------------------- //
+static void TransformPointsAoS(const Matrix4& mat, const float* xyz, float* out, size_t n, bool projective)
+{
+    const float* m = mat.get();
+    size_t i = 0;
+
+#if defined(YUP_SIMD_AVX)
+    const Matrix8x4 m8(m);
+    for(; i + 8 <= n; i += 8)
+    {
+        __m256 x, y, z;
+        Deinterleave8(xyz + i*3, x, y, z);
+        Transform8(m8, x, y, z, projective);
+        Interleave8(out + i*3, x, y, z);
+    }
+#endif
+
+#if defined(YUP_SIMD_SSE2)
+    const Matrix4x4 m4(m);
+    for(; i + 4 <= n; i += 4)
+    {
+        __m128 x, y, z;
+        Deinterleave4(xyz + i*3, x, y, z);
+        Transform4(m4, x, y, z, projective);
+        Interleave4(out + i*3, x, y, z);
+    }
+#endif
+
+    for(; i < n; ++i)
+    {
+        const float* p = xyz + i*3;
+        float* o = out + i*3;
+        if(projective)
+            TransformPointProjective(m, p[0], p[1], p[2], o[0], o[1], o[2]);
+        else
+            TransformPoint(m, p[0], p[1], p[2], o[0], o[1], o[2]);
+    }
+}
+
+void TransformPoints(const Matrix4& m, const float* xyz, float* out, size_t n)
+{
+    TransformPointsAoS(m, xyz, out, n, false);
+}
+
+void TransformPointsProjective(const Matrix4& m, const float* xyz, float* out, size_t n)
+{
+    TransformPointsAoS(m, xyz, out, n, true);
+}
+
+
+
+// -------------------------------------------------------------------------- //
+//  SoA
+// -------------------------------------------------------------------------- //
+static void TransformPointsSoA(const Matrix4& mat,
+                               const float* px, const float* py, const float* pz,
+                               float* ox, float* oy, float* oz, size_t n, bool projective)
+{
+    const float* m = mat.get();
+    size_t i = 0;
+
+#if defined(YUP_SIMD_AVX512)
+    const Matrix16x4 m16(m);
+    for(; i + 16 <= n; i += 16)
+    {
+        __m512 x = _mm512_loadu_ps(px + i), y = _mm512_loadu_ps(py + i), z = _mm512_loadu_ps(pz + i);
+        Transform16(m16, x, y, z, projective);
+        _mm512_storeu_ps(ox + i, x);  _mm512_storeu_ps(oy + i, y);  _mm512_storeu_ps(oz + i, z);
+    }
+#endif
+
+#if defined(YUP_SIMD_AVX)
+    const Matrix8x4 m8(m);
+    for(; i + 8 <= n; i += 8)
+    {
+        __m256 x = _mm256_loadu_ps(px + i), y = _mm256_loadu_ps(py + i), z = _mm256_loadu_ps(pz + i);
+        Transform8(m8, x, y, z, projective);
+        _mm256_storeu_ps(ox + i, x);  _mm256_storeu_ps(oy + i, y);  _mm256_storeu_ps(oz + i, z);
+    }
+#endif
+
+#if defined(YUP_SIMD_SSE2)
+    const Matrix4x4 m4(m);
+    for(; i + 4 <= n; i += 4)
+    {
+        __m128 x = _mm_loadu_ps(px + i), y = _mm_loadu_ps(py + i), z = _mm_loadu_ps(pz + i);
+        Transform4(m4, x, y, z, projective);
+        _mm_storeu_ps(ox + i, x);  _mm_storeu_ps(oy + i, y);  _mm_storeu_ps(oz + i, z);
+    }
+#endif
+
+    for(; i < n; ++i)
+    {
+        if(projective)
+            TransformPointProjective(m, px[i], py[i], pz[i], ox[i], oy[i], oz[i]);
+        else
+            TransformPoint(m, px[i], py[i], pz[i], ox[i], oy[i], oz[i]);
+    }
+}
+
+void TransformPoints(const Matrix4& m,
+                     const float* x, const float* y, const float* z,
+                     float* outX, float* outY, float* outZ, size_t n)
+{
+    TransformPointsSoA(m, x, y, z, outX, outY, outZ, n, false);
+}
+
+void TransformPointsProjective(const Matrix4& m,
+                               const float* x, const float* y, const float* z,
+                               float* outX, float* outY, float* outZ, size_t n)
+{
+    TransformPointsSoA(m, x, y, z, outX, outY, outZ, n, true);
+}
+
+
+
+// -------------------------------------------------------------------------- //
+//  inverses
+// -------------------------------------------------------------------------- //
+void InvertMatrices(const RigidMatrix4* in, RigidMatrix4* out, size_t n)
+{
+#if defined(YUP_SIMD_SSE2)
+    // keeps the 4th row, like invertEuclidean()
+    const __m128 keepW = _mm_castsi128_ps(_mm_set_epi32(-1, 0, 0, 0));
+    for(size_t i = 0; i < n; ++i)
+    {
+        const float* m = in[i].get();
+        const __m128 w0 = _mm_loadu_ps(m), w1 = _mm_loadu_ps(m + 4), w2 = _mm_loadu_ps(m + 8);
+        __m128 c0 = w0, c1 = w1, c2 = w2, c3 = _mm_loadu_ps(m + 12);
+        const __m128 x = _mm_set1_ps(m[12]), y = _mm_set1_ps(m[13]), z = _mm_set1_ps(m[14]);
+        const float w3 = m[15];
+
+        // R^T, the rows of the input become the columns
+        _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+        c0 = _mm_or_ps(_mm_andnot_ps(keepW, c0), _mm_and_ps(keepW, w0));
+        c1 = _mm_or_ps(_mm_andnot_ps(keepW, c1), _mm_and_ps(keepW, w1));
+        c2 = _mm_or_ps(_mm_andnot_ps(keepW, c2), _mm_and_ps(keepW, w2));
+
+        // -R^T * T
+        __m128 t = _mm_mul_ps(c0, x);
+        t = _mm_add_ps(t, _mm_mul_ps(c1, y));
+        t = _mm_add_ps(t, _mm_mul_ps(c2, z));
+        t = _mm_xor_ps(t, _mm_set1_ps(-0.0f));
+
+        float* o = &out[i][0];
+        _mm_storeu_ps(o, c0);
+        _mm_storeu_ps(o + 4, c1);
+        _mm_storeu_ps(o + 8, c2);
+        _mm_storeu_ps(o + 12, t);
+        o[15] = w3;
+    }
+#else
+    for(size_t i = 0; i < n; ++i)
+    {
+        out[i] = in[i];
+        out[i].invert();
+    }
+#endif
+}
+
+void InvertMatrices(const AffineMatrix4* in, AffineMatrix4* out, size_t n)
+{
+    for(size_t i = 0; i < n; ++i)
+    {
+        out[i] = in[i];
+        out[i].invert();
+    }
+}
+
+void InvertMatrices(const Matrix4* in, Matrix4* out, size_t n)
+{
+    for(size_t i = 0; i < n; ++i)
+    {
+        out[i] = in[i];
+        out[i].invert();
+    }
+}
+
+END_NAMESPACE_YUP
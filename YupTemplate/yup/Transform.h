@@ -0,0 +1,56 @@
+// ========================================================================== //
+//
+//  Transform.h
+//  ---
+//  Batched point transforms and inverses with Matrix4
+//
+//  Points are either interleaved (AoS: x0 y0 z0 x1 y1 z1 ...) or stored as
+//  three separate streams (SoA). The affine variants ignore the 4th row of
+//  the matrix like Matrix4 * Vector3 does, the projective variants divide by
+//  the transformed w. Input and output may be the same buffer.
+//
+//  Created: 2016-08-24
+//  Updated: 2016-08-24
+//
+//  (C) 2016 Yu-hsien Chang
+//
+// ========================================================================== //
+
+#pragma once
+
+#include <cstddef>
+
+#include "yup.h"
+#include "Matrices.h"
+
+BEGIN_NAMESPACE_YUP
+
+// AoS, n points of 3 floats each
+void TransformPoints(const Matrix4& m, const float* xyz, float* out, size_t n);
+void TransformPointsProjective(const Matrix4& m, const float* xyz, float* out, size_t n);
+
+// SoA, n points in 3 separate streams
+void TransformPoints(const Matrix4& m,
+                     const float* x, const float* y, const float* z,
+                     float* outX, float* outY, float* outZ, size_t n);
+void TransformPointsProjective(const Matrix4& m,
+                               const float* x, const float* y, const float* z,
+                               float* outX, float* outY, float* outZ, size_t n);
+
+// Vector3 arrays are laid out as AoS
+inline void TransformPoints(const Matrix4& m, const Vector3* points, Vector3* out, size_t n)
+{
+    TransformPoints(m, &points[0].x, &out[0].x, n);
+}
+
+inline void TransformPointsProjective(const Matrix4& m, const Vector3* points, Vector3* out, size_t n)
+{
+    TransformPointsProjective(m, &points[0].x, &out[0].x, n);
+}
+
+// n matrices, same results as invert() of each type, in and out may be the same array
+void InvertMatrices(const RigidMatrix4* in, RigidMatrix4* out, size_t n);
+void InvertMatrices(const AffineMatrix4* in, AffineMatrix4* out, size_t n);
+void InvertMatrices(const Matrix4* in, Matrix4* out, size_t n);
+
+END_NAMESPACE_YUP
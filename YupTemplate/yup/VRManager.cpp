@@ -15,6 +15,7 @@
 #include "VRManager.h"
 #include "GlUtil.h"
 #include "Log.h"
+#include "MatrixExpr.h"
 
 #include <vector>
 
@@ -298,8 +299,9 @@ void VRManager::RenderDisplay()
 		float aspectRatio = (float)mDisplayWidth / (float)mDisplayHeight;
 		proj.perspective(mDisplayFov, aspectRatio, mNearClip, mFarClip);
 
-		Matrix4 eye;
-		mScene->onRender(proj*m_mat4HMDPose, mDisplayWidth, mDisplayHeight);
+		Matrix4 vpMat = Lazy(proj) * m_mat4HMDPose;
+		mScene->onCull(Frustum(vpMat));
+		mScene->onRender(vpMat, mDisplayWidth, mDisplayHeight);
 	}
 }
 
@@ -455,6 +457,14 @@ void VRManager::RenderStereoTargets()
 	glClearColor(0.15f, 0.15f, 0.18f, 1.0f); // nice background color, but not black
 	glEnable(GL_MULTISAMPLE);
 
+	// cull once for both eyes
+	if (mScene != nullptr)
+	{
+		Frustum left(GetCurrentViewProjectionMatrix(vr::Eye_Left));
+		Frustum right(GetCurrentViewProjectionMatrix(vr::Eye_Right));
+		mScene->onCull(Frustum::Combine(left, right));
+	}
+
 	// Left Eye
 	glBindFramebuffer(GL_FRAMEBUFFER, leftEyeDesc.m_nRenderFramebufferId);
 	glViewport(0, 0, m_nRenderWidth, m_nRenderHeight);
@@ -503,9 +513,10 @@ void VRManager::RenderScene(vr::Hmd_Eye nEye)
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 	glEnable(GL_DEPTH_TEST);
 
+	Matrix4 vpMat = GetCurrentViewProjectionMatrix(nEye);
+
 	if (mScene != nullptr)
 	{
-		Matrix4 vpMat = GetCurrentViewProjectionMatrix(nEye);
 		mScene->onRenderEye(nEye, vpMat);
 	}
 
@@ -514,7 +525,7 @@ void VRManager::RenderScene(vr::Hmd_Eye nEye)
 	{
 		// draw the controller axis lines
 		glUseProgram(m_unControllerTransformProgramID);
-		glUniformMatrix4fv(m_nControllerMatrixLocation, 1, GL_FALSE, GetCurrentViewProjectionMatrix(nEye).get());
+		glUniformMatrix4fv(m_nControllerMatrixLocation, 1, GL_FALSE, vpMat.get());
 		glBindVertexArray(m_unControllerVAO);
 		glDrawArrays(GL_LINES, 0, m_uiControllerVertcount);
 		glBindVertexArray(0);
@@ -535,7 +546,7 @@ void VRManager::RenderScene(vr::Hmd_Eye nEye)
 				continue;
 
 			const Matrix4 & matDeviceToTracking = m_rmat4DevicePose[unTrackedDevice];
-			Matrix4 matMVP = GetCurrentViewProjectionMatrix(nEye) * matDeviceToTracking;
+			Matrix4 matMVP = Lazy(vpMat) * matDeviceToTracking;
 			glUniformMatrix4fv(m_nRenderModelMatrixLocation, 1, GL_FALSE, matMVP.get());
 
 			m_rTrackedDeviceToRenderModel[unTrackedDevice]->Draw();
@@ -697,11 +708,11 @@ Matrix4 VRManager::GetCurrentViewProjectionMatrix(vr::Hmd_Eye nEye)
 	Matrix4 matMVP;
 	if (nEye == vr::Eye_Left)
 	{
-		matMVP = m_mat4ProjectionLeft * m_mat4eyePosLeft * m_mat4HMDPose;
+		matMVP = Lazy(m_mat4ProjectionLeft) * m_mat4eyePosLeft * m_mat4HMDPose;
 	}
 	else if (nEye == vr::Eye_Right)
 	{
-		matMVP = m_mat4ProjectionRight * m_mat4eyePosRight *  m_mat4HMDPose;
+		matMVP = Lazy(m_mat4ProjectionRight) * m_mat4eyePosRight * m_mat4HMDPose;
 	}
 
 	return matMVP;
@@ -725,7 +736,8 @@ void VRManager::UpdateHMDMatrixPose()
 		if (m_rTrackedDevicePose[nDevice].bPoseIsValid)
 		{
 			m_iValidPoseCount++;
-			m_rmat4DevicePose[nDevice] = ConvertSteamVRMatrixToMatrix4(m_rTrackedDevicePose[nDevice].mDeviceToAbsoluteTracking);
+			m_rmat4DevicePose[nDevice] = RigidMatrix4(ConvertSteamVRMatrixToMatrix4(m_rTrackedDevicePose[nDevice].mDeviceToAbsoluteTracking));
+			m_rDevicePose[nDevice] = ToPose(m_rTrackedDevicePose[nDevice].mDeviceToAbsoluteTracking);
 			if (m_rDevClassChar[nDevice] == 0)
 			{
 				switch (m_pHMD->GetTrackedDeviceClass(nDevice))
@@ -744,7 +756,8 @@ void VRManager::UpdateHMDMatrixPose()
 
 	if (m_rTrackedDevicePose[vr::k_unTrackedDeviceIndex_Hmd].bPoseIsValid)
 	{
-		m_mat4HMDPose = m_rmat4DevicePose[vr::k_unTrackedDeviceIndex_Hmd].invert();
+		// only the HMD pose is used inverted, and it is rigid
+		m_mat4HMDPose = RigidMatrix4(m_rmat4DevicePose[vr::k_unTrackedDeviceIndex_Hmd]).invert();
 
 		if (mScene)
 			mScene->onUpdate(m_mat4HMDPose);
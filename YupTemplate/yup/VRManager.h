@@ -23,6 +23,7 @@
 #include "inc_sdl.h"
 #include "Renderable.h"
 #include "Matrices.h"
+#include "Pose.h"
 
 #include "VRRenderModel.h"
 
@@ -102,6 +103,7 @@ public:
 	void showControllers(bool show) { mShowControllers = show; }
 
 	const vr::TrackedDevicePose_t & getTrackedDevicePose(int deviceIndex) const { return m_rTrackedDevicePose[deviceIndex]; }
+	const Pose & getDevicePose(int deviceIndex) const { return m_rDevicePose[deviceIndex]; }
 
 	void setDisplaySize(int width, int height) { mDisplayWidth = width; mDisplayHeight = height; }
 
@@ -140,7 +142,8 @@ private:
 	vr::IVRSystem *m_pHMD;
 	vr::IVRRenderModels *m_pRenderModels;
 	vr::TrackedDevicePose_t m_rTrackedDevicePose[vr::k_unMaxTrackedDeviceCount];
-	Matrix4 m_rmat4DevicePose[vr::k_unMaxTrackedDeviceCount];
+	RigidMatrix4 m_rmat4DevicePose[vr::k_unMaxTrackedDeviceCount];
+	Pose m_rDevicePose[vr::k_unMaxTrackedDeviceCount];
 	bool m_rbShowTrackedDevice[vr::k_unMaxTrackedDeviceCount];
 
 
@@ -4,6 +4,8 @@
 //  ---
 //  Based on Song Ho Ahn (song.ahn@gmail.com)
 //  2D/3D/4D vectors
+//  Templated on the element type, Vector2/3/4 are the float ones used
+//  everywhere and Vector2d/3d/4d the double ones.
 //
 //  Created: 2016-08-24
 //  Updated: 2016-08-24
@@ -24,43 +26,51 @@ BEGIN_NAMESPACE_YUP
 // ========================================================================== //
 //  2D vector
 // ========================================================================== //
-struct Vector2
+template <typename T>
+struct Vector2T
 {
-    float x;
-    float y;
+    T x;
+    T y;
 
     // ctors
-    Vector2() : x(0), y(0) {};
-    Vector2(float x, float y) : x(x), y(y) {};
+    constexpr Vector2T() : x(0), y(0) {};
+    constexpr Vector2T(T x, T y) : x(x), y(y) {};
+    template <typename U>
+    constexpr explicit Vector2T(const Vector2T<U>& v) : x((T)v.x), y((T)v.y) {};
 
     // utils functions
-    void        set(float x, float y);
-    float       length() const;                         //
-    float       distance(const Vector2& vec) const;     // distance between two vectors
-    Vector2&    normalize();                            //
-    float       dot(const Vector2& vec) const;          // dot product
-    bool        equal(const Vector2& vec, float e) const; // compare with epsilon
+    constexpr void set(T x, T y);
+    T           length() const;                         //
+    T           distance(const Vector2T& vec) const;    // distance between two vectors
+    Vector2T&   normalize();                            //
+    constexpr T dot(const Vector2T& vec) const;         // dot product
+    bool        equal(const Vector2T& vec, T e) const;  // compare with epsilon
 
     // operators
-    Vector2     operator-() const;                      // unary operator (negate)
-    Vector2     operator+(const Vector2& rhs) const;    // add rhs
-    Vector2     operator-(const Vector2& rhs) const;    // subtract rhs
-    Vector2&    operator+=(const Vector2& rhs);         // add rhs and update this object
-    Vector2&    operator-=(const Vector2& rhs);         // subtract rhs and update this object
-    Vector2     operator*(const float scale) const;     // scale
-    Vector2     operator*(const Vector2& rhs) const;    // multiply each element
-    Vector2&    operator*=(const float scale);          // scale and update this object
-    Vector2&    operator*=(const Vector2& rhs);         // multiply each element and update this object
-    Vector2     operator/(const float scale) const;     // inverse scale
-    Vector2&    operator/=(const float scale);          // scale and update this object
-    bool        operator==(const Vector2& rhs) const;   // exact compare, no epsilon
-    bool        operator!=(const Vector2& rhs) const;   // exact compare, no epsilon
-    bool        operator<(const Vector2& rhs) const;    // comparison for sort
-    float       operator[](int index) const;            // subscript operator v[0], v[1]
-    float&      operator[](int index);                  // subscript operator v[0], v[1]
-
-    friend Vector2 operator*(const float a, const Vector2 vec);
-    friend std::ostream& operator<<(std::ostream& os, const Vector2& vec);
+    constexpr Vector2T operator-() const;               // unary operator (negate)
+    constexpr Vector2T operator+(const Vector2T& rhs) const; // add rhs
+    constexpr Vector2T operator-(const Vector2T& rhs) const; // subtract rhs
+    constexpr Vector2T& operator+=(const Vector2T& rhs); // add rhs and update this object
+    constexpr Vector2T& operator-=(const Vector2T& rhs); // subtract rhs and update this object
+    constexpr Vector2T operator*(const T scale) const;  // scale
+    constexpr Vector2T operator*(const Vector2T& rhs) const; // multiply each element
+    constexpr Vector2T& operator*=(const T scale);      // scale and update this object
+    constexpr Vector2T& operator*=(const Vector2T& rhs); // multiply each element and update this object
+    constexpr Vector2T operator/(const T scale) const;  // inverse scale
+    constexpr Vector2T& operator/=(const T scale);      // scale and update this object
+    constexpr bool operator==(const Vector2T& rhs) const; // exact compare, no epsilon
+    constexpr bool operator!=(const Vector2T& rhs) const; // exact compare, no epsilon
+    constexpr bool operator<(const Vector2T& rhs) const; // comparison for sort
+    T           operator[](int index) const;            // subscript operator v[0], v[1]
+    T&          operator[](int index);                  // subscript operator v[0], v[1]
+
+    friend constexpr Vector2T operator*(const T a, const Vector2T vec) {
+        return Vector2T(a*vec.x, a*vec.y);
+    }
+    friend std::ostream& operator<<(std::ostream& os, const Vector2T& vec) {
+        os << "(" << vec.x << ", " << vec.y << ")";
+        return os;
+    }
 };
 
 
@@ -68,46 +78,54 @@ struct Vector2
 // ========================================================================== //
 //  3D vector
 // ========================================================================== //
-struct Vector3
+template <typename T>
+struct Vector3T
 {
-    float x;
-    float y;
-    float z;
+    T x;
+    T y;
+    T z;
 
     // ctors
-    Vector3() : x(0), y(0), z(0) {};
-    Vector3(float x, float y, float z) : x(x), y(y), z(z) {};
+    constexpr Vector3T() : x(0), y(0), z(0) {};
+    constexpr Vector3T(T x, T y, T z) : x(x), y(y), z(z) {};
+    template <typename U>
+    constexpr explicit Vector3T(const Vector3T<U>& v) : x((T)v.x), y((T)v.y), z((T)v.z) {};
 
     // utils functions
-    void        set(float x, float y, float z);
-    float       length() const;                         //
-    float       distance(const Vector3& vec) const;     // distance between two vectors
-    float       angle(const Vector3& vec) const;        // angle between two vectors
-    Vector3&    normalize();                            //
-    float       dot(const Vector3& vec) const;          // dot product
-    Vector3     cross(const Vector3& vec) const;        // cross product
-    bool        equal(const Vector3& vec, float e) const; // compare with epsilon
+    constexpr void set(T x, T y, T z);
+    T           length() const;                         //
+    T           distance(const Vector3T& vec) const;    // distance between two vectors
+    T           angle(const Vector3T& vec) const;       // angle between two vectors
+    Vector3T&   normalize();                            //
+    constexpr T dot(const Vector3T& vec) const;         // dot product
+    constexpr Vector3T cross(const Vector3T& vec) const; // cross product
+    bool        equal(const Vector3T& vec, T e) const;  // compare with epsilon
 
     // operators
-    Vector3     operator-() const;                      // unary operator (negate)
-    Vector3     operator+(const Vector3& rhs) const;    // add rhs
-    Vector3     operator-(const Vector3& rhs) const;    // subtract rhs
-    Vector3&    operator+=(const Vector3& rhs);         // add rhs and update this object
-    Vector3&    operator-=(const Vector3& rhs);         // subtract rhs and update this object
-    Vector3     operator*(const float scale) const;     // scale
-    Vector3     operator*(const Vector3& rhs) const;    // multiplay each element
-    Vector3&    operator*=(const float scale);          // scale and update this object
-    Vector3&    operator*=(const Vector3& rhs);         // product each element and update this object
-    Vector3     operator/(const float scale) const;     // inverse scale
-    Vector3&    operator/=(const float scale);          // scale and update this object
-    bool        operator==(const Vector3& rhs) const;   // exact compare, no epsilon
-    bool        operator!=(const Vector3& rhs) const;   // exact compare, no epsilon
-    bool        operator<(const Vector3& rhs) const;    // comparison for sort
-    float       operator[](int index) const;            // subscript operator v[0], v[1]
-    float&      operator[](int index);                  // subscript operator v[0], v[1]
-
-    friend Vector3 operator*(const float a, const Vector3 vec);
-    friend std::ostream& operator<<(std::ostream& os, const Vector3& vec);
+    constexpr Vector3T operator-() const;               // unary operator (negate)
+    constexpr Vector3T operator+(const Vector3T& rhs) const; // add rhs
+    constexpr Vector3T operator-(const Vector3T& rhs) const; // subtract rhs
+    constexpr Vector3T& operator+=(const Vector3T& rhs); // add rhs and update this object
+    constexpr Vector3T& operator-=(const Vector3T& rhs); // subtract rhs and update this object
+    constexpr Vector3T operator*(const T scale) const;  // scale
+    constexpr Vector3T operator*(const Vector3T& rhs) const; // multiplay each element
+    constexpr Vector3T& operator*=(const T scale);      // scale and update this object
+    constexpr Vector3T& operator*=(const Vector3T& rhs); // product each element and update this object
+    constexpr Vector3T operator/(const T scale) const;  // inverse scale
+    constexpr Vector3T& operator/=(const T scale);      // scale and update this object
+    constexpr bool operator==(const Vector3T& rhs) const; // exact compare, no epsilon
+    constexpr bool operator!=(const Vector3T& rhs) const; // exact compare, no epsilon
+    constexpr bool operator<(const Vector3T& rhs) const; // comparison for sort
+    T           operator[](int index) const;            // subscript operator v[0], v[1]
+    T&          operator[](int index);                  // subscript operator v[0], v[1]
+
+    friend constexpr Vector3T operator*(const T a, const Vector3T vec) {
+        return Vector3T(a*vec.x, a*vec.y, a*vec.z);
+    }
+    friend std::ostream& operator<<(std::ostream& os, const Vector3T& vec) {
+        os << "(" << vec.x << ", " << vec.y << ", " << vec.z << ")";
+        return os;
+    }
 };
 
 
@@ -115,49 +133,66 @@ struct Vector3
 // ========================================================================== //
 //  4D vector
 // ========================================================================== //
-struct Vector4
+template <typename T>
+struct Vector4T
 {
-    float x;
-    float y;
-    float z;
-    float w;
+    T x;
+    T y;
+    T z;
+    T w;
 
     // ctors
-    Vector4() : x(0), y(0), z(0), w(0) {};
-    Vector4(float x, float y, float z, float w) : x(x), y(y), z(z), w(w) {};
+    constexpr Vector4T() : x(0), y(0), z(0), w(0) {};
+    constexpr Vector4T(T x, T y, T z, T w) : x(x), y(y), z(z), w(w) {};
+    template <typename U>
+    constexpr explicit Vector4T(const Vector4T<U>& v) : x((T)v.x), y((T)v.y), z((T)v.z), w((T)v.w) {};
 
     // utils functions
-    void        set(float x, float y, float z, float w);
-    float       length() const;                         //
-    float       distance(const Vector4& vec) const;     // distance between two vectors
-    Vector4&    normalize();                            //
-    float       dot(const Vector4& vec) const;          // dot product
-    bool        equal(const Vector4& vec, float e) const; // compare with epsilon
+    constexpr void set(T x, T y, T z, T w);
+    T           length() const;                         //
+    T           distance(const Vector4T& vec) const;    // distance between two vectors
+    Vector4T&   normalize();                            //
+    constexpr T dot(const Vector4T& vec) const;         // dot product
+    bool        equal(const Vector4T& vec, T e) const;  // compare with epsilon
 
     // operators
-    Vector4     operator-() const;                      // unary operator (negate)
-    Vector4     operator+(const Vector4& rhs) const;    // add rhs
-    Vector4     operator-(const Vector4& rhs) const;    // subtract rhs
-    Vector4&    operator+=(const Vector4& rhs);         // add rhs and update this object
-    Vector4&    operator-=(const Vector4& rhs);         // subtract rhs and update this object
-    Vector4     operator*(const float scale) const;     // scale
-    Vector4     operator*(const Vector4& rhs) const;    // multiply each element
-    Vector4&    operator*=(const float scale);          // scale and update this object
-    Vector4&    operator*=(const Vector4& rhs);         // multiply each element and update this object
-    Vector4     operator/(const float scale) const;     // inverse scale
-    Vector4&    operator/=(const float scale);          // scale and update this object
-    bool        operator==(const Vector4& rhs) const;   // exact compare, no epsilon
-    bool        operator!=(const Vector4& rhs) const;   // exact compare, no epsilon
-    bool        operator<(const Vector4& rhs) const;    // comparison for sort
-    float       operator[](int index) const;            // subscript operator v[0], v[1]
-    float&      operator[](int index);                  // subscript operator v[0], v[1]
-
-    friend Vector4 operator*(const float a, const Vector4 vec);
-    friend std::ostream& operator<<(std::ostream& os, const Vector4& vec);
+    constexpr Vector4T operator-() const;               // unary operator (negate)
+    constexpr Vector4T operator+(const Vector4T& rhs) const; // add rhs
+    constexpr Vector4T operator-(const Vector4T& rhs) const; // subtract rhs
+    constexpr Vector4T& operator+=(const Vector4T& rhs); // add rhs and update this object
+    constexpr Vector4T& operator-=(const Vector4T& rhs); // subtract rhs and update this object
+    constexpr Vector4T operator*(const T scale) const;  // scale
+    constexpr Vector4T operator*(const Vector4T& rhs) const; // multiply each element
+    constexpr Vector4T& operator*=(const T scale);      // scale and update this object
+    constexpr Vector4T& operator*=(const Vector4T& rhs); // multiply each element and update this object
+    constexpr Vector4T operator/(const T scale) const;  // inverse scale
+    constexpr Vector4T& operator/=(const T scale);      // scale and update this object
+    constexpr bool operator==(const Vector4T& rhs) const; // exact compare, no epsilon
+    constexpr bool operator!=(const Vector4T& rhs) const; // exact compare, no epsilon
+    constexpr bool operator<(const Vector4T& rhs) const; // comparison for sort
+    T           operator[](int index) const;            // subscript operator v[0], v[1]
+    T&          operator[](int index);                  // subscript operator v[0], v[1]
+
+    friend constexpr Vector4T operator*(const T a, const Vector4T vec) {
+        return Vector4T(a*vec.x, a*vec.y, a*vec.z, a*vec.w);
+    }
+    friend std::ostream& operator<<(std::ostream& os, const Vector4T& vec) {
+        os << "(" << vec.x << ", " << vec.y << ", " << vec.z << ", " << vec.w << ")";
+        return os;
+    }
 };
 
 
 
+typedef Vector2T<float>     Vector2;
+typedef Vector3T<float>     Vector3;
+typedef Vector4T<float>     Vector4;
+typedef Vector2T<double>    Vector2d;
+typedef Vector3T<double>    Vector3d;
+typedef Vector4T<double>    Vector4d;
+
+
+
 // fast math routines from Doom3 SDK
 inline float invSqrt(float x)
 {
@@ -174,59 +209,73 @@ inline float invSqrt(float x)
 // ========================================================================== //
 //  inline functions for Vector2
 // ========================================================================== //
-inline Vector2 Vector2::operator-() const {
-    return Vector2(-x, -y);
+template <typename T>
+constexpr Vector2T<T> Vector2T<T>::operator-() const {
+    return Vector2T<T>(-x, -y);
 }
 
-inline Vector2 Vector2::operator+(const Vector2& rhs) const {
-    return Vector2(x+rhs.x, y+rhs.y);
+template <typename T>
+constexpr Vector2T<T> Vector2T<T>::operator+(const Vector2T<T>& rhs) const {
+    return Vector2T<T>(x+rhs.x, y+rhs.y);
 }
 
-inline Vector2 Vector2::operator-(const Vector2& rhs) const {
-    return Vector2(x-rhs.x, y-rhs.y);
+template <typename T>
+constexpr Vector2T<T> Vector2T<T>::operator-(const Vector2T<T>& rhs) const {
+    return Vector2T<T>(x-rhs.x, y-rhs.y);
 }
 
-inline Vector2& Vector2::operator+=(const Vector2& rhs) {
+template <typename T>
+constexpr Vector2T<T>& Vector2T<T>::operator+=(const Vector2T<T>& rhs) {
     x += rhs.x; y += rhs.y; return *this;
 }
 
-inline Vector2& Vector2::operator-=(const Vector2& rhs) {
+template <typename T>
+constexpr Vector2T<T>& Vector2T<T>::operator-=(const Vector2T<T>& rhs) {
     x -= rhs.x; y -= rhs.y; return *this;
 }
 
-inline Vector2 Vector2::operator*(const float a) const {
-    return Vector2(x*a, y*a);
+template <typename T>
+constexpr Vector2T<T> Vector2T<T>::operator*(const T a) const {
+    return Vector2T<T>(x*a, y*a);
 }
 
-inline Vector2 Vector2::operator*(const Vector2& rhs) const {
-    return Vector2(x*rhs.x, y*rhs.y);
+template <typename T>
+constexpr Vector2T<T> Vector2T<T>::operator*(const Vector2T<T>& rhs) const {
+    return Vector2T<T>(x*rhs.x, y*rhs.y);
 }
 
-inline Vector2& Vector2::operator*=(const float a) {
+template <typename T>
+constexpr Vector2T<T>& Vector2T<T>::operator*=(const T a) {
     x *= a; y *= a; return *this;
 }
 
-inline Vector2& Vector2::operator*=(const Vector2& rhs) {
+template <typename T>
+constexpr Vector2T<T>& Vector2T<T>::operator*=(const Vector2T<T>& rhs) {
     x *= rhs.x; y *= rhs.y; return *this;
 }
 
-inline Vector2 Vector2::operator/(const float a) const {
-    return Vector2(x/a, y/a);
+template <typename T>
+constexpr Vector2T<T> Vector2T<T>::operator/(const T a) const {
+    return Vector2T<T>(x/a, y/a);
 }
 
-inline Vector2& Vector2::operator/=(const float a) {
+template <typename T>
+constexpr Vector2T<T>& Vector2T<T>::operator/=(const T a) {
     x /= a; y /= a; return *this;
 }
 
-inline bool Vector2::operator==(const Vector2& rhs) const {
+template <typename T>
+constexpr bool Vector2T<T>::operator==(const Vector2T<T>& rhs) const {
     return (x == rhs.x) && (y == rhs.y);
 }
 
-inline bool Vector2::operator!=(const Vector2& rhs) const {
+template <typename T>
+constexpr bool Vector2T<T>::operator!=(const Vector2T<T>& rhs) const {
     return (x != rhs.x) || (y != rhs.y);
 }
 
-inline bool Vector2::operator<(const Vector2& rhs) const {
+template <typename T>
+constexpr bool Vector2T<T>::operator<(const Vector2T<T>& rhs) const {
     if(x < rhs.x) return true;
     if(x > rhs.x) return false;
     if(y < rhs.y) return true;
@@ -234,55 +283,55 @@ inline bool Vector2::operator<(const Vector2& rhs) const {
     return false;
 }
 
-inline float Vector2::operator[](int index) const {
+template <typename T>
+inline T Vector2T<T>::operator[](int index) const {
     return (&x)[index];
 }
 
-inline float& Vector2::operator[](int index) {
+template <typename T>
+inline T& Vector2T<T>::operator[](int index) {
     return (&x)[index];
 }
 
-inline void Vector2::set(float x, float y) {
+template <typename T>
+constexpr void Vector2T<T>::set(T x, T y) {
     this->x = x; this->y = y;
 }
 
-inline float Vector2::length() const {
-    return sqrtf(x*x + y*y);
+template <typename T>
+inline T Vector2T<T>::length() const {
+    return std::sqrt(x*x + y*y);
 }
 
-inline float Vector2::distance(const Vector2& vec) const {
-    return sqrtf((vec.x-x)*(vec.x-x) + (vec.y-y)*(vec.y-y));
+template <typename T>
+inline T Vector2T<T>::distance(const Vector2T<T>& vec) const {
+    return std::sqrt((vec.x-x)*(vec.x-x) + (vec.y-y)*(vec.y-y));
 }
 
-inline Vector2& Vector2::normalize() {
+template <typename T>
+inline Vector2T<T>& Vector2T<T>::normalize() {
     //@@const float EPSILON = 0.000001f;
-    float xxyy = x*x + y*y;
+    T xxyy = x*x + y*y;
     //@@if(xxyy < EPSILON)
     //@@    return *this;
 
     //float invLength = invSqrt(xxyy);
-    float invLength = 1.0f / sqrtf(xxyy);
+    T invLength = 1.0f / std::sqrt(xxyy);
     x *= invLength;
     y *= invLength;
     return *this;
 }
 
-inline float Vector2::dot(const Vector2& rhs) const {
+template <typename T>
+constexpr T Vector2T<T>::dot(const Vector2T<T>& rhs) const {
     return (x*rhs.x + y*rhs.y);
 }
 
-inline bool Vector2::equal(const Vector2& rhs, float epsilon) const {
-    return fabs(x - rhs.x) < epsilon && fabs(y - rhs.y) < epsilon;
+template <typename T>
+inline bool Vector2T<T>::equal(const Vector2T<T>& rhs, T epsilon) const {
+    return std::fabs(x - rhs.x) < epsilon && std::fabs(y - rhs.y) < epsilon;
 }
 
-inline Vector2 operator*(const float a, const Vector2 vec) {
-    return Vector2(a*vec.x, a*vec.y);
-}
-
-inline std::ostream& operator<<(std::ostream& os, const Vector2& vec) {
-    os << "(" << vec.x << ", " << vec.y << ")";
-    return os;
-}
 // END OF VECTOR2 /////////////////////////////////////////////////////////////
 
 
@@ -291,59 +340,73 @@ inline std::ostream& operator<<(std::ostream& os, const Vector2& vec) {
 // ========================================================================== //
 //  inline functions for Vector3
 // ========================================================================== //
-inline Vector3 Vector3::operator-() const {
-    return Vector3(-x, -y, -z);
+template <typename T>
+constexpr Vector3T<T> Vector3T<T>::operator-() const {
+    return Vector3T<T>(-x, -y, -z);
 }
 
-inline Vector3 Vector3::operator+(const Vector3& rhs) const {
-    return Vector3(x+rhs.x, y+rhs.y, z+rhs.z);
+template <typename T>
+constexpr Vector3T<T> Vector3T<T>::operator+(const Vector3T<T>& rhs) const {
+    return Vector3T<T>(x+rhs.x, y+rhs.y, z+rhs.z);
 }
 
-inline Vector3 Vector3::operator-(const Vector3& rhs) const {
-    return Vector3(x-rhs.x, y-rhs.y, z-rhs.z);
+template <typename T>
+constexpr Vector3T<T> Vector3T<T>::operator-(const Vector3T<T>& rhs) const {
+    return Vector3T<T>(x-rhs.x, y-rhs.y, z-rhs.z);
 }
 
-inline Vector3& Vector3::operator+=(const Vector3& rhs) {
+template <typename T>
+constexpr Vector3T<T>& Vector3T<T>::operator+=(const Vector3T<T>& rhs) {
     x += rhs.x; y += rhs.y; z += rhs.z; return *this;
 }
 
-inline Vector3& Vector3::operator-=(const Vector3& rhs) {
+template <typename T>
+constexpr Vector3T<T>& Vector3T<T>::operator-=(const Vector3T<T>& rhs) {
     x -= rhs.x; y -= rhs.y; z -= rhs.z; return *this;
 }
 
-inline Vector3 Vector3::operator*(const float a) const {
-    return Vector3(x*a, y*a, z*a);
+template <typename T>
+constexpr Vector3T<T> Vector3T<T>::operator*(const T a) const {
+    return Vector3T<T>(x*a, y*a, z*a);
 }
 
-inline Vector3 Vector3::operator*(const Vector3& rhs) const {
-    return Vector3(x*rhs.x, y*rhs.y, z*rhs.z);
+template <typename T>
+constexpr Vector3T<T> Vector3T<T>::operator*(const Vector3T<T>& rhs) const {
+    return Vector3T<T>(x*rhs.x, y*rhs.y, z*rhs.z);
 }
 
-inline Vector3& Vector3::operator*=(const float a) {
+template <typename T>
+constexpr Vector3T<T>& Vector3T<T>::operator*=(const T a) {
     x *= a; y *= a; z *= a; return *this;
 }
 
-inline Vector3& Vector3::operator*=(const Vector3& rhs) {
+template <typename T>
+constexpr Vector3T<T>& Vector3T<T>::operator*=(const Vector3T<T>& rhs) {
     x *= rhs.x; y *= rhs.y; z *= rhs.z; return *this;
 }
 
-inline Vector3 Vector3::operator/(const float a) const {
-    return Vector3(x/a, y/a, z/a);
+template <typename T>
+constexpr Vector3T<T> Vector3T<T>::operator/(const T a) const {
+    return Vector3T<T>(x/a, y/a, z/a);
 }
 
-inline Vector3& Vector3::operator/=(const float a) {
+template <typename T>
+constexpr Vector3T<T>& Vector3T<T>::operator/=(const T a) {
     x /= a; y /= a; z /= a; return *this;
 }
 
-inline bool Vector3::operator==(const Vector3& rhs) const {
+template <typename T>
+constexpr bool Vector3T<T>::operator==(const Vector3T<T>& rhs) const {
     return (x == rhs.x) && (y == rhs.y) && (z == rhs.z);
 }
 
-inline bool Vector3::operator!=(const Vector3& rhs) const {
+template <typename T>
+constexpr bool Vector3T<T>::operator!=(const Vector3T<T>& rhs) const {
     return (x != rhs.x) || (y != rhs.y) || (z != rhs.z);
 }
 
-inline bool Vector3::operator<(const Vector3& rhs) const {
+template <typename T>
+constexpr bool Vector3T<T>::operator<(const Vector3T<T>& rhs) const {
     if(x < rhs.x) return true;
     if(x > rhs.x) return false;
     if(y < rhs.y) return true;
@@ -353,69 +416,71 @@ inline bool Vector3::operator<(const Vector3& rhs) const {
     return false;
 }
 
-inline float Vector3::operator[](int index) const {
+template <typename T>
+inline T Vector3T<T>::operator[](int index) const {
     return (&x)[index];
 }
 
-inline float& Vector3::operator[](int index) {
+template <typename T>
+inline T& Vector3T<T>::operator[](int index) {
     return (&x)[index];
 }
 
-inline void Vector3::set(float x, float y, float z) {
+template <typename T>
+constexpr void Vector3T<T>::set(T x, T y, T z) {
     this->x = x; this->y = y; this->z = z;
 }
 
-inline float Vector3::length() const {
-    return sqrtf(x*x + y*y + z*z);
+template <typename T>
+inline T Vector3T<T>::length() const {
+    return std::sqrt(x*x + y*y + z*z);
 }
 
-inline float Vector3::distance(const Vector3& vec) const {
-    return sqrtf((vec.x-x)*(vec.x-x) + (vec.y-y)*(vec.y-y) + (vec.z-z)*(vec.z-z));
+template <typename T>
+inline T Vector3T<T>::distance(const Vector3T<T>& vec) const {
+    return std::sqrt((vec.x-x)*(vec.x-x) + (vec.y-y)*(vec.y-y) + (vec.z-z)*(vec.z-z));
 }
 
-inline float Vector3::angle(const Vector3& vec) const {
+template <typename T>
+inline T Vector3T<T>::angle(const Vector3T<T>& vec) const {
     // return angle between [0, 180]
-    float l1 = this->length();
-    float l2 = vec.length();
-    float d = this->dot(vec);
-    float angle = acosf(d / (l1 * l2)) / 3.141592f * 180.0f;
+    T l1 = this->length();
+    T l2 = vec.length();
+    T d = this->dot(vec);
+    T angle = std::acos(d / (l1 * l2)) / 3.141592f * 180.0f;
     return angle;
 }
 
-inline Vector3& Vector3::normalize() {
+template <typename T>
+inline Vector3T<T>& Vector3T<T>::normalize() {
     //@@const float EPSILON = 0.000001f;
-    float xxyyzz = x*x + y*y + z*z;
+    T xxyyzz = x*x + y*y + z*z;
     //@@if(xxyyzz < EPSILON)
     //@@    return *this; // do nothing if it is ~zero vector
 
     //float invLength = invSqrt(xxyyzz);
-    float invLength = 1.0f / sqrtf(xxyyzz);
+    T invLength = 1.0f / std::sqrt(xxyyzz);
     x *= invLength;
     y *= invLength;
     z *= invLength;
     return *this;
 }
 
-inline float Vector3::dot(const Vector3& rhs) const {
+template <typename T>
+constexpr T Vector3T<T>::dot(const Vector3T<T>& rhs) const {
     return (x*rhs.x + y*rhs.y + z*rhs.z);
 }
 
-inline Vector3 Vector3::cross(const Vector3& rhs) const {
-    return Vector3(y*rhs.z - z*rhs.y, z*rhs.x - x*rhs.z, x*rhs.y - y*rhs.x);
+template <typename T>
+constexpr Vector3T<T> Vector3T<T>::cross(const Vector3T<T>& rhs) const {
+    return Vector3T<T>(y*rhs.z - z*rhs.y, z*rhs.x - x*rhs.z, x*rhs.y - y*rhs.x);
 }
 
-inline bool Vector3::equal(const Vector3& rhs, float epsilon) const {
-    return fabs(x - rhs.x) < epsilon && fabs(y - rhs.y) < epsilon && fabs(z - rhs.z) < epsilon;
+template <typename T>
+inline bool Vector3T<T>::equal(const Vector3T<T>& rhs, T epsilon) const {
+    return std::fabs(x - rhs.x) < epsilon && std::fabs(y - rhs.y) < epsilon && std::fabs(z - rhs.z) < epsilon;
 }
 
-inline Vector3 operator*(const float a, const Vector3 vec) {
-    return Vector3(a*vec.x, a*vec.y, a*vec.z);
-}
-
-inline std::ostream& operator<<(std::ostream& os, const Vector3& vec) {
-    os << "(" << vec.x << ", " << vec.y << ", " << vec.z << ")";
-    return os;
-}
 // END OF VECTOR3 /////////////////////////////////////////////////////////////
 
 
@@ -423,59 +488,73 @@ inline std::ostream& operator<<(std::ostream& os, const Vector3& vec) {
 // ========================================================================== //
 //  inline functions for Vector4
 // ========================================================================== //
-inline Vector4 Vector4::operator-() const {
-    return Vector4(-x, -y, -z, -w);
+template <typename T>
+constexpr Vector4T<T> Vector4T<T>::operator-() const {
+    return Vector4T<T>(-x, -y, -z, -w);
 }
 
-inline Vector4 Vector4::operator+(const Vector4& rhs) const {
-    return Vector4(x+rhs.x, y+rhs.y, z+rhs.z, w+rhs.w);
+template <typename T>
+constexpr Vector4T<T> Vector4T<T>::operator+(const Vector4T<T>& rhs) const {
+    return Vector4T<T>(x+rhs.x, y+rhs.y, z+rhs.z, w+rhs.w);
 }
 
-inline Vector4 Vector4::operator-(const Vector4& rhs) const {
-    return Vector4(x-rhs.x, y-rhs.y, z-rhs.z, w-rhs.w);
+template <typename T>
+constexpr Vector4T<T> Vector4T<T>::operator-(const Vector4T<T>& rhs) const {
+    return Vector4T<T>(x-rhs.x, y-rhs.y, z-rhs.z, w-rhs.w);
 }
 
-inline Vector4& Vector4::operator+=(const Vector4& rhs) {
+template <typename T>
+constexpr Vector4T<T>& Vector4T<T>::operator+=(const Vector4T<T>& rhs) {
     x += rhs.x; y += rhs.y; z += rhs.z; w += rhs.w; return *this;
 }
 
-inline Vector4& Vector4::operator-=(const Vector4& rhs) {
+template <typename T>
+constexpr Vector4T<T>& Vector4T<T>::operator-=(const Vector4T<T>& rhs) {
     x -= rhs.x; y -= rhs.y; z -= rhs.z; w -= rhs.w; return *this;
 }
 
-inline Vector4 Vector4::operator*(const float a) const {
-    return Vector4(x*a, y*a, z*a, w*a);
+template <typename T>
+constexpr Vector4T<T> Vector4T<T>::operator*(const T a) const {
+    return Vector4T<T>(x*a, y*a, z*a, w*a);
 }
 
-inline Vector4 Vector4::operator*(const Vector4& rhs) const {
-    return Vector4(x*rhs.x, y*rhs.y, z*rhs.z, w*rhs.w);
+template <typename T>
+constexpr Vector4T<T> Vector4T<T>::operator*(const Vector4T<T>& rhs) const {
+    return Vector4T<T>(x*rhs.x, y*rhs.y, z*rhs.z, w*rhs.w);
 }
 
-inline Vector4& Vector4::operator*=(const float a) {
+template <typename T>
+constexpr Vector4T<T>& Vector4T<T>::operator*=(const T a) {
     x *= a; y *= a; z *= a; w *= a; return *this;
 }
 
-inline Vector4& Vector4::operator*=(const Vector4& rhs) {
+template <typename T>
+constexpr Vector4T<T>& Vector4T<T>::operator*=(const Vector4T<T>& rhs) {
     x *= rhs.x; y *= rhs.y; z *= rhs.z; w *= rhs.w; return *this;
 }
 
-inline Vector4 Vector4::operator/(const float a) const {
-    return Vector4(x/a, y/a, z/a, w/a);
+template <typename T>
+constexpr Vector4T<T> Vector4T<T>::operator/(const T a) const {
+    return Vector4T<T>(x/a, y/a, z/a, w/a);
 }
 
-inline Vector4& Vector4::operator/=(const float a) {
+template <typename T>
+constexpr Vector4T<T>& Vector4T<T>::operator/=(const T a) {
     x /= a; y /= a; z /= a; w /= a; return *this;
 }
 
-inline bool Vector4::operator==(const Vector4& rhs) const {
+template <typename T>
+constexpr bool Vector4T<T>::operator==(const Vector4T<T>& rhs) const {
     return (x == rhs.x) && (y == rhs.y) && (z == rhs.z) && (w == rhs.w);
 }
 
-inline bool Vector4::operator!=(const Vector4& rhs) const {
+template <typename T>
+constexpr bool Vector4T<T>::operator!=(const Vector4T<T>& rhs) const {
     return (x != rhs.x) || (y != rhs.y) || (z != rhs.z) || (w != rhs.w);
 }
 
-inline bool Vector4::operator<(const Vector4& rhs) const {
+template <typename T>
+constexpr bool Vector4T<T>::operator<(const Vector4T<T>& rhs) const {
     if(x < rhs.x) return true;
     if(x > rhs.x) return false;
     if(y < rhs.y) return true;
@@ -487,58 +566,58 @@ inline bool Vector4::operator<(const Vector4& rhs) const {
     return false;
 }
 
-inline float Vector4::operator[](int index) const {
+template <typename T>
+inline T Vector4T<T>::operator[](int index) const {
     return (&x)[index];
 }
 
-inline float& Vector4::operator[](int index) {
+template <typename T>
+inline T& Vector4T<T>::operator[](int index) {
     return (&x)[index];
 }
 
-inline void Vector4::set(float x, float y, float z, float w) {
+template <typename T>
+constexpr void Vector4T<T>::set(T x, T y, T z, T w) {
     this->x = x; this->y = y; this->z = z; this->w = w;
 }
 
-inline float Vector4::length() const {
-    return sqrtf(x*x + y*y + z*z + w*w);
+template <typename T>
+inline T Vector4T<T>::length() const {
+    return std::sqrt(x*x + y*y + z*z + w*w);
 }
 
-inline float Vector4::distance(const Vector4& vec) const {
-    return sqrtf((vec.x-x)*(vec.x-x) + (vec.y-y)*(vec.y-y) + (vec.z-z)*(vec.z-z) + (vec.w-w)*(vec.w-w));
+template <typename T>
+inline T Vector4T<T>::distance(const Vector4T<T>& vec) const {
+    return std::sqrt((vec.x-x)*(vec.x-x) + (vec.y-y)*(vec.y-y) + (vec.z-z)*(vec.z-z) + (vec.w-w)*(vec.w-w));
 }
 
-inline Vector4& Vector4::normalize() {
+template <typename T>
+inline Vector4T<T>& Vector4T<T>::normalize() {
     //NOTE: leave w-component untouched
     //@@const float EPSILON = 0.000001f;
-    float xxyyzz = x*x + y*y + z*z;
+    T xxyyzz = x*x + y*y + z*z;
     //@@if(xxyyzz < EPSILON)
     //@@    return *this; // do nothing if it is zero vector
 
     //float invLength = invSqrt(xxyyzz);
-    float invLength = 1.0f / sqrtf(xxyyzz);
+    T invLength = 1.0f / std::sqrt(xxyyzz);
     x *= invLength;
     y *= invLength;
     z *= invLength;
     return *this;
 }
 
-inline float Vector4::dot(const Vector4& rhs) const {
+template <typename T>
+constexpr T Vector4T<T>::dot(const Vector4T<T>& rhs) const {
     return (x*rhs.x + y*rhs.y + z*rhs.z + w*rhs.w);
 }
 
-inline bool Vector4::equal(const Vector4& rhs, float epsilon) const {
-    return fabs(x - rhs.x) < epsilon && fabs(y - rhs.y) < epsilon &&
-           fabs(z - rhs.z) < epsilon && fabs(w - rhs.w) < epsilon;
+template <typename T>
+inline bool Vector4T<T>::equal(const Vector4T<T>& rhs, T epsilon) const {
+    return std::fabs(x - rhs.x) < epsilon && std::fabs(y - rhs.y) < epsilon &&
+           std::fabs(z - rhs.z) < epsilon && std::fabs(w - rhs.w) < epsilon;
 }
 
-inline Vector4 operator*(const float a, const Vector4 vec) {
-    return Vector4(a*vec.x, a*vec.y, a*vec.z, a*vec.w);
-}
-
-inline std::ostream& operator<<(std::ostream& os, const Vector4& vec) {
-    os << "(" << vec.x << ", " << vec.y << ", " << vec.z << ", " << vec.w << ")";
-    return os;
-}
 // END OF VECTOR4 /////////////////////////////////////////////////////////////
 
 END_NAMESPACE_YUP
\ No newline at end of file
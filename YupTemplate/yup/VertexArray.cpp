@@ -12,68 +12,92 @@
 
 #ifdef YUP_INCLUDE_GLEW
 
+#include <algorithm>
+#include <cstring>
+
 #include "VertexArray.h"
 
 BEGIN_NAMESPACE_YUP_GL
 
-VertexArray::VertexArray(int stride0, int stride1, int stride2)
-	: mStride0(stride0)
-	, mStride1(stride1)
-	, mStride2(stride2)
+// the smallest GL buffer, saves a few reallocations of small clouds
+static const size_t MinBufferBytes = 64 * 1024;
+
+BoundingBox VertexBounds(const void *vertices, int count, GLsizei vertexSize)
 {
+	BoundingBox box;
+	float x0 = box.min.x, y0 = box.min.y, z0 = box.min.z;
+	float x1 = box.max.x, y1 = box.max.y, z1 = box.max.z;
+
+	const uint8_t *v = (const uint8_t *)vertices;
+	for (int i = 0; i < count; i++, v += vertexSize)
+	{
+		float p[3];
+		memcpy(p, v, sizeof(p));
+
+		x0 = std::min(x0, p[0]);
+		y0 = std::min(y0, p[1]);
+		z0 = std::min(z0, p[2]);
+		x1 = std::max(x1, p[0]);
+		y1 = std::max(y1, p[1]);
+		z1 = std::max(z1, p[2]);
+	}
+
+	return BoundingBox(Vector3(x0, y0, z0), Vector3(x1, y1, z1));
 }
 
 
-VertexArray::~VertexArray()
+
+VertexArrayBase::VertexArrayBase(GLsizei vertexSize)
+	: mVertexSize(vertexSize)
 {
 }
 
-bool VertexArray::init()
+
+VertexArrayBase::~VertexArrayBase()
+{
+}
+
+bool VertexArrayBase::init()
 {
 	// Generate VAO
 	glGenVertexArrays(1, &mVAO);
-	glBindVertexArray(mVAO);
 	glGenBuffers(1, &mVertBufferId);
-	
-	//GLsizei stride = sizeof(float) * (mStride0 + mStride1 + mStride2);
-
-	//uintptr_t offset = 0;
-	//if (mStride0 > 0)
-	//{
-	//	glEnableVertexAttribArray(0);
-	//	glVertexAttribPointer(0, mStride0, GL_FLOAT, GL_FALSE, stride, (const void *)offset);
-	//	offset += sizeof(float) * mStride0;
-	//}
-
-	//if (mStride1 > 0)
-	//{
-	//	glEnableVertexAttribArray(1);
-	//	glVertexAttribPointer(1, mStride1, GL_FLOAT, GL_FALSE, stride, (const void *)offset);
-	//	offset += sizeof(float) * mStride1;
-	//}
-
-	//if (mStride2 > 0)
-	//{
-	//	glEnableVertexAttribArray(2);
-	//	glVertexAttribPointer(2, mStride2, GL_FLOAT, GL_FALSE, stride, (const void *)offset);
-	//}
-
-	glBindVertexArray(0);
 
+	setVertexAttributes();
 	updateVertexBuffer();
 
 	return true;
 }
 
-void VertexArray::update()
+void VertexArrayBase::update()
 {
-	std::lock_guard<std::mutex> lock(mMutex);
+	bool reset = false;
+
+	{
+		std::unique_lock<std::mutex> lock(mMutex, std::try_to_lock);
+		if (!lock.owns_lock() || !mVertArrayChanged)
+			return;
+
+		mPendingArray.swap(mStagingArray);
+		mDrawBounds = mBounds;
+		reset = mPendingReset;
+		mPendingReset = false;
+		mVertArrayChanged = false;
+	}
+
+	if (reset)
+	{
+		mVertArray.clear();
+		mUploadedSize = 0;
+	}
+
+	mVertArray.insert(mVertArray.end(), mStagingArray.begin(), mStagingArray.end());
+	mStagingArray.clear();
 
-	if (mVertArrayChanged)
-		updateVertexBuffer();
+	updateVertexBuffer();
 }
 
-void VertexArray::shutdown()
+void VertexArrayBase::shutdown()
 {
 	if (mVertBufferId)
 	{
@@ -86,93 +110,333 @@ void VertexArray::shutdown()
 		glDeleteVertexArrays(1, &mVAO);
 		mVAO = 0;
 	}
+
+	mBufferCapacity = 0;
+	mUploadedSize = 0;
+	mUploadedVertCount = 0;
 }
 
-void VertexArray::updateVertexBuffer()
+void VertexArrayBase::appendData(const void *vertices, int count, const BoundingBox &bounds)
 {
-	glBindVertexArray(mVAO);
+	if (count <= 0)
+		return;
 
-	glBindBuffer(GL_ARRAY_BUFFER, mVertBufferId);
-	if(mVertArray.size() > 0)
-		glBufferData(GL_ARRAY_BUFFER, sizeof(float) * mVertArray.size(), &mVertArray[0], GL_STATIC_DRAW);
-	else
-		glBufferData(GL_ARRAY_BUFFER, 1, nullptr, GL_STATIC_DRAW);
+	const uint8_t *data = (const uint8_t *)vertices;
 
-	mUploadedVertCount = mVertCount;
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	mPendingArray.insert(mPendingArray.end(), data, data + (size_t)count * mVertexSize);
+
+	mBounds.add(bounds.min);
+	mBounds.add(bounds.max);
+
+	mVertArrayChanged = true;
+}
+
+void VertexArrayBase::assignData(const void *vertices, int count, const BoundingBox &bounds)
+{
+	const uint8_t *data = (const uint8_t *)vertices;
+
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	mPendingArray.assign(data, data + (size_t)std::max(count, 0) * mVertexSize);
+	mPendingReset = true;
+	mBounds = bounds;
 
-	// VertexAttribPointer needs to be reassigned
-	GLsizei stride = sizeof(float) * (mStride0 + mStride1 + mStride2);
+	mVertArrayChanged = true;
+}
+
+void VertexArrayBase::appendData(int count, const BoundingBox &bounds, const std::function<void(uint8_t *)> &fill)
+{
+	if (count <= 0)
+		return;
+
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	const size_t offset = mPendingArray.size();
+	mPendingArray.resize(offset + (size_t)count * mVertexSize);
+	fill(mPendingArray.data() + offset);
+
+	mBounds.add(bounds.min);
+	mBounds.add(bounds.max);
+
+	mVertArrayChanged = true;
+}
+
+void VertexArrayBase::assignData(int count, const BoundingBox &bounds, const std::function<void(uint8_t *)> &fill)
+{
+	count = std::max(count, 0);
+
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	mPendingArray.resize((size_t)count * mVertexSize);
+	if (count > 0)
+		fill(mPendingArray.data());
+	mPendingReset = true;
+	mBounds = bounds;
+
+	mVertArrayChanged = true;
+}
 
-	uintptr_t offset = 0;
-	if (mStride0 > 0)
+void VertexArrayBase::updateVertexBuffer()
+{
+	const size_t size = mVertArray.size();
+
+	if (size > mBufferCapacity)
+		growVertexBuffer(size);
+
+	// only what was appended since the last upload
+	if (size > mUploadedSize)
 	{
-		glEnableVertexAttribArray(0);
-		glVertexAttribPointer(0, mStride0, GL_FLOAT, GL_FALSE, stride, (const void *)offset);
-		offset += sizeof(float) * mStride0;
+		glBindBuffer(GL_ARRAY_BUFFER, mVertBufferId);
+		glBufferSubData(GL_ARRAY_BUFFER, mUploadedSize, size - mUploadedSize, &mVertArray[mUploadedSize]);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
 	}
 
-	if (mStride1 > 0)
+	mUploadedSize = size;
+	mVertCount = (GLsizei)(size / mVertexSize);
+	mUploadedVertCount = mVertCount;
+}
+
+void VertexArrayBase::growVertexBuffer(size_t bytes)
+{
+	const size_t capacity = std::max(std::max(bytes, mBufferCapacity * 2), MinBufferBytes);
+
+	GLuint bufferId = 0;
+	glGenBuffers(1, &bufferId);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, bufferId);
+	glBufferData(GL_COPY_WRITE_BUFFER, capacity, nullptr, GL_DYNAMIC_DRAW);
+
+	// keep what is already uploaded, copied on the GPU
+	if (mUploadedSize > 0)
 	{
-		glEnableVertexAttribArray(1);
-		glVertexAttribPointer(1, mStride1, GL_FLOAT, GL_FALSE, stride, (const void *)offset);
-		offset += sizeof(float) * mStride1;
+		glBindBuffer(GL_COPY_READ_BUFFER, mVertBufferId);
+		glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, mUploadedSize);
+		glBindBuffer(GL_COPY_READ_BUFFER, 0);
 	}
 
-	if (mStride2 > 0)
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+	glDeleteBuffers(1, &mVertBufferId);
+	mVertBufferId = bufferId;
+	mBufferCapacity = capacity;
+
+	// the attributes still point at the old buffer
+	setVertexAttributes();
+}
+
+void VertexArrayBase::setVertexAttributes()
+{
+	glBindVertexArray(mVAO);
+	glBindBuffer(GL_ARRAY_BUFFER, mVertBufferId);
+
+	setupAttributes();
+
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+
+
+#ifdef YUP_INCLUDE_OPENCV
+// interleaved in place in the pending buffer, the bounds are of pts
+void RgbVertexArray::addPoints(const std::vector<cv::Point3f> &pts, const std::vector<Vector4> &colors)
+{
+	const int count = (int)std::min(pts.size(), colors.size());
+
+	appendData(count, VertexBounds(pts.data(), count, sizeof(cv::Point3f)), [&](uint8_t *dst) {
+		Interleave(pts.data(), colors.data(), count, (float *)dst);
+	});
+}
+
+void RgbVertexArray::assign(const std::vector<cv::Point3f> &pts, const std::vector<Vector4> &colors)
+{
+	const int count = (int)std::min(pts.size(), colors.size());
+
+	assignData(count, VertexBounds(pts.data(), count, sizeof(cv::Point3f)), [&](uint8_t *dst) {
+		Interleave(pts.data(), colors.data(), count, (float *)dst);
+	});
+}
+
+void RgbVertexArray::Interleave(const cv::Point3f *pts, const Vector4 *colors, int count, float *vertices)
+{
+	float *v = vertices;
+	for (int i = 0; i < count; i++, v += 7)
 	{
-		glEnableVertexAttribArray(2);
-		glVertexAttribPointer(2, mStride2, GL_FLOAT, GL_FALSE, stride, (const void *)offset);
+		v[0] = pts[i].x;
+		v[1] = pts[i].y;
+		v[2] = pts[i].z;
+		v[3] = colors[i].x;
+		v[4] = colors[i].y;
+		v[5] = colors[i].z;
+		v[6] = colors[i].w;
 	}
+}
+#endif // YUP_INCLUDE_OPENCV
 
-	glBindVertexArray(0);
 
-	mVertArrayChanged = false;
+
+StreamVertexArrayBase::StreamVertexArrayBase(int maxVertCount, GLsizei vertexSize)
+	: mVertexSize(vertexSize)
+	, mMaxVertCount(maxVertCount)
+	, mSequence(0)
+{
 }
 
+bool StreamVertexArrayBase::init()
+{
+	if (!GLEW_ARB_buffer_storage)
+		return false;
+
+	glGenVertexArrays(1, &mVAO);
+	glGenBuffers(1, &mVertBufferId);
+
+	const GLsizeiptr bytes = (GLsizeiptr)mVertexSize * mMaxVertCount * Regions;
+	const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+	glBindBuffer(GL_ARRAY_BUFFER, mVertBufferId);
+	glBufferStorage(GL_ARRAY_BUFFER, bytes, nullptr, flags);
+	mMapped = (uint8_t *)glMapBufferRange(GL_ARRAY_BUFFER, 0, bytes, flags);
 
+	glBindVertexArray(mVAO);
+	setupAttributes();
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
 
-void SimpleVertexArray::addPoint(float x, float y, float z)
+	return mMapped != nullptr;
+}
+
+void StreamVertexArrayBase::update()
 {
-	std::lock_guard<std::mutex> lock(mMutex);
-	mVertArray.push_back(x);
-	mVertArray.push_back(y);
-	mVertArray.push_back(z);
+	// regions the GPU is done with go back to the writers
+	for (Region &region : mRegions)
+	{
+		if (region.state.load(std::memory_order_relaxed) != REGION_RETIRED)
+			continue;
 
-	mVertCount += 1;
-	mVertArrayChanged = true;
+		if (region.fence)
+		{
+			if (glClientWaitSync(region.fence, 0, 0) == GL_TIMEOUT_EXPIRED)
+				continue;
+
+			glDeleteSync(region.fence);
+			region.fence = nullptr;
+		}
+
+		region.state.store(REGION_FREE, std::memory_order_release);
+	}
+
+	// draw the newest written region from now on
+	int newest = -1;
+	for (int i = 0; i < Regions; i++)
+	{
+		if (mRegions[i].state.load(std::memory_order_acquire) == REGION_READY &&
+			(newest < 0 || mRegions[i].sequence > mRegions[newest].sequence))
+			newest = i;
+	}
+
+	if (newest < 0)
+		return;
+
+	// older ones were never drawn and need no fence
+	for (int i = 0; i < Regions; i++)
+	{
+		if (i != newest && mRegions[i].state.load(std::memory_order_acquire) == REGION_READY &&
+			mRegions[i].sequence < mRegions[newest].sequence)
+			mRegions[i].state.store(REGION_FREE, std::memory_order_release);
+	}
+
+	if (mDrawRegion >= 0)
+		mRegions[mDrawRegion].state.store(REGION_RETIRED, std::memory_order_relaxed);
+
+	mRegions[newest].state.store(REGION_DRAWING, std::memory_order_relaxed);
+	mDrawRegion = newest;
 }
 
+void StreamVertexArrayBase::shutdown()
+{
+	for (Region &region : mRegions)
+	{
+		if (region.fence)
+		{
+			glDeleteSync(region.fence);
+			region.fence = nullptr;
+		}
+
+		region.state.store(REGION_FREE, std::memory_order_relaxed);
+	}
+
+	mDrawRegion = -1;
+
+	if (mVertBufferId)
+	{
+		if (mMapped)
+		{
+			glBindBuffer(GL_ARRAY_BUFFER, mVertBufferId);
+			glUnmapBuffer(GL_ARRAY_BUFFER);
+			glBindBuffer(GL_ARRAY_BUFFER, 0);
+			mMapped = nullptr;
+		}
+
+		glDeleteBuffers(1, &mVertBufferId);
+		mVertBufferId = 0;
+	}
+
+	if (mVAO)
+	{
+		glDeleteVertexArrays(1, &mVAO);
+		mVAO = 0;
+	}
+}
 
-void UvVertexArray::addPoint(float x, float y, float z, float u, float v)
+void StreamVertexArrayBase::draw(GLenum mode)
 {
-	std::lock_guard<std::mutex> lock(mMutex);
+	if (mDrawRegion < 0)
+		return;
 
-	mVertArray.push_back(x);
-	mVertArray.push_back(y);
-	mVertArray.push_back(z);
-	mVertArray.push_back(u);
-	mVertArray.push_back(v);
+	Region &region = mRegions[mDrawRegion];
 
-	mVertCount += 1;
+	glBindVertexArray(mVAO);
+	glDrawArrays(mode, mDrawRegion * mMaxVertCount, region.vertCount);
+	glBindVertexArray(0);
 
-	mVertArrayChanged = true;
+	// the region stays in use until this draw has executed
+	if (region.fence)
+		glDeleteSync(region.fence);
+	region.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
 }
 
-void RgbVertexArray::addPoint(float x, float y, float z, float r, float g, float b, float a)
+void * StreamVertexArrayBase::beginWriteData(int &region)
 {
-	std::lock_guard<std::mutex> lock(mMutex);
+	if (!mMapped)
+		return nullptr;
 
-	mVertArray.push_back(x);
-	mVertArray.push_back(y);
-	mVertArray.push_back(z);
-	mVertArray.push_back(r);
-	mVertArray.push_back(g);
-	mVertArray.push_back(b);
-	mVertArray.push_back(a);
+	for (int i = 0; i < Regions; i++)
+	{
+		int expected = REGION_FREE;
+		if (mRegions[i].state.compare_exchange_strong(expected, REGION_WRITING, std::memory_order_acquire))
+		{
+			region = i;
+			return mMapped + (size_t)i * mMaxVertCount * mVertexSize;
+		}
+	}
 
-	mVertCount += 1;
+	return nullptr;
+}
 
-	mVertArrayChanged = true;
+void StreamVertexArrayBase::endWrite(int region, int vertCount)
+{
+	Region &r = mRegions[region];
+	r.vertCount = std::min(vertCount, (int)mMaxVertCount);
+	r.sequence = ++mSequence;
+
+	// the vertices, count and sequence become visible with the state
+	r.state.store(REGION_READY, std::memory_order_release);
+}
+
+void StreamVertexArrayBase::cancelWrite(int region)
+{
+	mRegions[region].state.store(REGION_FREE, std::memory_order_release);
 }
 
 END_NAMESPACE_YUP_GL
@@ -4,6 +4,25 @@
 //  ---
 //  GL vertex array
 //
+//  The vertex format is a compile time list of attributes, see
+//  VertexLayout.h, and the attribute pointers are set once per GL buffer.
+//
+//  Points are appended on the CPU and update() uploads only those added
+//  since the last upload. The GL buffer grows geometrically, and on growth
+//  the uploaded part is copied to the new buffer on the GPU.
+//
+//  Producers add to a back buffer under the mutex. Once a frame update()
+//  swaps it with an empty one and appends it to the front buffer, which
+//  belongs to the GL thread, so the lock is held for the swap only, and
+//  uploads and draws do not take it at all. If a producer holds the lock
+//  at that moment, update() leaves its points for the next frame.
+//
+//  StreamVertexArray is for geometry that is replaced every frame. Its
+//  buffer is mapped persistently and split into three regions: writers
+//  fill a free region directly, the GL thread draws the newest filled one,
+//  and a fence after the draws hands a region back once the GPU is done
+//  with it, so there are no copies and neither side waits for the other.
+//
 //  Created: 2016-08-24
 //  Updated: 2016-08-24
 //
@@ -15,12 +34,17 @@
 
 #ifdef YUP_INCLUDE_GLEW
 
+#include <atomic>
+#include <cstdint>
+#include <functional>
 #include <vector>
 #include <mutex>
 
 #include "yup.h"
 #include "inc_sdl.h"
 #include "Matrices.h"
+#include "Frustum.h"
+#include "VertexLayout.h"
 
 #ifdef YUP_INCLUDE_OPENCV
 #include <opencv2/core.hpp>
@@ -28,28 +52,50 @@
 
 BEGIN_NAMESPACE_YUP_GL
 
-class VertexArray
+// The untyped part of VertexArray, vertices of vertexSize bytes
+class VertexArrayBase
 {
 private:
 	GLuint mVAO = 0;
 	GLuint mVertBufferId = 0;
+	size_t mBufferCapacity = 0;			// bytes allocated for mVertBufferId
 
-	const GLsizei mStride0 = 0;
-	const GLsizei mStride1 = 0;
-	const GLsizei mStride2 = 0;
+	const GLsizei mVertexSize = 0;
 
 protected:
-	std::vector<float> mVertArray;
-	bool mVertArrayChanged = false;
+	// ---- GL thread ----
+	std::vector<uint8_t> mVertArray;			// front, all points
+	std::vector<uint8_t> mStagingArray;			// the last back buffer, kept for its capacity
 	GLsizei mVertCount = 0;
 	GLsizei mUploadedVertCount = 0;
+	size_t mUploadedSize = 0;			// bytes of mVertArray in the GL buffer
+	BoundingBox mDrawBounds;			// mBounds as of the last swap
+
+	// ---- producers, under mMutex ----
+	std::vector<uint8_t> mPendingArray;			// back, points added since the last swap
+	bool mPendingReset = false;			// the front is to be dropped, after clear() or assign()
+	bool mVertArrayChanged = false;
+	BoundingBox mBounds;
 
 	std::mutex mMutex;
 
+	explicit VertexArrayBase(GLsizei vertexSize);
+
+	// Append or replace with count vertices. Takes the lock once, the
+	// bounds are found before.
+	void appendData(const void *vertices, int count, const BoundingBox &bounds);
+	void assignData(const void *vertices, int count, const BoundingBox &bounds);
+
+	// The same, with fill writing the count vertices straight into the
+	// pending buffer, under the lock. Saves building them in a temporary.
+	void appendData(int count, const BoundingBox &bounds, const std::function<void(uint8_t *)> &fill);
+	void assignData(int count, const BoundingBox &bounds, const std::function<void(uint8_t *)> &fill);
+
+	// point the attributes of the bound VAO at the bound GL_ARRAY_BUFFER
+	virtual void setupAttributes() = 0;
+
 public:
-	//VertexArray();
-	VertexArray(int stride1, int stride2 = 0, int stride3 = 0);
-	virtual ~VertexArray();
+	virtual ~VertexArrayBase();
 
 	virtual bool init();
 	virtual void update();
@@ -59,7 +105,6 @@ public:
 	inline void unbind() { glBindVertexArray(0); }
 
 	inline void draw(GLenum mode) {
-		std::lock_guard<std::mutex> lock(mMutex);
 		glBindVertexArray(mVAO);
 		glDrawArrays(mode, 0, mUploadedVertCount);
 		glBindVertexArray(0);
@@ -68,40 +113,197 @@ public:
 	inline void drawPoints() { draw(GL_POINTS); }
 	inline void drawTriangles() { draw(GL_TRIANGLES); }
 
-	void clear() { mVertArray.clear(); mVertCount = 0; mVertArrayChanged = true; }
+	void clear() {
+		std::lock_guard<std::mutex> lock(mMutex);
+		mPendingArray.clear(); mPendingReset = true; mBounds.clear(); mVertArrayChanged = true;
+	}
+
+	// bounding box of all points added so far
+	BoundingBox getBounds() { std::lock_guard<std::mutex> lock(mMutex); return mBounds; }
+
+	// bounding box of the points taken by the last update(), for culling on
+	// the GL thread without the lock
+	const BoundingBox & drawBounds() const { return mDrawBounds; }
+
+	GLsizei vertexSize() const { return mVertexSize; }
 
 private:
 	void updateVertexBuffer();
+	void growVertexBuffer(size_t bytes);
+	void setVertexAttributes();
 };
 
-class SimpleVertexArray : public VertexArray
+// of count vertices of vertexSize bytes, each starting with a float position
+BoundingBox VertexBounds(const void *vertices, int count, GLsizei vertexSize);
+
+// Vertices of the attributes in VertexLayout.h, at locations 0, 1, ...
+template <typename... Attribs>
+class VertexArray : public VertexArrayBase
 {
 public:
-	SimpleVertexArray() : VertexArray(3) {}
+	typedef VertexLayout<Attribs...> Layout;
+	typedef typename Layout::Vertex Vertex;
+
+	VertexArray() : VertexArrayBase(Layout::Stride) {}
 
-	void addPoint(float x, float y, float z);
+	void addVertex(const Vertex &vertex) { addVertices(&vertex, 1); }
+	void addVertices(const Vertex *vertices, int count) { appendData(vertices, count, Bounds(vertices, count)); }
+	void assignVertices(const Vertex *vertices, int count) { assignData(vertices, count, Bounds(vertices, count)); }
+
+	// without a float position, a box around everything keeps culling
+	// conservative
+	static BoundingBox Bounds(const Vertex *vertices, int count) {
+		if (!Layout::HasFloatPosition)
+			return BoundingBox(Vector3(-1e30f, -1e30f, -1e30f), Vector3(1e30f, 1e30f, 1e30f));
+		return VertexBounds(vertices, count, Layout::Stride);
+	}
+
+protected:
+	virtual void setupAttributes() override { Layout::Setup(); }
+};
+
+class SimpleVertexArray : public VertexArray<VertexFloat3>
+{
+public:
+	void addPoint(float x, float y, float z) { const float v[] = { x, y, z }; addPoints(v, 1); }
 #ifdef YUP_INCLUDE_OPENCV
 	void addPoint(const cv::Point3f &pt) { addPoint(pt.x, pt.y, pt.z); }
 #endif // YUP_INCLUDE_OPENCV
+
+	// count points of x, y, z
+	void addPoints(const float *xyz, int count) { addVertices((const Vertex *)xyz, count); }
+	void assign(const float *xyz, int count) { assignVertices((const Vertex *)xyz, count); }
+#ifdef YUP_INCLUDE_OPENCV
+	void addPoints(const std::vector<cv::Point3f> &pts) { addPoints(pts.empty() ? nullptr : &pts[0].x, (int)pts.size()); }
+	void assign(const std::vector<cv::Point3f> &pts) { assign(pts.empty() ? nullptr : &pts[0].x, (int)pts.size()); }
+#endif // YUP_INCLUDE_OPENCV
 };
 
-class UvVertexArray : public VertexArray
+class UvVertexArray : public VertexArray<VertexFloat3, VertexFloat2>
 {
 public:
-	UvVertexArray() : VertexArray(3, 2) {}
+	void addPoint(float x, float y, float z, float u = 0, float v = 0) { const float p[] = { x, y, z, u, v }; addPoints(p, 1); }
 
-	void addPoint(float x, float y, float z, float u = 0, float v = 0);
+	// count points of x, y, z, u, v
+	void addPoints(const float *xyzuv, int count) { addVertices((const Vertex *)xyzuv, count); }
+	void assign(const float *xyzuv, int count) { assignVertices((const Vertex *)xyzuv, count); }
 };
 
-class RgbVertexArray : public VertexArray
+class RgbVertexArray : public VertexArray<VertexFloat3, VertexFloat4>
 {
 public:
-	RgbVertexArray() : VertexArray(3, 4) {}
-
-	void addPoint(float x, float y, float z, float r = 1.0f, float g = 1.0f, float b = 1.0f, float a = 1.0f);
+	void addPoint(float x, float y, float z, float r = 1.0f, float g = 1.0f, float b = 1.0f, float a = 1.0f) { const float p[] = { x, y, z, r, g, b, a }; addPoints(p, 1); }
 #ifdef YUP_INCLUDE_OPENCV
 	void addPoint(const cv::Point3f &pt, const Vector4 &color) { addPoint(pt.x, pt.y, pt.z, color.x, color.y, color.z, color.w); }
 #endif // YUP_INCLUDE_OPENCV
+
+	// count points of x, y, z, r, g, b, a
+	void addPoints(const float *xyzrgba, int count) { addVertices((const Vertex *)xyzrgba, count); }
+	void assign(const float *xyzrgba, int count) { assignVertices((const Vertex *)xyzrgba, count); }
+#ifdef YUP_INCLUDE_OPENCV
+	// a color per point
+	void addPoints(const std::vector<cv::Point3f> &pts, const std::vector<Vector4> &colors);
+	void assign(const std::vector<cv::Point3f> &pts, const std::vector<Vector4> &colors);
+#endif // YUP_INCLUDE_OPENCV
+
+private:
+#ifdef YUP_INCLUDE_OPENCV
+	static void Interleave(const cv::Point3f *pts, const Vector4 *colors, int count, float *vertices);
+#endif // YUP_INCLUDE_OPENCV
+};
+
+static_assert(sizeof(SimpleVertexArray::Vertex) == 3 * sizeof(float), "x, y, z");
+static_assert(sizeof(UvVertexArray::Vertex) == 5 * sizeof(float), "x, y, z, u, v");
+static_assert(sizeof(RgbVertexArray::Vertex) == 7 * sizeof(float), "x, y, z, r, g, b, a");
+
+// The untyped part of StreamVertexArray. Needs GL_ARB_buffer_storage (core
+// in GL 4.4), init() returns false without it. Writers may be on any
+// thread; init(), update(), draw() and shutdown() are for the GL thread.
+class StreamVertexArrayBase
+{
+private:
+	static const int Regions = 3;
+
+	enum RegionState
+	{
+		REGION_FREE,
+		REGION_WRITING,
+		REGION_READY,			// written, not drawn yet
+		REGION_DRAWING,
+		REGION_RETIRED			// replaced, until its fence has passed
+	};
+
+	struct Region
+	{
+		std::atomic<int> state;
+		GLsizei vertCount = 0;
+		uint64_t sequence = 0;
+		GLsync fence = nullptr;			// after the last draw
+
+		Region() : state(REGION_FREE) {}
+	};
+
+	GLuint mVAO = 0;
+	GLuint mVertBufferId = 0;
+	uint8_t *mMapped = nullptr;
+
+	const GLsizei mVertexSize = 0;
+	const GLsizei mMaxVertCount = 0;			// per region
+
+	Region mRegions[Regions];
+	std::atomic<uint64_t> mSequence;
+	int mDrawRegion = -1;
+
+protected:
+	StreamVertexArrayBase(int maxVertCount, GLsizei vertexSize);
+
+	void * beginWriteData(int &region);
+
+	// point the attributes of the bound VAO at the bound GL_ARRAY_BUFFER
+	virtual void setupAttributes() = 0;
+
+public:
+	virtual ~StreamVertexArrayBase() {}
+
+	StreamVertexArrayBase(const StreamVertexArrayBase &) = delete;
+	void operator=(const StreamVertexArrayBase &) = delete;
+
+	bool init();
+	void update();			// once per frame, before drawing
+	void shutdown();
+
+	void draw(GLenum mode);
+	inline void drawPoints() { draw(GL_POINTS); }
+	inline void drawTriangles() { draw(GL_TRIANGLES); }
+
+	GLsizei vertexSize() const { return mVertexSize; }
+	int maxVertCount() const { return mMaxVertCount; }
+
+	// ---- writers ----
+
+	// the first vertCount vertices of region are the new geometry
+	void endWrite(int region, int vertCount);
+
+	// give region back unchanged
+	void cancelWrite(int region);
+};
+
+template <typename... Attribs>
+class StreamVertexArray : public StreamVertexArrayBase
+{
+public:
+	typedef VertexLayout<Attribs...> Layout;
+	typedef typename Layout::Vertex Vertex;
+
+	explicit StreamVertexArray(int maxVertCount) : StreamVertexArrayBase(maxVertCount, Layout::Stride) {}
+
+	// Room for maxVertCount() vertices in a free region, nullptr if none is
+	// free. The memory may be write combined, fill it in order and do not
+	// read it back.
+	Vertex * beginWrite(int &region) { return (Vertex *)beginWriteData(region); }
+
+protected:
+	virtual void setupAttributes() override { Layout::Setup(); }
 };
 
 END_NAMESPACE_YUP_GL
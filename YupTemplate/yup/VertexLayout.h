@@ -0,0 +1,186 @@
+// ========================================================================== //
+//
+//  VertexLayout.h
+//  ---
+//  Compile time layouts of interleaved vertices
+//
+//  A layout is a list of attributes, each a component type and count, e.g.
+//
+//    typedef VertexLayout<VertexFloat3, VertexUNorm8x4> Layout;
+//
+//  is a float position at location 0 and an 8 bit normalized colour at
+//  location 1. Layout::Vertex is the struct of one vertex and Setup() points
+//  the attributes of the bound VAO at an array of them. Every attribute is
+//  padded to a multiple of 4 bytes, so Vertex has no other padding and the
+//  offsets are plain sums.
+//
+//  Created: 2016-08-24
+//  Updated: 2016-08-24
+//
+//  (C) 2016 Yu-hsien Chang
+//
+// ========================================================================== //
+
+#pragma once
+
+#ifdef YUP_INCLUDE_GLEW
+
+#include <cstdint>
+#include <type_traits>
+
+#include "yup.h"
+#include "inc_sdl.h"
+#include "Half.h"
+
+BEGIN_NAMESPACE_YUP_GL
+
+// 4 components in a word, x in the low bits: 10 bits each for x, y, z and 2
+// for w, signed or unsigned
+struct Packed1010102 { uint32_t bits; };
+struct UPacked1010102 { uint32_t bits; };
+
+// GL type of a component type, and the components per value
+template <typename T> struct VertexType;
+template <> struct VertexType<float> { static const GLenum Type = GL_FLOAT; static const int Components = 1; };
+template <> struct VertexType<Half> { static const GLenum Type = GL_HALF_FLOAT; static const int Components = 1; };
+template <> struct VertexType<int8_t> { static const GLenum Type = GL_BYTE; static const int Components = 1; };
+template <> struct VertexType<uint8_t> { static const GLenum Type = GL_UNSIGNED_BYTE; static const int Components = 1; };
+template <> struct VertexType<int16_t> { static const GLenum Type = GL_SHORT; static const int Components = 1; };
+template <> struct VertexType<uint16_t> { static const GLenum Type = GL_UNSIGNED_SHORT; static const int Components = 1; };
+template <> struct VertexType<Packed1010102> { static const GLenum Type = GL_INT_2_10_10_10_REV; static const int Components = 4; };
+template <> struct VertexType<UPacked1010102> { static const GLenum Type = GL_UNSIGNED_INT_2_10_10_10_REV; static const int Components = 4; };
+
+// N components of T, integers mapped to [0, 1] or [-1, 1] if Normalize and
+// converted to float otherwise
+template <typename T, int N, bool Normalize = false>
+struct VertexAttrib
+{
+	typedef T Component;
+
+	static const int Size = N;
+	static const GLenum Type = VertexType<T>::Type;
+	static const GLboolean Normalized = Normalize ? GL_TRUE : GL_FALSE;
+
+	static_assert(N >= 1 && N <= 4 && N % VertexType<T>::Components == 0, "1 to 4 components, 4 for packed types");
+
+	// the values, and padding to 4 bytes
+	static const int Count = N / VertexType<T>::Components;
+	static const int PaddedCount = (Count * sizeof(T) + 3) / 4 * 4 / sizeof(T);
+
+	struct Storage
+	{
+		T v[PaddedCount];
+
+		T & operator[](int i) { return v[i]; }
+		const T & operator[](int i) const { return v[i]; }
+	};
+
+	static_assert(sizeof(Storage) % 4 == 0 && alignof(Storage) <= 4, "attributes must pack to 4 bytes");
+};
+
+typedef VertexAttrib<float, 1> VertexFloat1;
+typedef VertexAttrib<float, 2> VertexFloat2;
+typedef VertexAttrib<float, 3> VertexFloat3;
+typedef VertexAttrib<float, 4> VertexFloat4;
+typedef VertexAttrib<Half, 2> VertexHalf2;
+typedef VertexAttrib<Half, 3> VertexHalf3;
+typedef VertexAttrib<Half, 4> VertexHalf4;
+typedef VertexAttrib<uint8_t, 4, true> VertexUNorm8x4;
+typedef VertexAttrib<int8_t, 4, true> VertexSNorm8x4;
+typedef VertexAttrib<uint16_t, 2, true> VertexUNorm16x2;
+typedef VertexAttrib<uint16_t, 4, true> VertexUNorm16x4;
+typedef VertexAttrib<Packed1010102, 4, true> VertexSNorm1010102;
+typedef VertexAttrib<UPacked1010102, 4, true> VertexUNorm1010102;
+
+
+
+// -------------------------------------------------------------------------- //
+//  the vertex struct, one member per attribute
+// -------------------------------------------------------------------------- //
+template <typename... Attribs> struct VertexFields;
+
+template <typename A>
+struct VertexFields<A>
+{
+	typename A::Storage first;
+};
+
+template <typename A, typename... Rest>
+struct VertexFields<A, Rest...>
+{
+	typename A::Storage first;
+	VertexFields<Rest...> rest;
+};
+
+// attribute I of a vertex
+template <int I, typename... Attribs> struct VertexField;
+
+template <typename A, typename... Rest>
+struct VertexField<0, A, Rest...>
+{
+	typedef A Attrib;
+
+	static typename A::Storage & Get(VertexFields<A, Rest...> &v) { return v.first; }
+	static const typename A::Storage & Get(const VertexFields<A, Rest...> &v) { return v.first; }
+};
+
+template <int I, typename A, typename... Rest>
+struct VertexField<I, A, Rest...>
+{
+	typedef typename VertexField<I - 1, Rest...>::Attrib Attrib;
+
+	static typename Attrib::Storage & Get(VertexFields<A, Rest...> &v) { return VertexField<I - 1, Rest...>::Get(v.rest); }
+	static const typename Attrib::Storage & Get(const VertexFields<A, Rest...> &v) { return VertexField<I - 1, Rest...>::Get(v.rest); }
+};
+
+// attribute pointers from location Index at byte Offset on
+template <GLuint Index, uintptr_t Offset, typename... Attribs>
+struct VertexSetup
+{
+	static void Setup(GLsizei) {}
+};
+
+template <GLuint Index, uintptr_t Offset, typename A, typename... Rest>
+struct VertexSetup<Index, Offset, A, Rest...>
+{
+	static void Setup(GLsizei stride)
+	{
+		glEnableVertexAttribArray(Index);
+		glVertexAttribPointer(Index, A::Size, A::Type, A::Normalized, stride, (const void *)Offset);
+
+		VertexSetup<Index + 1, Offset + sizeof(typename A::Storage), Rest...>::Setup(stride);
+	}
+};
+
+
+
+// -------------------------------------------------------------------------- //
+//  VertexLayout
+// -------------------------------------------------------------------------- //
+template <typename... Attribs>
+struct VertexLayout
+{
+	typedef VertexFields<Attribs...> Vertex;
+
+	template <int I>
+	using Attrib = typename VertexField<I, Attribs...>::Attrib;
+
+	static const int AttribCount = sizeof...(Attribs);
+	static const GLsizei Stride = sizeof(Vertex);
+
+	// a float position first, for bounding boxes
+	static const bool HasFloatPosition = std::is_same<typename Attrib<0>::Component, float>::value && Attrib<0>::Size >= 3;
+
+	template <int I>
+	static typename Attrib<I>::Storage & Get(Vertex &v) { return VertexField<I, Attribs...>::Get(v); }
+
+	template <int I>
+	static const typename Attrib<I>::Storage & Get(const Vertex &v) { return VertexField<I, Attribs...>::Get(v); }
+
+	// for the VAO and GL_ARRAY_BUFFER bound
+	static void Setup() { VertexSetup<0, 0, Attribs...>::Setup(Stride); }
+};
+
+END_NAMESPACE_YUP_GL
+
+#endif // YUP_INCLUDE_GLEW
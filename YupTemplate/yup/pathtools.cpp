@@ -16,6 +16,7 @@
 #if defined( _WIN32)
 #include <Windows.h>
 #include <direct.h>
+#include <io.h>
 #include <Shobjidl.h>
 #include <KnownFolders.h>
 #elif defined OSX
@@ -29,9 +30,18 @@
 #include <stdio.h>
 #endif
 
+#if !defined( _WIN32 )
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
 #include <sys/stat.h>
 
 #include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cstring>
+#include <cwchar>
 
 
 BEGIN_NAMESPACE_YUP_PATH
@@ -597,4 +607,370 @@ bool WriteStringToTextFile( const ustring &strFilename, const uchar *pchData )
 	return ok;
 }
 
+
+//-----------------------------------------------------------------------------
+// Purpose: helpers for the atomic and buffered writers
+//-----------------------------------------------------------------------------
+static FILE * OpenFile( const ustring &strFilename, const uchar *pchMode )
+{
+	FILE *f;
+#if defined( POSIX )
+	f = fopen( strFilename.c_str(), pchMode );
+#else
+	errno_t err = _wfopen_s(&f, strFilename.c_str(), pchMode);
+	if ( err != 0 )
+	{
+		f = NULL;
+	}
+#endif
+	return f;
+}
+
+/** A temp name next to strFilename, unique per call so that concurrent writes
+	of the same file, from threads or processes, do not share it */
+static ustring GetTempFilename( const ustring &strFilename )
+{
+	static std::atomic< unsigned > s_nCounter( 0 );
+
+#if defined( _WIN32 )
+	unsigned long nProcessId = ::GetCurrentProcessId();
+#else
+	unsigned long nProcessId = (unsigned long)getpid();
+#endif
+
+	ustringstream ss;
+	ss << strFilename << TEXT(".") << nProcessId << TEXT(".") << s_nCounter++ << TEXT(".tmp");
+	return ss.str();
+}
+
+static bool RemoveFile( const ustring &strFilename )
+{
+#if defined( _WIN32 )
+	return _wremove( strFilename.c_str() ) == 0;
+#else
+	return remove( strFilename.c_str() ) == 0;
+#endif
+}
+
+/** Renames strFrom to strTo, replacing strTo if it exists */
+static bool ReplaceFile( const ustring &strFrom, const ustring &strTo )
+{
+#if defined( _WIN32 )
+	return ::MoveFileEx( strFrom.c_str(), strTo.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH ) != 0;
+#else
+	return rename( strFrom.c_str(), strTo.c_str() ) == 0;
+#endif
+}
+
+/** Makes a rename inside the directory durable. Windows does this in MoveFileEx. */
+static void SyncDirectory( const ustring &strDirectory )
+{
+#if !defined( _WIN32 )
+	int fd = open( strDirectory.empty() ? "." : strDirectory.c_str(), O_RDONLY );
+	if ( fd != -1 )
+	{
+		fsync( fd );
+		close( fd );
+	}
+#endif
+}
+
+
+bool SyncFile( FILE *f )
+{
+	if ( f == NULL || fflush( f ) != 0 )
+		return false;
+
+#if defined( _WIN32 )
+	return _commit( _fileno( f ) ) == 0;
+#else
+	return fsync( fileno( f ) ) == 0;
+#endif
+}
+
+
+//-----------------------------------------------------------------------------
+// Purpose: atomic replacement of a file through temp file + sync + rename
+//-----------------------------------------------------------------------------
+static bool CommitTempFile( FILE *f, const ustring &strTempFilename, const ustring &strFilename )
+{
+	bool ok = SyncFile( f );
+	ok = ( fclose( f ) == 0 ) && ok;
+
+	if ( ok )
+		ok = ReplaceFile( strTempFilename, strFilename );
+
+	if ( !ok )
+		RemoveFile( strTempFilename );
+
+	return ok;
+}
+
+bool WriteBinaryFileAtomic( const ustring &strFilename, const void *pData, size_t nSize )
+{
+	ustring strTempFilename = GetTempFilename( strFilename );
+	FILE *f = OpenFile( strTempFilename, TEXT("wb") );
+	if ( f == NULL )
+		return false;
+
+	if ( nSize > 0 && fwrite( pData, nSize, 1, f ) != 1 )
+	{
+		fclose( f );
+		RemoveFile( strTempFilename );
+		return false;
+	}
+
+	if ( !CommitTempFile( f, strTempFilename, strFilename ) )
+		return false;
+
+	SyncDirectory( StripFilename( strFilename ) );
+	return true;
+}
+
+bool WriteStringToTextFileAtomic( const ustring &strFilename, const uchar *pchData )
+{
+	ustring strTempFilename = GetTempFilename( strFilename );
+	FILE *f = OpenFile( strTempFilename, TEXT("w") );
+	if ( f == NULL )
+		return false;
+
+	if ( fputws( pchData, f ) < 0 )
+	{
+		fclose( f );
+		RemoveFile( strTempFilename );
+		return false;
+	}
+
+	if ( !CommitTempFile( f, strTempFilename, strFilename ) )
+		return false;
+
+	SyncDirectory( StripFilename( strFilename ) );
+	return true;
+}
+
+
+//-----------------------------------------------------------------------------
+// Purpose: FileBatchWriter
+//-----------------------------------------------------------------------------
+bool FileBatchWriter::add( const ustring &strFilename, const void *pData, size_t nSize )
+{
+	Entry entry;
+	entry.strFilename = strFilename;
+	entry.strTempFilename = GetTempFilename( strFilename );
+	entry.f = OpenFile( entry.strTempFilename, TEXT("wb") );
+
+	if ( entry.f == NULL )
+	{
+		m_bFailed = true;
+		return false;
+	}
+
+	if ( nSize > 0 && fwrite( pData, nSize, 1, entry.f ) != 1 )
+	{
+		fclose( entry.f );
+		RemoveFile( entry.strTempFilename );
+		m_bFailed = true;
+		return false;
+	}
+
+	// Hand the data to the OS now so commit() only has to wait for the disk
+	fflush( entry.f );
+
+	m_vecEntries.push_back( entry );
+	return true;
+}
+
+bool FileBatchWriter::addText( const ustring &strFilename, const uchar *pchData )
+{
+	Entry entry;
+	entry.strFilename = strFilename;
+	entry.strTempFilename = GetTempFilename( strFilename );
+	entry.f = OpenFile( entry.strTempFilename, TEXT("w") );
+
+	if ( entry.f == NULL )
+	{
+		m_bFailed = true;
+		return false;
+	}
+
+	if ( fputws( pchData, entry.f ) < 0 )
+	{
+		fclose( entry.f );
+		RemoveFile( entry.strTempFilename );
+		m_bFailed = true;
+		return false;
+	}
+
+	fflush( entry.f );
+
+	m_vecEntries.push_back( entry );
+	return true;
+}
+
+bool FileBatchWriter::commit()
+{
+	bool ok = !m_bFailed;
+
+	// Sync everything before the first rename, so the disk can service all
+	// the flushes together and no target is replaced by unsynced data
+	std::vector< bool > vecSynced( m_vecEntries.size() );
+	for ( size_t i = 0; i < m_vecEntries.size(); i++ )
+	{
+		Entry &entry = m_vecEntries[i];
+		bool bSynced = SyncFile( entry.f );
+		bSynced = ( fclose( entry.f ) == 0 ) && bSynced;
+		entry.f = NULL;
+		vecSynced[i] = bSynced;
+	}
+
+	std::vector< ustring > vecDirectories;
+	for ( size_t i = 0; i < m_vecEntries.size(); i++ )
+	{
+		Entry &entry = m_vecEntries[i];
+		if ( !vecSynced[i] || !ReplaceFile( entry.strTempFilename, entry.strFilename ) )
+		{
+			RemoveFile( entry.strTempFilename );
+			ok = false;
+			continue;
+		}
+
+		ustring strDirectory = StripFilename( entry.strFilename );
+		if ( std::find( vecDirectories.begin(), vecDirectories.end(), strDirectory ) == vecDirectories.end() )
+			vecDirectories.push_back( strDirectory );
+	}
+
+	// One directory sync per directory instead of one per file
+	for ( size_t i = 0; i < vecDirectories.size(); i++ )
+		SyncDirectory( vecDirectories[i] );
+
+	m_vecEntries.clear();
+	m_bFailed = false;
+
+	return ok;
+}
+
+void FileBatchWriter::abort()
+{
+	for ( size_t i = 0; i < m_vecEntries.size(); i++ )
+	{
+		if ( m_vecEntries[i].f )
+			fclose( m_vecEntries[i].f );
+
+		RemoveFile( m_vecEntries[i].strTempFilename );
+	}
+
+	m_vecEntries.clear();
+	m_bFailed = false;
+}
+
+
+//-----------------------------------------------------------------------------
+// Purpose: BufferedFileWriter
+//-----------------------------------------------------------------------------
+bool BufferedFileWriter::open( const ustring &strFilename, bool bTruncate )
+{
+	close();
+
+	m_pFile = OpenFile( strFilename, bTruncate ? TEXT("wb") : TEXT("ab") );
+	if ( m_pFile == NULL )
+		return false;
+
+	// We do our own buffering
+	setvbuf( m_pFile, NULL, _IONBF, 0 );
+
+	m_nBuffered = 0;
+	m_nBytesWritten = 0;
+	return true;
+}
+
+void BufferedFileWriter::close()
+{
+	if ( m_pFile == NULL )
+		return;
+
+	flush();
+	fclose( m_pFile );
+	m_pFile = NULL;
+}
+
+bool BufferedFileWriter::write( const void *pData, size_t nSize )
+{
+	if ( m_pFile == NULL )
+		return false;
+
+	if ( nSize == 0 )
+		return true;
+
+	const unsigned char *pchData = (const unsigned char *)pData;
+	m_nBytesWritten += nSize;
+
+	// Small writes are gathered in the buffer
+	if ( m_nBuffered + nSize <= m_vecBuffer.size() )
+	{
+		memcpy( m_vecBuffer.data() + m_nBuffered, pchData, nSize );
+		m_nBuffered += nSize;
+		return true;
+	}
+
+	if ( !flush() )
+		return false;
+
+	// Large writes bypass the buffer
+	if ( nSize >= m_vecBuffer.size() )
+		return fwrite( pchData, nSize, 1, m_pFile ) == 1;
+
+	memcpy( m_vecBuffer.data(), pchData, nSize );
+	m_nBuffered = nSize;
+	return true;
+}
+
+/** Writes the same bytes as fputws on a text mode stream does, like the one of
+	WriteStringToTextFile: the characters converted with the current locale
+	and, on Windows, "\r\n" line ends */
+bool BufferedFileWriter::writeText( const uchar *pchData )
+{
+	char rchChunk[ 256 + MB_LEN_MAX + 1 ];
+	size_t nChunk = 0;
+	std::mbstate_t state = std::mbstate_t();
+
+	for ( ; *pchData; ++pchData )
+	{
+#if defined( _WIN32 )
+		if ( *pchData == L'\n' )
+			rchChunk[ nChunk++ ] = '\r';
+#endif
+		size_t nLen = wcrtomb( rchChunk + nChunk, *pchData, &state );
+		if ( nLen == (size_t)-1 )
+			return false;	// not representable, fputws fails as well
+
+		nChunk += nLen;
+		if ( nChunk >= 256 )
+		{
+			if ( !write( rchChunk, nChunk ) )
+				return false;
+			nChunk = 0;
+		}
+	}
+
+	return write( rchChunk, nChunk );
+}
+
+bool BufferedFileWriter::flush()
+{
+	if ( m_pFile == NULL )
+		return false;
+
+	if ( m_nBuffered == 0 )
+		return true;
+
+	bool ok = fwrite( m_vecBuffer.data(), m_nBuffered, 1, m_pFile ) == 1;
+	m_nBuffered = 0;
+	return ok;
+}
+
+bool BufferedFileWriter::sync()
+{
+	return flush() && SyncFile( m_pFile );
+}
+
 END_NAMESPACE_YUP_PATH
\ No newline at end of file
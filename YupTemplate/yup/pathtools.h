@@ -13,6 +13,9 @@
 
 #pragma once
 
+#include <cstdio>
+#include <vector>
+
 #include "unichar.h"
 
 BEGIN_NAMESPACE_YUP_PATH
@@ -98,6 +101,93 @@ unsigned char * ReadBinaryFile( const ustring &strFilename, int *pSize );
 ustring ReadTextFile( const ustring &strFilename );
 bool WriteStringToTextFile( const ustring &strFilename, const uchar *pchData );
 
+/** Writes the data to a temporary file next to strFilename, flushes it to disk and
+* renames it over strFilename. Readers either see the old file or the complete new
+* one, never a partially written file. */
+bool WriteBinaryFileAtomic( const ustring &strFilename, const void *pData, size_t nSize );
+bool WriteStringToTextFileAtomic( const ustring &strFilename, const uchar *pchData );
+
+/** Flushes the C runtime buffers and the OS cache of an open file to disk */
+bool SyncFile( FILE *f );
+
+//-----------------------------------------------------------------------------
+// Purpose: writes a set of files atomically with a single flush pass.
+//			All files are written to temporary files first, then synced and
+//			renamed in one go, so the cost of waiting on the disk is paid once
+//			per batch instead of once per file.
+//-----------------------------------------------------------------------------
+class FileBatchWriter
+{
+public:
+	FileBatchWriter() {}
+	~FileBatchWriter() { abort(); }
+
+	FileBatchWriter( const FileBatchWriter & ) = delete;
+	void operator=( const FileBatchWriter & ) = delete;
+
+	/** Queues a file for writing. The data is written to a temporary file right away. */
+	bool add( const ustring &strFilename, const void *pData, size_t nSize );
+	bool addText( const ustring &strFilename, const uchar *pchData );
+
+	/** Syncs and renames all queued files. Returns false if any of them failed,
+	* in which case none of the failed files replaced their targets. */
+	bool commit();
+
+	/** Discards all queued files and removes their temporary files */
+	void abort();
+
+	size_t count() const { return m_vecEntries.size(); }
+
+private:
+	struct Entry
+	{
+		ustring strFilename;
+		ustring strTempFilename;
+		FILE *f;
+	};
+
+	std::vector< Entry > m_vecEntries;
+	bool m_bFailed = false;
+};
+
+//-----------------------------------------------------------------------------
+// Purpose: appends to a file through a fixed size buffer, for streaming output
+//			such as logs or recorded sessions. Data reaches the OS only when the
+//			buffer is full or on flush(), and the disk only on sync().
+//-----------------------------------------------------------------------------
+class BufferedFileWriter
+{
+public:
+	BufferedFileWriter( size_t nBufferSize = 64 * 1024 ) : m_vecBuffer( nBufferSize ) {}
+	~BufferedFileWriter() { close(); }
+
+	BufferedFileWriter( const BufferedFileWriter & ) = delete;
+	void operator=( const BufferedFileWriter & ) = delete;
+
+	/** Opens the file for appending. If bTruncate is set any existing content is discarded. */
+	bool open( const ustring &strFilename, bool bTruncate = false );
+	void close();
+	bool isOpen() const { return m_pFile != NULL; }
+
+	bool write( const void *pData, size_t nSize );
+	bool writeText( const uchar *pchData );
+
+	/** Hands the buffered data to the OS */
+	bool flush();
+
+	/** Flushes and waits until the data is on disk */
+	bool sync();
+
+	/** Total number of bytes written through this writer since open() */
+	size_t bytesWritten() const { return m_nBytesWritten; }
+
+private:
+	FILE *m_pFile = NULL;
+	std::vector< unsigned char > m_vecBuffer;
+	size_t m_nBuffered = 0;
+	size_t m_nBytesWritten = 0;
+};
+
 //-----------------------------------------------------------------------------
 #if defined(WIN32)
 #define DYNAMIC_LIB_EXT	".dll"